@@ -0,0 +1,63 @@
+//
+// Minimal timing helpers shared by the benchmark executables.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace Benchmark {
+
+    inline double NowSeconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Runs \c fn \c repeats times and returns the fastest run, in seconds
+     */
+    template <typename Fn>
+    double Measure(int repeats, Fn &&fn) {
+        double best = 0.0;
+        for (int i = 0; i < repeats; i++) {
+            double start = NowSeconds();
+            fn();
+            double elapsed = NowSeconds() - start;
+            if (i == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+
+    /**
+     * Prints throughput and time per operation of one measurement
+     */
+    inline void Report(const char *name, double seconds, uint64_t operations) {
+        printf("%-48s %12.0f ops/s %10.2f ns/op\n", name, (double)operations / seconds,
+               seconds * 1e9 / (double)operations);
+    }
+
+    /**
+     * Steps a linear congruential generator and returns its top 24 bits.
+     * Cheap and reproducible, which is all test data needs.
+     */
+    inline uint32_t Random(uint32_t &seed) {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    }
+
+    /**
+     * Keeps the compiler from optimizing away a computed value
+     */
+    template <typename T>
+    inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &value;
+#endif
+    }
+
+}
@@ -0,0 +1,251 @@
+//
+// World iteration over 1M entities, creation, and structural churn both
+// applied directly and deferred through a CommandBuffer, with a
+// std::vector<std::unique_ptr<T>> of game objects as the iteration baseline,
+// followed by a check of entities whose rows nearly fill a chunk.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/ECS/CommandBuffer.h"
+#include "Engine/ECS/World.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t ENTITY_COUNT = 1000000;
+    const uint32_t CHURN_COUNT = 100000;
+    const int REPEATS = 5;
+    const float DT = 1.0f / 60.0f;
+
+    struct Position {
+        float x, y, z;
+    };
+
+    struct Velocity {
+        float x, y, z;
+    };
+
+    struct Health {
+        float value;
+    };
+
+    struct Frozen {
+        uint32_t frames;
+    };
+
+    // Rows of these leave room for only one or two entities per chunk
+    struct LargeBlob {
+        unsigned char bytes[9000];
+    };
+
+    struct MediumBlob {
+        unsigned char bytes[6000];
+    };
+
+    // What a classic object model would hold per entity
+    struct GameObject {
+        Position position;
+        Velocity velocity;
+        Health health;
+        char name[32];
+    };
+
+    void Populate(World &world, std::vector<Entity> &entities) {
+        entities.resize(ENTITY_COUNT);
+        for (uint32_t i = 0; i < ENTITY_COUNT; i++) {
+            float f = (float)i;
+            entities[i] = world.Create(Position{f, 0.0f, 0.0f}, Velocity{0.0f, f, 1.0f}, Health{100.0f});
+        }
+    }
+
+    void BenchIteration() {
+        World world;
+        std::vector<Entity> entities;
+        Populate(world, entities);
+
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            world.Each<Position, const Velocity>([](Position &position, const Velocity &velocity) {
+                position.x += velocity.x * DT;
+                position.y += velocity.y * DT;
+                position.z += velocity.z * DT;
+            });
+            Benchmark::DoNotOptimize(world);
+        });
+        Benchmark::Report("World::Each<Position, Velocity>, 1M", seconds, ENTITY_COUNT);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            world.EachChunk<Position, const Velocity>(
+                [](uint32_t count, const Entity *, Position *positions, const Velocity *velocities) {
+                    for (uint32_t i = 0; i < count; i++) {
+                        positions[i].x += velocities[i].x * DT;
+                        positions[i].y += velocities[i].y * DT;
+                        positions[i].z += velocities[i].z * DT;
+                    }
+                });
+            Benchmark::DoNotOptimize(world);
+        });
+        Benchmark::Report("World::EachChunk<Position, Velocity>, 1M", seconds, ENTITY_COUNT);
+
+        // Half the entities gain a tag, splitting the query across two archetypes
+        for (uint32_t i = 0; i < ENTITY_COUNT; i += 2)
+            world.Add<Frozen>(entities[i]);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            world.Each<Position, const Velocity>([](Position &position, const Velocity &velocity) {
+                position.x += velocity.x * DT;
+                position.y += velocity.y * DT;
+                position.z += velocity.z * DT;
+            });
+            Benchmark::DoNotOptimize(world);
+        });
+        Benchmark::Report("World::Each, 1M over 2 archetypes", seconds, ENTITY_COUNT);
+    }
+
+    void BenchObjects() {
+        std::vector<std::unique_ptr<GameObject>> objects;
+        objects.reserve(ENTITY_COUNT);
+        for (uint32_t i = 0; i < ENTITY_COUNT; i++) {
+            float f = (float)i;
+            objects.emplace_back(new GameObject{{f, 0.0f, 0.0f}, {0.0f, f, 1.0f}, {100.0f}, {}});
+        }
+
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            for (const std::unique_ptr<GameObject> &object : objects) {
+                object->position.x += object->velocity.x * DT;
+                object->position.y += object->velocity.y * DT;
+                object->position.z += object->velocity.z * DT;
+            }
+            Benchmark::DoNotOptimize(objects);
+        });
+        Benchmark::Report("std::vector<std::unique_ptr<T>> iterate, 1M", seconds, ENTITY_COUNT);
+    }
+
+    void BenchCreation() {
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            World world;
+            for (uint32_t i = 0; i < ENTITY_COUNT; i++) {
+                float f = (float)i;
+                world.Create(Position{f, 0.0f, 0.0f}, Velocity{0.0f, f, 1.0f}, Health{100.0f});
+            }
+            Benchmark::DoNotOptimize(world);
+        });
+        Benchmark::Report("World::Create<3 components>, 1M", seconds, ENTITY_COUNT);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            World world;
+            for (uint32_t i = 0; i < ENTITY_COUNT; i++) {
+                Entity entity = world.Create();
+                world.Add<Position>(entity, Position{(float)i, 0.0f, 0.0f});
+                world.Add<Velocity>(entity, Velocity{0.0f, (float)i, 1.0f});
+                world.Add<Health>(entity, Health{100.0f});
+            }
+            Benchmark::DoNotOptimize(world);
+        });
+        Benchmark::Report("World::Create + 3 Add, 1M", seconds, ENTITY_COUNT);
+    }
+
+    void BenchChurn() {
+        World world;
+        std::vector<Entity> entities;
+        Populate(world, entities);
+
+        uint32_t seed = 1;
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            for (uint32_t i = 0; i < CHURN_COUNT; i++) {
+                Entity entity = entities[Benchmark::Random(seed) % ENTITY_COUNT];
+                if (world.Has<Frozen>(entity))
+                    world.Remove<Frozen>(entity);
+                else
+                    world.Add<Frozen>(entity, Frozen{1});
+            }
+        });
+        Benchmark::Report("World::Add/Remove<Frozen>, 100k", seconds, CHURN_COUNT);
+
+        CommandBuffer commands;
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            for (uint32_t i = 0; i < CHURN_COUNT; i++) {
+                Entity entity = entities[Benchmark::Random(seed) % ENTITY_COUNT];
+                if (world.Has<Frozen>(entity))
+                    commands.Remove<Frozen>(entity);
+                else
+                    commands.Add<Frozen>(entity, Frozen{1});
+            }
+            commands.Playback(world);
+        });
+        Benchmark::Report("CommandBuffer Add/Remove<Frozen>, 100k", seconds, CHURN_COUNT);
+
+        // Steady spawn and despawn, as a particle system would see
+        std::vector<uint32_t> victims(CHURN_COUNT);
+        std::vector<Entity> created;
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            for (uint32_t i = 0; i < CHURN_COUNT; i++) {
+                victims[i] = Benchmark::Random(seed) % ENTITY_COUNT;
+                commands.Destroy(entities[victims[i]]);
+                Entity entity = commands.Create();
+                commands.Add<Position>(entity, Position{(float)i, 0.0f, 0.0f});
+                commands.Add<Velocity>(entity, Velocity{0.0f, 1.0f, 0.0f});
+            }
+            commands.Playback(world, &created);
+
+            for (uint32_t i = 0; i < CHURN_COUNT; i++)
+                entities[victims[i]] = created[i];
+        });
+        Benchmark::Report("CommandBuffer Destroy + Create, 100k", seconds, CHURN_COUNT);
+        printf("%u archetypes, %u entities\n", world.GetArchetypeCount(), world.GetEntityCount());
+    }
+
+    /**
+     * Creates and destroys entities whose rows nearly fill a chunk, then
+     * checks that every survivor still has its own entity and values
+     * @return the number of entities found wrong
+     */
+    template <typename Blob>
+    uint32_t CheckLargeRows() {
+        const uint32_t count = 64;
+        World world;
+        std::vector<Entity> entities;
+        for (uint32_t i = 0; i < count; i++) {
+            Blob blob;
+            std::memset(blob.bytes, (int)(i & 0xFF), sizeof(blob.bytes));
+            entities.push_back(world.Create(Position{(float)i, 0.0f, 0.0f}, blob));
+        }
+
+        // Destroying moves the last row of a chunk into the hole, which is where a bad layout shows
+        for (uint32_t i = 0; i < count; i += 2)
+            world.Destroy(entities[i]);
+
+        uint32_t wrong = 0;
+        for (uint32_t i = 1; i < count; i += 2) {
+            const Position *position = world.Get<Position>(entities[i]);
+            const Blob *blob = world.Get<Blob>(entities[i]);
+            bool intact = position && blob && position->x == (float)i;
+            for (size_t b = 0; intact && b < sizeof(blob->bytes); b++)
+                intact = blob->bytes[b] == (unsigned char)(i & 0xFF);
+            wrong += !intact;
+        }
+
+        uint32_t seen = 0;
+        world.EachChunk<const Position>([&](uint32_t rows, const Entity *chunkEntities, const Position *positions) {
+            for (uint32_t row = 0; row < rows; row++, seen++)
+                wrong += !(chunkEntities[row] == entities[(uint32_t)positions[row].x]);
+        });
+        return wrong + (seen != count / 2 ? 1 : 0);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    BenchIteration();
+    BenchObjects();
+    BenchCreation();
+    BenchChurn();
+
+    uint32_t wrong = CheckLargeRows<LargeBlob>() + CheckLargeRows<MediumBlob>();
+    printf("Large rows: %u entities wrong after destroying half (expected 0)\n", wrong);
+    return wrong == 0 ? 0 : 1;
+}
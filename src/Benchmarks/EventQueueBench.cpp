@@ -0,0 +1,82 @@
+//
+// Throughput of SDL_PushEvent from several producer threads while the main
+// thread drains, with and without the lock-free event ring.
+//
+
+#include "Benchmark.h"
+
+#include "ThirdParty/SDL/include/SDL.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const int EVENTS_PER_RUN = 1 << 20;
+    const int REPEATS = 3;
+
+    void Produce(int count, std::atomic<bool> &go) {
+        while (!go.load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        SDL_Event event;
+        SDL_zero(event);
+        event.type = SDL_USEREVENT;
+
+        for (int i = 0; i < count; i++) {
+            event.user.code = i;
+
+            // The queue caps out at 65535 events; wait for the reader to catch up
+            while (SDL_PushEvent(&event) <= 0)
+                std::this_thread::yield();
+        }
+    }
+
+    void RunProducers(int producers) {
+        std::atomic<bool> go(false);
+        std::vector<std::thread> threads;
+
+        int perThread = EVENTS_PER_RUN / producers;
+        for (int i = 0; i < producers; i++)
+            threads.emplace_back(Produce, perThread, std::ref(go));
+
+        go.store(true, std::memory_order_release);
+
+        SDL_Event batch[256];
+        int received = 0;
+        while (received < perThread * producers) {
+            int count = SDL_PeepEvents(batch, 256, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+            if (count > 0)
+                received += count;
+        }
+
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *modes[] = {"0", "1"};
+    const int producerCounts[] = {1, 2, 4, 8, 16};
+
+    for (const char *mode : modes) {
+        SDL_SetHint(SDL_HINT_EVENT_QUEUE_LOCKFREE, mode);
+        if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+            printf("Failed to init SDL: %s\n", SDL_GetError());
+            return 1;
+        }
+
+        for (int producers : producerCounts) {
+            double seconds = Benchmark::Measure(REPEATS, [producers] { RunProducers(producers); });
+
+            char name[64];
+            snprintf(name, sizeof(name), "PushEvent %s, %d producers", mode[0] == '1' ? "lock-free" : "mutex", producers);
+            Benchmark::Report(name, seconds, (uint64_t)(EVENTS_PER_RUN / producers) * producers);
+        }
+
+        SDL_Quit();
+    }
+
+    return 0;
+}
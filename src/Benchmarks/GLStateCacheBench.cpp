@@ -0,0 +1,345 @@
+//
+// GLStateCache against a mock GL driver: the cost of filtering a frame's
+// worth of state calls, how many reach the driver, and whether validation
+// catches state changed behind the cache's back. Needs no GPU.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Render/GLStateCache.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t DRAWS_PER_FRAME = 10000;
+    const uint32_t PROGRAM_COUNT = 16;
+    const uint32_t TEXTURE_COUNT = 64;
+    const uint32_t VERTEX_ARRAY_COUNT = 8;
+    const int FRAMES = 20;
+    const int REPEATS = 5;
+
+    /**
+     * Just enough of a driver to answer glGet* for the shadowed state
+     */
+    struct MockDriver {
+        uint64_t calls;
+        GLboolean caps[8];
+        GLint blendSource, blendDestination, depthFunction, depthWrite;
+        GLint program, activeUnit, textures[GLStateCache::MAX_TEXTURE_UNITS];
+        GLint arrayBuffer, elementBuffer, vertexArray;
+        GLfloat clearColor[4];
+        GLint viewport[4];
+    };
+
+    MockDriver s_driver;
+
+    GLboolean *FindCap(GLenum cap) {
+        static const GLenum caps[] = {GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST,
+                                      GL_POLYGON_OFFSET_FILL, GL_FRAMEBUFFER_SRGB};
+        for (size_t i = 0; i < sizeof(caps) / sizeof(caps[0]); i++) {
+            if (caps[i] == cap)
+                return &s_driver.caps[i];
+        }
+        return &s_driver.caps[7];
+    }
+
+    void GLAPIENTRY MockEnable(GLenum cap) {
+        s_driver.calls++;
+        *FindCap(cap) = GL_TRUE;
+    }
+
+    void GLAPIENTRY MockDisable(GLenum cap) {
+        s_driver.calls++;
+        *FindCap(cap) = GL_FALSE;
+    }
+
+    GLboolean GLAPIENTRY MockIsEnabled(GLenum cap) {
+        return *FindCap(cap);
+    }
+
+    void GLAPIENTRY MockBlendFunc(GLenum source, GLenum destination) {
+        s_driver.calls++;
+        s_driver.blendSource = source;
+        s_driver.blendDestination = destination;
+    }
+
+    void GLAPIENTRY MockDepthFunc(GLenum function) {
+        s_driver.calls++;
+        s_driver.depthFunction = function;
+    }
+
+    void GLAPIENTRY MockDepthMask(GLboolean flag) {
+        s_driver.calls++;
+        s_driver.depthWrite = flag;
+    }
+
+    void GLAPIENTRY MockUseProgram(GLuint program) {
+        s_driver.calls++;
+        s_driver.program = program;
+    }
+
+    void GLAPIENTRY MockActiveTexture(GLenum unit) {
+        s_driver.calls++;
+        s_driver.activeUnit = unit;
+    }
+
+    void GLAPIENTRY MockBindTexture(GLenum target, GLuint texture) {
+        s_driver.calls++;
+        s_driver.textures[(s_driver.activeUnit - GL_TEXTURE0) % GLStateCache::MAX_TEXTURE_UNITS] = texture;
+    }
+
+    void GLAPIENTRY MockBindBuffer(GLenum target, GLuint buffer) {
+        s_driver.calls++;
+        if (target == GL_ARRAY_BUFFER)
+            s_driver.arrayBuffer = buffer;
+        else if (target == GL_ELEMENT_ARRAY_BUFFER)
+            s_driver.elementBuffer = buffer;
+    }
+
+    void GLAPIENTRY MockBindVertexArray(GLuint array) {
+        s_driver.calls++;
+        s_driver.vertexArray = array;
+
+        // Each mock vertex array owns an index buffer with the same name
+        s_driver.elementBuffer = array;
+    }
+
+    void GLAPIENTRY MockClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+        s_driver.calls++;
+        s_driver.clearColor[0] = red;
+        s_driver.clearColor[1] = green;
+        s_driver.clearColor[2] = blue;
+        s_driver.clearColor[3] = alpha;
+    }
+
+    void GLAPIENTRY MockClear(GLbitfield mask) {
+        s_driver.calls++;
+    }
+
+    void GLAPIENTRY MockViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        s_driver.calls++;
+        s_driver.viewport[0] = x;
+        s_driver.viewport[1] = y;
+        s_driver.viewport[2] = width;
+        s_driver.viewport[3] = height;
+    }
+
+    void GLAPIENTRY MockGetIntegerv(GLenum name, GLint *values) {
+        switch (name) {
+        case GL_BLEND_SRC_RGB: *values = s_driver.blendSource; break;
+        case GL_BLEND_DST_RGB: *values = s_driver.blendDestination; break;
+        case GL_DEPTH_FUNC: *values = s_driver.depthFunction; break;
+        case GL_DEPTH_WRITEMASK: *values = s_driver.depthWrite; break;
+        case GL_CURRENT_PROGRAM: *values = s_driver.program; break;
+        case GL_ACTIVE_TEXTURE: *values = s_driver.activeUnit; break;
+        case GL_TEXTURE_BINDING_2D:
+            *values = s_driver.textures[(s_driver.activeUnit - GL_TEXTURE0) % GLStateCache::MAX_TEXTURE_UNITS];
+            break;
+        case GL_ARRAY_BUFFER_BINDING: *values = s_driver.arrayBuffer; break;
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING: *values = s_driver.elementBuffer; break;
+        case GL_VERTEX_ARRAY_BINDING: *values = s_driver.vertexArray; break;
+        case GL_VIEWPORT: std::memcpy(values, s_driver.viewport, sizeof(s_driver.viewport)); break;
+        default: *values = 0; break;
+        }
+    }
+
+    void GLAPIENTRY MockGetFloatv(GLenum name, GLfloat *values) {
+        if (name == GL_COLOR_CLEAR_VALUE)
+            std::memcpy(values, s_driver.clearColor, sizeof(s_driver.clearColor));
+    }
+
+    GLFunctions MockFunctions() {
+        GLFunctions functions;
+        functions.Enable = MockEnable;
+        functions.Disable = MockDisable;
+        functions.IsEnabled = MockIsEnabled;
+        functions.BlendFunc = MockBlendFunc;
+        functions.DepthFunc = MockDepthFunc;
+        functions.DepthMask = MockDepthMask;
+        functions.UseProgram = MockUseProgram;
+        functions.ActiveTexture = MockActiveTexture;
+        functions.BindTexture = MockBindTexture;
+        functions.BindBuffer = MockBindBuffer;
+        functions.BindVertexArray = MockBindVertexArray;
+        functions.ClearColor = MockClearColor;
+        functions.Clear = MockClear;
+        functions.Viewport = MockViewport;
+        functions.GetIntegerv = MockGetIntegerv;
+        functions.GetFloatv = MockGetFloatv;
+        return functions;
+    }
+
+    struct Draw {
+        GLuint program;
+        GLuint texture;
+        GLuint vertexArray;
+        bool blended;
+    };
+
+    /**
+     * Draws in the order a sorted render queue hands them out: grouped by
+     * program, then texture, with blended draws last
+     */
+    std::vector<Draw> MakeFrame() {
+        std::vector<Draw> draws(DRAWS_PER_FRAME);
+        for (uint32_t i = 0; i < DRAWS_PER_FRAME; i++) {
+            draws[i].blended = i >= DRAWS_PER_FRAME * 8 / 10;
+            draws[i].program = 1 + i * PROGRAM_COUNT / DRAWS_PER_FRAME;
+            draws[i].texture = 1 + (i * TEXTURE_COUNT / DRAWS_PER_FRAME + i % 3) % TEXTURE_COUNT;
+            draws[i].vertexArray = 1 + i % VERTEX_ARRAY_COUNT;
+        }
+        return draws;
+    }
+
+    /**
+     * The calls a renderer makes per draw when it doesn't track state itself
+     */
+    template <typename Gl>
+    void IssueFrame(Gl &gl, const std::vector<Draw> &draws) {
+        gl.Viewport(0, 0, 1920, 1080);
+        gl.ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        gl.Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        gl.Enable(GL_DEPTH_TEST);
+        gl.DepthFunc(GL_LEQUAL);
+
+        for (const Draw &draw : draws) {
+            gl.UseProgram(draw.program);
+            gl.ActiveTexture(GL_TEXTURE0);
+            gl.BindTexture(GL_TEXTURE_2D, draw.texture);
+            gl.BindVertexArray(draw.vertexArray);
+            if (draw.blended) {
+                gl.Enable(GL_BLEND);
+                gl.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                gl.DepthMask(false);
+            } else {
+                gl.Disable(GL_BLEND);
+                gl.DepthMask(true);
+            }
+        }
+    }
+
+    /**
+     * Calls the mock directly, with the cache's interface, as the baseline
+     */
+    struct DirectGl {
+        GLFunctions functions;
+
+        void Enable(GLenum cap) { functions.Enable(cap); }
+        void Disable(GLenum cap) { functions.Disable(cap); }
+        void BlendFunc(GLenum source, GLenum destination) { functions.BlendFunc(source, destination); }
+        void DepthFunc(GLenum function) { functions.DepthFunc(function); }
+        void DepthMask(bool write) { functions.DepthMask(write ? GL_TRUE : GL_FALSE); }
+        void UseProgram(GLuint program) { functions.UseProgram(program); }
+        void ActiveTexture(GLenum unit) { functions.ActiveTexture(unit); }
+        void BindTexture(GLenum target, GLuint texture) { functions.BindTexture(target, texture); }
+        void BindVertexArray(GLuint array) { functions.BindVertexArray(array); }
+        void ClearColor(float r, float g, float b, float a) { functions.ClearColor(r, g, b, a); }
+        void Viewport(GLint x, GLint y, GLsizei w, GLsizei h) { functions.Viewport(x, y, w, h); }
+        void Clear(GLbitfield mask) { functions.Clear(mask); }
+    };
+
+    /**
+     * The calls a perfect filter lets through in a frame that follows
+     * another one like it: the clear, and per draw whatever differs from
+     * the draw before, with the last draw of the frame before the first
+     */
+    uint32_t ExpectedIssued(const std::vector<Draw> &draws) {
+        uint32_t issued = 1;
+        for (size_t i = 0; i < draws.size(); i++) {
+            const Draw &previous = draws[i > 0 ? i - 1 : draws.size() - 1];
+            issued += draws[i].program != previous.program;
+            issued += draws[i].texture != previous.texture;
+            issued += draws[i].vertexArray != previous.vertexArray;
+
+            // Enable or Disable of GL_BLEND, and DepthMask
+            issued += draws[i].blended != previous.blended ? 2 : 0;
+        }
+        return issued;
+    }
+
+    /**
+     * A fresh cache has no idea which texture unit is active, but binding
+     * the same texture twice must still reach the driver only once
+     * @return the mismatches found
+     */
+    uint32_t CheckUnknownUnit() {
+        GLStateCache cache;
+        cache.SetFunctions(MockFunctions());
+
+        s_driver.activeUnit = GL_TEXTURE0;
+        s_driver.calls = 0;
+        cache.BindTexture(GL_TEXTURE_2D, 7);
+        cache.BindTexture(GL_TEXTURE_2D, 7);
+        cache.EndFrame();
+
+        GLStateStats stats = cache.GetLastFrameStats();
+        uint32_t mismatches = s_driver.calls != 1;
+        mismatches += stats.issued != 1 || stats.filtered != 1;
+        mismatches += s_driver.textures[0] != 7;
+
+        // Validation reads the unit back from the driver as well
+        return mismatches + cache.Validate();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<Draw> draws = MakeFrame();
+    uint64_t callsPerFrame = 5 + (uint64_t)DRAWS_PER_FRAME * 6 + DRAWS_PER_FRAME / 5;
+
+    DirectGl direct = {MockFunctions()};
+    s_driver.calls = 0;
+    double seconds = Benchmark::Measure(REPEATS, [&] {
+        for (int frame = 0; frame < FRAMES; frame++)
+            IssueFrame(direct, draws);
+    });
+    Benchmark::Report("Direct calls into the mock driver", seconds, callsPerFrame * FRAMES);
+    uint64_t directCalls = s_driver.calls / (REPEATS * FRAMES);
+    printf("  %llu driver calls per frame (expected %llu)\n", (unsigned long long)directCalls,
+           (unsigned long long)callsPerFrame);
+
+    GLStateCache cache;
+    cache.SetFunctions(MockFunctions());
+    seconds = Benchmark::Measure(REPEATS, [&] {
+        for (int frame = 0; frame < FRAMES; frame++) {
+            IssueFrame(cache, draws);
+            cache.EndFrame();
+        }
+    });
+    Benchmark::Report("Through GLStateCache", seconds, callsPerFrame * FRAMES);
+
+    // One more frame on its own, so the driver calls line up with the stats
+    s_driver.calls = 0;
+    IssueFrame(cache, draws);
+    cache.EndFrame();
+    GLStateStats stats = cache.GetLastFrameStats();
+    uint32_t expectedIssued = ExpectedIssued(draws);
+    printf("  %llu driver calls per frame, %u issued and %u filtered (expected %u and %llu)\n",
+           (unsigned long long)s_driver.calls, stats.issued, stats.filtered, expectedIssued,
+           (unsigned long long)(callsPerFrame - expectedIssued));
+
+    bool passed = directCalls == callsPerFrame;
+    passed &= s_driver.calls == stats.issued;
+    passed &= stats.issued == expectedIssued && stats.issued + stats.filtered == callsPerFrame;
+
+    // Validation should stay quiet while the shadow is right...
+    cache.SetValidation(true);
+    IssueFrame(cache, draws);
+    uint32_t clean = cache.Validate();
+
+    // ...and name the state changed behind the cache's back
+    s_driver.program = 999;
+    MockBindVertexArray(999);
+    uint32_t broken = cache.Validate();
+    printf("Validation: %u mismatches while in sync, %u after bypassing the cache (expected 0 and 2)\n", clean,
+           broken);
+    passed &= clean == 0 && broken == 2;
+
+    uint32_t unknownUnit = CheckUnknownUnit();
+    printf("Binds before any ActiveTexture: %u mismatches (expected 0)\n", unknownUnit);
+    passed &= unknownUnit == 0;
+    return passed ? 0 : 1;
+}
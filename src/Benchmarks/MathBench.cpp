@@ -0,0 +1,87 @@
+//
+// Transform-heavy math workloads. Built twice: MathBench uses SSE2/NEON and
+// MathBenchScalar forces the portable fallback, so their outputs compare directly.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Math/Matrix4.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const int POINT_COUNT = 1 << 20;
+    const int MATRIX_COUNT = 1 << 16;
+    const int REPEATS = 10;
+
+    float RandomSigned(uint32_t &seed) {
+        return (float)Benchmark::Random(seed) / (float)(1 << 24) * 2.0f - 1.0f;
+    }
+
+    Quaternion RandomRotation(uint32_t &seed) {
+        return Quaternion(RandomSigned(seed), RandomSigned(seed), RandomSigned(seed), RandomSigned(seed)).Normalized();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t seed = 1;
+
+    std::vector<Vector4> points(POINT_COUNT);
+    std::vector<Vector4> transformed(POINT_COUNT);
+    for (Vector4 &point : points)
+        point = Vector4(RandomSigned(seed), RandomSigned(seed), RandomSigned(seed), 1.0f);
+
+    std::vector<Matrix4> parents(MATRIX_COUNT), locals(MATRIX_COUNT), worlds(MATRIX_COUNT);
+    std::vector<Quaternion> rotations(MATRIX_COUNT), combined(MATRIX_COUNT);
+    for (int i = 0; i < MATRIX_COUNT; i++) {
+        Vector3 offset(RandomSigned(seed), RandomSigned(seed), RandomSigned(seed));
+        rotations[i] = RandomRotation(seed);
+        parents[i] = Matrix4::TRS(offset, rotations[i], Vector3::ONE);
+        locals[i] = Matrix4::TRS(-offset, RandomRotation(seed), Vector3(2.0f, 2.0f, 2.0f));
+    }
+
+    Matrix4 viewProjection = Matrix4::Perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) *
+                             Matrix4::Translation(Vector3(0.0f, 0.0f, -5.0f));
+
+    printf("Math backend: %s\n", Simd::NAME);
+
+    double seconds = Benchmark::Measure(REPEATS, [&] {
+        viewProjection.Transform(points.data(), transformed.data(), points.size());
+        Benchmark::DoNotOptimize(transformed[POINT_COUNT - 1]);
+    });
+    Benchmark::Report("Matrix4::Transform, 1M points", seconds, POINT_COUNT);
+
+    seconds = Benchmark::Measure(REPEATS, [&] {
+        for (int i = 0; i < POINT_COUNT; i++)
+            transformed[i] = viewProjection * points[i];
+        Benchmark::DoNotOptimize(transformed[POINT_COUNT - 1]);
+    });
+    Benchmark::Report("Matrix4 * Vector4, 1M points", seconds, POINT_COUNT);
+
+    seconds = Benchmark::Measure(REPEATS, [&] {
+        for (int i = 0; i < MATRIX_COUNT; i++)
+            worlds[i] = viewProjection * (parents[i] * locals[i]);
+        Benchmark::DoNotOptimize(worlds[MATRIX_COUNT - 1]);
+    });
+    Benchmark::Report("Matrix4 * Matrix4 * Matrix4, 64k", seconds, MATRIX_COUNT);
+
+    seconds = Benchmark::Measure(REPEATS, [&] {
+        for (int i = 0; i < MATRIX_COUNT; i++)
+            combined[i] = rotations[i] * rotations[MATRIX_COUNT - 1 - i];
+        Benchmark::DoNotOptimize(combined[MATRIX_COUNT - 1]);
+    });
+    Benchmark::Report("Quaternion * Quaternion, 64k", seconds, MATRIX_COUNT);
+
+    seconds = Benchmark::Measure(REPEATS, [&] {
+        for (int i = 0; i < MATRIX_COUNT; i++)
+            combined[i] = rotations[i].Nlerp(rotations[MATRIX_COUNT - 1 - i], 0.25f);
+        Benchmark::DoNotOptimize(combined[MATRIX_COUNT - 1]);
+    });
+    Benchmark::Report("Quaternion::Nlerp, 64k", seconds, MATRIX_COUNT);
+
+    return 0;
+}
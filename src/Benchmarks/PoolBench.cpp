@@ -0,0 +1,113 @@
+//
+// Pool<T> against std::vector<std::unique_ptr<T>> for iteration and for
+// steady create/destroy churn, as a particle system would see.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Core/Pool.h"
+#include "Engine/Math/Vector3.h"
+
+#include <memory>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t PARTICLE_COUNT = 100000;
+    const int CHURN_FRAMES = 100;
+    const uint32_t CHURN_PER_FRAME = PARTICLE_COUNT / 10;
+    const int REPEATS = 5;
+
+    struct Particle {
+        Vector3 position;
+        Vector3 velocity;
+        float life;
+
+        Particle(float seed) : position(seed, 0.0f, 0.0f), velocity(0.0f, seed, 1.0f), life(1.0f) {}
+    };
+
+    void Integrate(Particle &particle) {
+        particle.position += particle.velocity * (1.0f / 60.0f);
+        particle.life -= 1.0f / 60.0f;
+    }
+
+    void BenchPool() {
+        Pool<Particle> pool(PARTICLE_COUNT);
+        std::vector<Pool<Particle>::Handle> handles(PARTICLE_COUNT);
+        for (uint32_t i = 0; i < PARTICLE_COUNT; i++)
+            handles[i] = pool.Create((float)i);
+
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            for (Particle &particle : pool)
+                Integrate(particle);
+            Benchmark::DoNotOptimize(pool[0]);
+        });
+        Benchmark::Report("Pool iterate, 100k", seconds, PARTICLE_COUNT);
+
+        uint32_t seed = 1;
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            for (int frame = 0; frame < CHURN_FRAMES; frame++) {
+                for (uint32_t i = 0; i < CHURN_PER_FRAME; i++) {
+                    uint32_t victim = Benchmark::Random(seed) % PARTICLE_COUNT;
+                    pool.Destroy(handles[victim]);
+                    handles[victim] = pool.Create((float)victim);
+                }
+            }
+        });
+        Benchmark::Report("Pool destroy+create", seconds, (uint64_t)CHURN_FRAMES * CHURN_PER_FRAME);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            for (Particle &particle : pool)
+                Integrate(particle);
+            Benchmark::DoNotOptimize(pool[0]);
+        });
+        Benchmark::Report("Pool iterate after churn, 100k", seconds, PARTICLE_COUNT);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            for (uint32_t i = 0; i < PARTICLE_COUNT; i++)
+                Integrate(*pool.Get(handles[i]));
+            Benchmark::DoNotOptimize(pool[0]);
+        });
+        Benchmark::Report("Pool lookup by handle, 100k", seconds, PARTICLE_COUNT);
+    }
+
+    void BenchUniquePtr() {
+        std::vector<std::unique_ptr<Particle>> particles;
+        particles.reserve(PARTICLE_COUNT);
+        for (uint32_t i = 0; i < PARTICLE_COUNT; i++)
+            particles.emplace_back(new Particle((float)i));
+
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            for (std::unique_ptr<Particle> &particle : particles)
+                Integrate(*particle);
+            Benchmark::DoNotOptimize(*particles[0]);
+        });
+        Benchmark::Report("vector<unique_ptr> iterate, 100k", seconds, PARTICLE_COUNT);
+
+        uint32_t seed = 1;
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            for (int frame = 0; frame < CHURN_FRAMES; frame++) {
+                for (uint32_t i = 0; i < CHURN_PER_FRAME; i++) {
+                    uint32_t victim = Benchmark::Random(seed) % PARTICLE_COUNT;
+                    particles[victim].reset(new Particle((float)victim));
+                }
+            }
+        });
+        Benchmark::Report("vector<unique_ptr> destroy+create", seconds, (uint64_t)CHURN_FRAMES * CHURN_PER_FRAME);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            for (std::unique_ptr<Particle> &particle : particles)
+                Integrate(*particle);
+            Benchmark::DoNotOptimize(*particles[0]);
+        });
+        Benchmark::Report("vector<unique_ptr> iterate after churn, 100k", seconds, PARTICLE_COUNT);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    BenchPool();
+    BenchUniquePtr();
+    return 0;
+}
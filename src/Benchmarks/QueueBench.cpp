@@ -0,0 +1,128 @@
+//
+// Handoff throughput of SpscQueue and MpmcQueue against a std::mutex
+// guarded std::deque, with 1 to 16 producers feeding one consumer.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Core/MpmcQueue.h"
+#include "Engine/Core/SpscQueue.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t ITEMS_PER_RUN = 1 << 20;
+    const uint32_t QUEUE_CAPACITY = 1024;
+    const int REPEATS = 3;
+
+    /**
+     * The baseline: what the engine would write without lock-free queues
+     */
+    class MutexQueue {
+    public:
+        explicit MutexQueue(uint32_t capacity) : m_capacity(capacity) {}
+
+        bool TryPush(uint64_t item) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_items.size() == m_capacity)
+                return false;
+            m_items.push_back(item);
+            return true;
+        }
+
+        bool TryPop(uint64_t &item) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_items.empty())
+                return false;
+            item = m_items.front();
+            m_items.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::deque<uint64_t> m_items;
+        size_t m_capacity;
+    };
+
+    /**
+     * Pushes ITEMS_PER_RUN items split across \c producers threads while
+     * the calling thread pops them all
+     * @return false if the items popped don't add up to the ones pushed
+     */
+    template <typename Queue>
+    bool RunHandoff(Queue &queue, int producers) {
+        std::atomic<bool> go(false);
+        std::vector<std::thread> threads;
+
+        uint32_t perThread = ITEMS_PER_RUN / producers;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&queue, &go, perThread, p]() {
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+
+                uint64_t base = (uint64_t)p * perThread;
+                for (uint32_t i = 0; i < perThread; i++) {
+                    while (!queue.TryPush(base + i))
+                        std::this_thread::yield();
+                }
+            });
+        }
+
+        go.store(true, std::memory_order_release);
+
+        uint64_t item;
+        uint64_t sum = 0;
+        uint32_t total = perThread * producers;
+        for (uint32_t received = 0; received < total;) {
+            if (queue.TryPop(item)) {
+                sum += item;
+                received++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        for (std::thread &thread : threads)
+            thread.join();
+
+        // Every item arrives exactly once
+        uint64_t expected = (uint64_t)total * (total - 1) / 2;
+        if (sum != expected) {
+            printf("Checksum mismatch: %llu != %llu\n", (unsigned long long)sum, (unsigned long long)expected);
+            return false;
+        }
+        return true;
+    }
+
+    template <typename Queue>
+    bool Bench(const char *name, int producers) {
+        bool passed = true;
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            Queue queue(QUEUE_CAPACITY);
+            passed &= RunHandoff(queue, producers);
+        });
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s, %d producer%s", name, producers, producers > 1 ? "s" : "");
+        Benchmark::Report(label, seconds, ITEMS_PER_RUN / producers * producers);
+        return passed;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bool passed = Bench<SpscQueue<uint64_t>>("SpscQueue", 1);
+
+    for (int producers = 1; producers <= 16; producers *= 2) {
+        passed &= Bench<MpmcQueue<uint64_t>>("MpmcQueue", producers);
+        passed &= Bench<MutexQueue>("std::mutex + std::deque", producers);
+    }
+    return passed ? 0 : 1;
+}
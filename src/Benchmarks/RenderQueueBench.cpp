@@ -0,0 +1,154 @@
+//
+// Recording, sorting and submitting a frame of draws through RenderQueue
+// into the null backend, with the radix sort on one thread and on every
+// thread against std::stable_sort.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Core/JobSystem.h"
+#include "Engine/Render/NullRenderBackend.h"
+#include "Engine/Render/RadixSort.h"
+#include "Engine/Render/RenderKey.h"
+#include "Engine/Render/RenderQueue.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t DRAW_COUNT = 200000;
+    const uint32_t SHADER_COUNT = 64;
+    const uint32_t MATERIAL_COUNT = 256;
+    const uint32_t MESH_COUNT = 32;
+    const int REPEATS = 5;
+
+    /**
+     * A plausible frame: mostly opaque world geometry, some blended
+     * effects and a little UI, with shader and material drawn at random
+     */
+    DrawCommand MakeDraw(uint32_t i, uint64_t &key) {
+        uint32_t seed = i * 2654435761u + 1;
+        DrawCommand command;
+        command.shader = 1 + Benchmark::Random(seed) % SHADER_COUNT;
+        command.material = 1 + Benchmark::Random(seed) % MATERIAL_COUNT;
+        command.mesh = 1 + Benchmark::Random(seed) % MESH_COUNT;
+        command.firstVertex = 0;
+        command.vertexCount = 36;
+        command.depthTest = true;
+        command.depthWrite = true;
+        command.blend = BlendMode::Opaque;
+        float depth = (Benchmark::Random(seed) & 0xFFFF) / 65535.0f;
+
+        uint32_t kind = i % 10;
+        if (kind < 7) {
+            key = RenderKey::MakeOpaque(0, 0, command.shader, command.material, depth);
+        } else if (kind < 9) {
+            command.blend = BlendMode::Alpha;
+            command.depthWrite = false;
+            key = RenderKey::MakeBlended(0, 1, command.shader, command.material, depth);
+        } else {
+            command.blend = BlendMode::Alpha;
+            command.depthTest = false;
+            command.depthWrite = false;
+            key = RenderKey::MakeBlended(1, 0, command.shader, command.material, depth);
+        }
+        return command;
+    }
+
+    void Record(RenderQueue &queue, JobSystem &jobs, bool sortable) {
+        jobs.ParallelFor(DRAW_COUNT, [&](size_t begin, size_t end) {
+            RenderCommandBuffer &buffer = queue.GetBuffer(jobs.GetThreadIndex());
+            for (size_t i = begin; i < end; i++) {
+                uint64_t key;
+                DrawCommand command = MakeDraw((uint32_t)i, key);
+                buffer.Add(sortable ? key : 0, command);
+            }
+        }, 1024);
+    }
+
+    /**
+     * @return false if RadixSort disagrees with std::stable_sort
+     */
+    bool BenchSort(JobSystem &jobs) {
+        std::vector<RadixSortItem> input(DRAW_COUNT);
+        for (uint32_t i = 0; i < DRAW_COUNT; i++) {
+            MakeDraw(i, input[i].key);
+            input[i].buffer = 0;
+            input[i].index = i;
+        }
+
+        std::vector<RadixSortItem> items(DRAW_COUNT);
+        std::vector<RadixSortItem> scratch(DRAW_COUNT);
+        RadixSortItem *sorted = nullptr;
+
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            items = input;
+            sorted = RadixSort(items.data(), scratch.data(), DRAW_COUNT, nullptr);
+        });
+        Benchmark::Report("RadixSort, 1 thread, 200k", seconds, DRAW_COUNT);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            items = input;
+            sorted = RadixSort(items.data(), scratch.data(), DRAW_COUNT, &jobs);
+        });
+        char label[64];
+        snprintf(label, sizeof(label), "RadixSort, %u threads, 200k", jobs.GetThreadCount());
+        Benchmark::Report(label, seconds, DRAW_COUNT);
+
+        std::vector<RadixSortItem> reference;
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            reference = input;
+            std::stable_sort(reference.begin(), reference.end(),
+                             [](const RadixSortItem &a, const RadixSortItem &b) { return a.key < b.key; });
+        });
+        Benchmark::Report("std::stable_sort, 200k", seconds, DRAW_COUNT);
+
+        for (uint32_t i = 0; i < DRAW_COUNT; i++) {
+            if (sorted[i].key != reference[i].key || sorted[i].index != reference[i].index) {
+                printf("RadixSort disagrees with std::stable_sort at %u\n", i);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void BenchQueue(JobSystem &jobs, bool sortable) {
+        RenderQueue queue(jobs.GetThreadCount());
+        NullRenderBackend backend;
+
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            queue.Clear();
+            Record(queue, jobs, sortable);
+        });
+        Benchmark::Report(sortable ? "Record, 200k" : "Record unsorted, 200k", seconds, DRAW_COUNT);
+
+        seconds = Benchmark::Measure(REPEATS, [&] { queue.Sort(&jobs); });
+        Benchmark::Report(sortable ? "Sort, 200k" : "Sort with equal keys, 200k", seconds, DRAW_COUNT);
+
+        seconds = Benchmark::Measure(REPEATS, [&] {
+            backend.BeginFrame(Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+            queue.Submit(backend);
+            backend.EndFrame();
+        });
+        Benchmark::Report(sortable ? "Submit, 200k" : "Submit unsorted, 200k", seconds, DRAW_COUNT);
+
+        const RenderQueueStats &stats = queue.GetStats();
+        printf("  %u draws, %u state changes, %u redundant states filtered\n", stats.draws, stats.stateChanges,
+               stats.redundantStates);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    JobSystem jobs;
+    jobs.Start();
+
+    bool passed = BenchSort(jobs);
+    BenchQueue(jobs, true);
+    BenchQueue(jobs, false);
+
+    jobs.Stop();
+    return passed ? 0 : 1;
+}
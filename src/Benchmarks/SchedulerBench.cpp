@@ -0,0 +1,346 @@
+//
+// SystemScheduler running a frame of six systems with overlapping and
+// disjoint component access over 100k entities, on the job system and
+// in order on one thread, followed by checks of the order it runs them
+// in, what it runs together, command playback and what it reports.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Core/JobSystem.h"
+#include "Engine/ECS/SystemScheduler.h"
+#include "Engine/ECS/World.h"
+#include "Engine/Profiler/Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t ENTITY_COUNT = 100000;
+    const uint32_t CHECK_ENTITY_COUNT = 1000;
+    const uint32_t SYSTEM_COUNT = 6;
+    const uint32_t SPAWNS_PER_SYSTEM = 4;
+    const int REPEATS = 10;
+    const int CHECK_RUNS = 50;
+    const float DT = 1.0f / 60.0f;
+
+    // How long a pair of systems waits to see the other one start before giving up
+    const uint64_t RENDEZVOUS_TIMEOUT_NS = 1000000000;
+
+    struct Position {
+        float x, y;
+    };
+
+    struct Velocity {
+        float x, y;
+    };
+
+    struct Health {
+        float value;
+    };
+
+    struct Lifetime {
+        float seconds;
+    };
+
+    // Created through the command buffers, to see the order they play back in
+    struct Spawned {
+        uint32_t system;
+        uint32_t sequence;
+    };
+
+    /**
+     * What the systems write down about themselves while they run
+     */
+    struct Probe {
+        std::atomic<uint32_t> ticket;
+        uint32_t started[SYSTEM_COUNT];
+        uint32_t finished[SYSTEM_COUNT];
+
+        // Extra busy time per system, varied between runs so systems finish in a different order
+        uint64_t spinNs[SYSTEM_COUNT];
+
+        // Set for a run where Regen and Age each wait until the other has started
+        bool rendezvous;
+        std::atomic<bool> arrived[SYSTEM_COUNT];
+        bool met[SYSTEM_COUNT];
+
+        // Set to record Spawned entities
+        bool spawn;
+    };
+
+    struct SystemData {
+        Probe *probe;
+        uint32_t index;
+        uint32_t partner;
+    };
+
+    // Systems in registration order, and which earlier ones each has to wait for
+    enum SystemIndex : uint32_t { INTEGRATE, REGEN, AGE, STEER, CLAMP, CULL };
+
+    const std::vector<uint32_t> EXPECTED_DEPENDENCIES[SYSTEM_COUNT] = {
+        {}, {}, {}, {INTEGRATE}, {INTEGRATE, STEER}, {REGEN, AGE},
+    };
+
+    void Spin(uint64_t ns) {
+        uint64_t start = Profiler::Now();
+        while (Profiler::Now() - start < ns)
+            std::this_thread::yield();
+    }
+
+    /**
+     * Shared start and end of every system: tickets, busy time, the rendezvous and spawns
+     */
+    template <typename Body>
+    void RunSystem(SystemContext &context, void *userData, Body &&body) {
+        SystemData &data = *static_cast<SystemData *>(userData);
+        Probe &probe = *data.probe;
+        probe.started[data.index] = probe.ticket.fetch_add(1, std::memory_order_acq_rel);
+
+        if (probe.rendezvous && data.partner != data.index) {
+            probe.arrived[data.index].store(true, std::memory_order_release);
+            uint64_t start = Profiler::Now();
+            while (!probe.arrived[data.partner].load(std::memory_order_acquire) &&
+                   Profiler::Now() - start < RENDEZVOUS_TIMEOUT_NS)
+                std::this_thread::yield();
+            probe.met[data.index] = probe.arrived[data.partner].load(std::memory_order_acquire);
+        }
+
+        body(context.world, context.dt);
+        Spin(probe.spinNs[data.index]);
+
+        if (probe.spawn) {
+            for (uint32_t i = 0; i < SPAWNS_PER_SYSTEM; i++)
+                context.commands.Add<Spawned>(context.commands.Create(), Spawned{data.index, i});
+        }
+        probe.finished[data.index] = probe.ticket.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    void Integrate(SystemContext &context, void *userData) {
+        RunSystem(context, userData, [](World &world, float dt) {
+            world.Each<Position, const Velocity>([dt](Position &position, const Velocity &velocity) {
+                position.x += velocity.x * dt;
+                position.y += velocity.y * dt;
+            });
+        });
+    }
+
+    void Regen(SystemContext &context, void *userData) {
+        RunSystem(context, userData, [](World &world, float dt) {
+            world.Each<Health>([dt](Health &health) { health.value = std::min(health.value + dt, 100.0f); });
+        });
+    }
+
+    void Age(SystemContext &context, void *userData) {
+        RunSystem(context, userData, [](World &world, float dt) {
+            world.Each<Lifetime>([dt](Lifetime &lifetime) { lifetime.seconds -= dt; });
+        });
+    }
+
+    void Steer(SystemContext &context, void *userData) {
+        RunSystem(context, userData, [](World &world, float) {
+            world.Each<const Position, Velocity>([](const Position &position, Velocity &velocity) {
+                velocity.x -= position.x * 0.001f;
+                velocity.y -= position.y * 0.001f;
+            });
+        });
+    }
+
+    void Clamp(SystemContext &context, void *userData) {
+        RunSystem(context, userData, [](World &world, float) {
+            world.Each<Position>([](Position &position) {
+                position.x = std::min(std::max(position.x, -1000.0f), 1000.0f);
+                position.y = std::min(std::max(position.y, -1000.0f), 1000.0f);
+            });
+        });
+    }
+
+    void Cull(SystemContext &context, void *userData) {
+        RunSystem(context, userData, [](World &world, float) {
+            uint32_t dying = 0;
+            world.Each<const Health, const Lifetime>([&dying](const Health &health, const Lifetime &lifetime) {
+                dying += health.value <= 0.0f || lifetime.seconds <= 0.0f;
+            });
+            Benchmark::DoNotOptimize(dying);
+        });
+    }
+
+    void Populate(World &world, uint32_t count) {
+        uint32_t seed = 7;
+        for (uint32_t i = 0; i < count; i++) {
+            float x = (float)(Benchmark::Random(seed) % 2000) - 1000.0f;
+            float y = (float)(Benchmark::Random(seed) % 2000) - 1000.0f;
+            world.Create(Position{x, y}, Velocity{1.0f, -1.0f}, Health{50.0f}, Lifetime{(float)(i % 600)});
+        }
+    }
+
+    /**
+     * Registers the six systems. Regen and Age touch nothing the others
+     * write, so they are each other's rendezvous partner.
+     */
+    void RegisterSystems(SystemScheduler &scheduler, Probe &probe, SystemData *data) {
+        for (uint32_t i = 0; i < SYSTEM_COUNT; i++)
+            data[i] = SystemData{&probe, i, i};
+        data[REGEN].partner = AGE;
+        data[AGE].partner = REGEN;
+
+        scheduler.Register("Integrate", Integrate, &data[INTEGRATE], MakeComponentMask<Velocity>(),
+                           MakeComponentMask<Position>());
+        scheduler.Register("Regen", Regen, &data[REGEN], ComponentMask(), MakeComponentMask<Health>());
+        scheduler.Register("Age", Age, &data[AGE], ComponentMask(), MakeComponentMask<Lifetime>());
+        scheduler.Register("Steer", Steer, &data[STEER], MakeComponentMask<Position>(),
+                           MakeComponentMask<Velocity>());
+        scheduler.Register("Clamp", Clamp, &data[CLAMP], ComponentMask(), MakeComponentMask<Position>());
+        scheduler.Register("Cull", Cull, &data[CULL], MakeComponentMask<Health, Lifetime>(), ComponentMask());
+    }
+
+    void ResetProbe(Probe &probe) {
+        probe.ticket.store(0, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < SYSTEM_COUNT; i++) {
+            probe.started[i] = 0;
+            probe.finished[i] = 0;
+            probe.spinNs[i] = 0;
+            probe.arrived[i].store(false, std::memory_order_relaxed);
+            probe.met[i] = false;
+        }
+        probe.rendezvous = false;
+        probe.spawn = false;
+    }
+
+    /**
+     * Gets the systems of the Spawned entities in the order they were created
+     */
+    std::vector<uint32_t> GetSpawnOrder(World &world) {
+        std::vector<std::pair<uint32_t, uint32_t>> spawned;
+        world.EachChunk<const Spawned>([&spawned](uint32_t count, const Entity *entities, const Spawned *values) {
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t rank = values[i].system * SPAWNS_PER_SYSTEM + values[i].sequence;
+                spawned.push_back(std::make_pair(entities[i].index, rank));
+            }
+        });
+        std::sort(spawned.begin(), spawned.end());
+
+        std::vector<uint32_t> order;
+        for (const std::pair<uint32_t, uint32_t> &entry : spawned)
+            order.push_back(entry.second);
+        return order;
+    }
+
+    void BenchRun(JobSystem &jobs) {
+        World world;
+        Populate(world, ENTITY_COUNT);
+
+        Probe probe;
+        ResetProbe(probe);
+        SystemData data[SYSTEM_COUNT];
+        SystemScheduler scheduler;
+        RegisterSystems(scheduler, probe, data);
+
+        char label[64];
+        snprintf(label, sizeof(label), "SystemScheduler::Run, %u threads, 100k", jobs.GetThreadCount());
+        double seconds = Benchmark::Measure(REPEATS, [&] { scheduler.Run(world, jobs, DT); });
+        Benchmark::Report(label, seconds, ENTITY_COUNT);
+
+        // Not started, so Run() calls every system in order on this thread
+        JobSystem serial;
+        seconds = Benchmark::Measure(REPEATS, [&] { scheduler.Run(world, serial, DT); });
+        Benchmark::Report("SystemScheduler::Run, in order, 100k", seconds, ENTITY_COUNT);
+    }
+
+    /**
+     * @return false if any check failed
+     */
+    bool CheckSchedule(JobSystem &jobs) {
+        World world;
+        Populate(world, CHECK_ENTITY_COUNT);
+
+        Probe probe;
+        ResetProbe(probe);
+        SystemData data[SYSTEM_COUNT];
+        SystemScheduler scheduler;
+        RegisterSystems(scheduler, probe, data);
+
+        uint32_t wrongEdges = 0;
+        for (uint32_t i = 0; i < SYSTEM_COUNT; i++)
+            wrongEdges += scheduler.GetDependencies(i) != EXPECTED_DEPENDENCIES[i];
+        printf("Schedule:\n");
+        scheduler.PrintSchedule();
+        printf("Edges: %u systems with unexpected dependencies (expected 0)\n", wrongEdges);
+
+        // Every dependent must start after each of its dependencies finished, however long they take
+        uint32_t seed = 11;
+        uint32_t outOfOrder = 0;
+        std::vector<uint32_t> firstSpawns;
+        uint32_t differentSpawns = 0;
+        for (int run = 0; run < CHECK_RUNS; run++) {
+            World spawnWorld;
+            ResetProbe(probe);
+            probe.spawn = true;
+            for (uint32_t i = 0; i < SYSTEM_COUNT; i++)
+                probe.spinNs[i] = (Benchmark::Random(seed) % 200) * 1000;
+            scheduler.Run(spawnWorld, jobs, DT);
+
+            for (uint32_t i = 0; i < SYSTEM_COUNT; i++) {
+                for (uint32_t dependency : scheduler.GetDependencies(i))
+                    outOfOrder += probe.started[i] < probe.finished[dependency];
+            }
+
+            std::vector<uint32_t> spawns = GetSpawnOrder(spawnWorld);
+            if (run == 0)
+                firstSpawns = spawns;
+            differentSpawns += spawns != firstSpawns;
+        }
+        printf("Ordering: %u dependents started before a dependency finished in %d runs (expected 0)\n", outOfOrder,
+               CHECK_RUNS);
+
+        bool registrationOrder = firstSpawns.size() == SYSTEM_COUNT * SPAWNS_PER_SYSTEM;
+        for (uint32_t i = 0; registrationOrder && i < firstSpawns.size(); i++)
+            registrationOrder = firstSpawns[i] == i;
+        printf("Playback: %u of %d runs differ from the first, first run %s\n", differentSpawns, CHECK_RUNS,
+               registrationOrder ? "in registration order" : "out of registration order");
+
+        // Regen and Age each wait to see the other start, which only works if neither waits on the other
+        ResetProbe(probe);
+        probe.rendezvous = true;
+        scheduler.Run(world, jobs, DT);
+        printf("Disjoint systems: Regen %s Age, Age %s Regen\n", probe.met[REGEN] ? "met" : "never saw",
+               probe.met[AGE] ? "met" : "never saw");
+        bool released = probe.met[REGEN] && probe.met[AGE];
+
+        // Known busy time per system, so the timings have something to be checked against
+        const uint64_t busyNs = 2000000;
+        ResetProbe(probe);
+        for (uint32_t i = 0; i < SYSTEM_COUNT; i++)
+            probe.spinNs[i] = busyNs;
+        scheduler.Run(world, jobs, DT);
+        printf("Timings:\n");
+        scheduler.PrintTimings();
+
+        uint32_t tooShort = 0;
+        for (uint32_t i = 0; i < SYSTEM_COUNT; i++)
+            tooShort += scheduler.GetLastTime(i) < busyNs;
+        printf("Timings: %u systems reported less than their %.1f ms of work (expected 0)\n", tooShort, busyNs / 1e6);
+
+        return wrongEdges == 0 && outOfOrder == 0 && differentSpawns == 0 && registrationOrder && released &&
+               tooShort == 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // The disjoint check needs a second thread to run on, even on one core
+    uint32_t hardware = std::thread::hardware_concurrency();
+    JobSystem jobs;
+    jobs.Start(std::max(hardware, 2u) - 1);
+
+    BenchRun(jobs);
+    bool passed = CheckSchedule(jobs);
+
+    jobs.Stop();
+    return passed ? 0 : 1;
+}
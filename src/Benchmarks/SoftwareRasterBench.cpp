@@ -0,0 +1,242 @@
+//
+// Frames of a 1080p scene through SoftwareRenderBackend at increasing
+// thread counts, or the ones given on the command line, and a check that
+// triangles sharing edges cover every pixel exactly once.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Core/JobSystem.h"
+#include "Engine/Math/Matrix4.h"
+#include "Engine/Math/Quaternion.h"
+#include "Engine/Render/SoftwareRenderBackend.h"
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t WIDTH = 1920;
+    const uint32_t HEIGHT = 1080;
+    const uint32_t CUBE_COUNT = 2000;
+    const uint32_t PARTICLE_COUNT = 3000;
+    const uint32_t GRID_SIZE = 64;
+    const int FRAMES = 5;
+    const int REPEATS = 3;
+
+    float NextFloat(uint32_t &seed) {
+        return (Benchmark::Random(seed) & 0xFFFF) / 65535.0f;
+    }
+
+    std::vector<RenderVertex> MakeCube() {
+        static const float corners[8][3] = {{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+                                            {-1, -1, 1},  {1, -1, 1},  {1, 1, 1},  {-1, 1, 1}};
+        static const int faces[6][4] = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4},
+                                        {2, 3, 7, 6}, {1, 2, 6, 5}, {0, 4, 7, 3}};
+        static const uint32_t colors[6] = {0xFF4040FF, 0xFF40FF40, 0xFFFF4040, 0xFF40FFFF, 0xFFFF40FF, 0xFFFFFF40};
+        static const float uvs[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+        static const int corner[6] = {0, 1, 2, 0, 2, 3};
+
+        std::vector<RenderVertex> vertices;
+        for (int face = 0; face < 6; face++) {
+            for (int i : corner) {
+                const float *position = corners[faces[face][i]];
+                vertices.push_back({position[0], position[1], position[2], uvs[i][0], uvs[i][1], colors[face]});
+            }
+        }
+        return vertices;
+    }
+
+    std::vector<RenderVertex> MakeQuad(uint32_t color) {
+        return {{-1, -1, 0, 0, 1, color}, {1, -1, 0, 1, 1, color}, {1, 1, 0, 1, 0, color},
+                {-1, -1, 0, 0, 1, color}, {1, 1, 0, 1, 0, color}, {-1, 1, 0, 0, 0, color}};
+    }
+
+    std::vector<uint32_t> MakeChecker(uint32_t size) {
+        std::vector<uint32_t> pixels(size * size);
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++)
+                pixels[y * size + x] = ((x / 8 + y / 8) & 1) ? 0xFFFFFFFF : 0xFF808080;
+        }
+        return pixels;
+    }
+
+    struct Scene {
+        uint32_t cube;
+        uint32_t particle;
+        uint32_t texture;
+        std::vector<Matrix4> cubes;
+        std::vector<Matrix4> particles;
+    };
+
+    /**
+     * Textured cubes in front of the camera, some cut by the near plane,
+     * with alpha-blended particles over them
+     */
+    Scene MakeScene(RenderBackend &backend) {
+        Scene scene;
+        std::vector<RenderVertex> cube = MakeCube();
+        std::vector<RenderVertex> particle = MakeQuad(0x80FFC080);
+        std::vector<uint32_t> checker = MakeChecker(64);
+        scene.cube = backend.CreateMesh(cube.data(), (uint32_t)cube.size());
+        scene.particle = backend.CreateMesh(particle.data(), (uint32_t)particle.size());
+        scene.texture = backend.CreateTexture(64, 64, checker.data());
+
+        Matrix4 projection = Matrix4::Perspective(1.0f, (float)WIDTH / HEIGHT, 0.5f, 200.0f);
+        uint32_t seed = 1;
+        for (uint32_t i = 0; i < CUBE_COUNT; i++) {
+            Vector3 position(NextFloat(seed) * 60.0f - 30.0f, NextFloat(seed) * 34.0f - 17.0f,
+                             -NextFloat(seed) * 60.0f);
+            Quaternion rotation =
+                Quaternion::FromAxisAngle(Vector3(0.6f, 0.8f, 0.0f), NextFloat(seed) * 6.28f);
+            scene.cubes.push_back(projection * Matrix4::TRS(position, rotation, Vector3(1.0f, 1.0f, 1.0f)));
+        }
+        for (uint32_t i = 0; i < PARTICLE_COUNT; i++) {
+            Vector3 position(NextFloat(seed) * 40.0f - 20.0f, NextFloat(seed) * 24.0f - 12.0f,
+                             -5.0f - NextFloat(seed) * 30.0f);
+            scene.particles.push_back(projection * Matrix4::TRS(position, Quaternion::IDENTITY,
+                                                                  Vector3(0.5f, 0.5f, 0.5f)));
+        }
+        return scene;
+    }
+
+    void DrawScene(RenderBackend &backend, const Scene &scene) {
+        backend.BeginFrame(Vector4(0.1f, 0.1f, 0.2f, 1.0f));
+
+        backend.SetMaterial(scene.texture);
+        backend.SetBlend(BlendMode::Opaque);
+        backend.SetDepth(true, true);
+        backend.SetMesh(scene.cube);
+        for (const Matrix4 &transform : scene.cubes)
+            backend.Draw(transform, 0, 36);
+
+        backend.SetMaterial(0);
+        backend.SetBlend(BlendMode::Alpha);
+        backend.SetDepth(true, false);
+        backend.SetMesh(scene.particle);
+        for (const Matrix4 &transform : scene.particles)
+            backend.Draw(transform, 0, 6);
+
+        backend.EndFrame();
+    }
+
+    /**
+     * @return seconds per repeat of FRAMES frames
+     */
+    double BenchFrames(uint32_t threads) {
+        JobSystem jobs;
+        if (threads > 1)
+            jobs.Start(threads - 1);
+
+        SoftwareRenderBackend backend(WIDTH, HEIGHT, threads > 1 ? &jobs : nullptr);
+        Scene scene = MakeScene(backend);
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            for (int frame = 0; frame < FRAMES; frame++)
+                DrawScene(backend, scene);
+        });
+
+        char label[64];
+        snprintf(label, sizeof(label), "1080p frames, %u threads", threads);
+        Benchmark::Report(label, seconds, FRAMES);
+
+        const SoftwareRenderStats &stats = backend.GetStats();
+        printf("  %.2f ms per frame, %u of %u triangles visible, %u binned to tiles\n", seconds * 1000.0 / FRAMES,
+               stats.visible, stats.triangles, stats.binned);
+        jobs.Stop();
+        return seconds;
+    }
+
+    /**
+     * Half-transparent white over black, through a grid of triangles with
+     * jittered shared corners: a pixel drawn twice or missed stands out
+     * @param jobs splits setup and tiles across threads, or nullptr to draw on this one
+     * @return false if any pixel isn't the blend drawn exactly once
+     */
+    bool CheckSharedEdges(JobSystem *jobs) {
+        SoftwareRenderBackend backend(WIDTH, HEIGHT, jobs);
+
+        uint32_t seed = 99;
+        std::vector<float> corners((GRID_SIZE + 1) * (GRID_SIZE + 1) * 2);
+        for (uint32_t y = 0; y <= GRID_SIZE; y++) {
+            for (uint32_t x = 0; x <= GRID_SIZE; x++) {
+                bool border = x == 0 || y == 0 || x == GRID_SIZE || y == GRID_SIZE;
+                float jitter = border ? 0.0f : 0.8f / GRID_SIZE;
+                float *corner = &corners[(y * (GRID_SIZE + 1) + x) * 2];
+                corner[0] = -1.0f + 2.0f * x / GRID_SIZE + (NextFloat(seed) - 0.5f) * jitter;
+                corner[1] = -1.0f + 2.0f * y / GRID_SIZE + (NextFloat(seed) - 0.5f) * jitter;
+            }
+        }
+
+        std::vector<RenderVertex> vertices;
+        auto add = [&](uint32_t x, uint32_t y) {
+            const float *corner = &corners[(y * (GRID_SIZE + 1) + x) * 2];
+            vertices.push_back({corner[0], corner[1], 0.0f, 0.0f, 0.0f, 0x80FFFFFF});
+        };
+        for (uint32_t y = 0; y < GRID_SIZE; y++) {
+            for (uint32_t x = 0; x < GRID_SIZE; x++) {
+                add(x, y);
+                add(x + 1, y);
+                add(x + 1, y + 1);
+                add(x, y);
+                add(x + 1, y + 1);
+                add(x, y + 1);
+            }
+        }
+
+        backend.SetMesh(backend.CreateMesh(vertices.data(), (uint32_t)vertices.size()));
+        backend.SetBlend(BlendMode::Alpha);
+        backend.SetDepth(false, false);
+        backend.BeginFrame(Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+        backend.Draw(Matrix4::IDENTITY, 0, (uint32_t)vertices.size());
+        backend.EndFrame();
+
+        // 0x80 white over opaque black, once
+        const uint32_t expected = 0xFF808080;
+        uint32_t wrong = 0;
+        for (uint32_t y = 0; y < HEIGHT; y++) {
+            for (uint32_t x = 0; x < WIDTH; x++)
+                wrong += backend.GetColorBuffer()[y * backend.GetStride() + x] != expected;
+        }
+        printf("Shared edges, %u threads: %u pixels drawn twice or missed (expected 0)\n",
+               jobs ? jobs->GetThreadCount() : 1, wrong);
+        return wrong == 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Thread counts to time, from the command line, or powers of two up to every hardware thread
+    uint32_t hardware = std::thread::hardware_concurrency();
+    std::vector<uint32_t> counts;
+    for (int i = 1; i < argc; i++) {
+        int threads = atoi(argv[i]);
+        if (threads > 0)
+            counts.push_back((uint32_t)threads);
+    }
+    if (counts.empty()) {
+        for (uint32_t threads = 1; threads <= (hardware > 1 ? hardware : 1); threads *= 2)
+            counts.push_back(threads);
+        if (hardware > 1 && (hardware & (hardware - 1)) != 0)
+            counts.push_back(hardware);
+    }
+
+    double single = 0.0;
+    for (uint32_t threads : counts) {
+        double seconds = BenchFrames(threads);
+        if (threads == 1)
+            single = seconds;
+        else if (single > 0.0)
+            printf("  %.2fx the 1-thread rate, on %u hardware threads\n", single / seconds, hardware);
+    }
+
+    bool passed = CheckSharedEdges(nullptr);
+
+    // At least one worker, so the parallel setup and tile paths run even on one core
+    JobSystem jobs;
+    jobs.Start(hardware > 2 ? hardware - 1 : 1);
+    passed &= CheckSharedEdges(&jobs);
+    jobs.Stop();
+    return passed ? 0 : 1;
+}
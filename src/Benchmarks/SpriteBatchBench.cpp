@@ -0,0 +1,153 @@
+//
+// Queueing, sorting, packing and vertex generation of a frame of sprites
+// through SpriteBatch into the null sprite backend, on one thread and on
+// every thread.
+//
+
+#include "Benchmark.h"
+
+#include "Engine/Core/JobSystem.h"
+#include "Engine/Render/NullSpriteBackend.h"
+#include "Engine/Render/SpriteBatch.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Engine;
+
+namespace {
+
+    const uint32_t SPRITE_COUNT = 50000;
+    const uint32_t LAYER_COUNT = 4;
+    const uint32_t SHADER_COUNT = 4;
+    const uint32_t TEXTURE_COUNT = 32;
+    const int REPEATS = 10;
+
+    struct QueuedSprite {
+        uint8_t layer;
+        uint32_t shader;
+        uint32_t texture;
+        BlendMode blend;
+        Sprite sprite;
+    };
+
+    /**
+     * A scene queued in the order game code walks it: every sprite with a
+     * random layer, atlas page and shader, a quarter of them rotated
+     */
+    std::vector<QueuedSprite> MakeScene() {
+        std::vector<QueuedSprite> scene(SPRITE_COUNT);
+        uint32_t seed = 12345;
+        for (QueuedSprite &queued : scene) {
+            queued.layer = (uint8_t)(Benchmark::Random(seed) % LAYER_COUNT);
+            queued.shader = 1 + Benchmark::Random(seed) % SHADER_COUNT;
+            queued.texture = 1 + Benchmark::Random(seed) % TEXTURE_COUNT;
+            queued.blend = queued.layer == 0 ? BlendMode::Opaque : BlendMode::Alpha;
+
+            Sprite &sprite = queued.sprite;
+            sprite.x = (float)(Benchmark::Random(seed) % 1920);
+            sprite.y = (float)(Benchmark::Random(seed) % 1080);
+            sprite.width = 16.0f + (float)(Benchmark::Random(seed) % 48);
+            sprite.height = 16.0f + (float)(Benchmark::Random(seed) % 48);
+            sprite.rotation = Benchmark::Random(seed) % 4 == 0 ? (float)(Benchmark::Random(seed) % 628) * 0.01f : 0.0f;
+            sprite.u0 = (float)(Benchmark::Random(seed) % 8) * 0.125f;
+            sprite.v0 = (float)(Benchmark::Random(seed) % 8) * 0.125f;
+            sprite.u1 = sprite.u0 + 0.125f;
+            sprite.v1 = sprite.v0 + 0.125f;
+            sprite.color = 0xFF000000 | Benchmark::Random(seed);
+        }
+        return scene;
+    }
+
+    void Queue(SpriteBatch &batch, const std::vector<QueuedSprite> &scene) {
+        batch.Begin();
+        for (const QueuedSprite &queued : scene)
+            batch.Draw(queued.layer, queued.shader, queued.texture, queued.blend, queued.sprite);
+    }
+
+    /**
+     * Draws a renderer without batching would issue: one per state change in queue order
+     */
+    uint32_t CountUnbatchedDraws(const std::vector<QueuedSprite> &scene) {
+        uint32_t draws = 0;
+        for (size_t i = 0; i < scene.size(); i++) {
+            if (i == 0 || scene[i].shader != scene[i - 1].shader || scene[i].texture != scene[i - 1].texture ||
+                scene[i].blend != scene[i - 1].blend)
+                draws++;
+        }
+        return draws;
+    }
+
+    /**
+     * Compares the quads written against the scene sorted the documented
+     * way: by layer, shader, texture and blend mode, keeping queue order
+     * @return the quads that hold the wrong sprite
+     */
+    uint32_t CheckOrder(const std::vector<QueuedSprite> &scene, const NullSpriteBackend &backend) {
+        std::vector<uint32_t> order(scene.size());
+        for (uint32_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const QueuedSprite &x = scene[a], &y = scene[b];
+            if (x.layer != y.layer)
+                return x.layer < y.layer;
+            if (x.shader != y.shader)
+                return x.shader < y.shader;
+            if (x.texture != y.texture)
+                return x.texture < y.texture;
+            return x.blend < y.blend;
+        });
+
+        uint32_t wrong = 0;
+        for (size_t i = 0; i < order.size(); i++) {
+            const Sprite &sprite = scene[order[i]].sprite;
+            const RenderVertex *quad = backend.GetVertices() + i * 4;
+            if (quad[0].color != sprite.color || quad[3].color != sprite.color || quad[0].u != sprite.u0 ||
+                quad[0].v != sprite.v0)
+                wrong++;
+        }
+        return wrong;
+    }
+
+    /**
+     * @return false if the last frame came out in the wrong order
+     */
+    bool BenchEnd(SpriteBatch &batch, NullSpriteBackend &backend, const std::vector<QueuedSprite> &scene,
+                  JobSystem *jobs, const char *label) {
+        double seconds = Benchmark::Measure(REPEATS, [&] {
+            Queue(batch, scene);
+            batch.End(backend, jobs);
+            Benchmark::DoNotOptimize(backend.GetVertices()[0]);
+        });
+        Benchmark::Report(label, seconds, SPRITE_COUNT);
+
+        // Every sprite must reach the backend for the order to be checked at all
+        const SpriteBatchStats &stats = batch.GetStats();
+        uint32_t wrong = stats.sprites == SPRITE_COUNT && stats.dropped == 0 ? CheckOrder(scene, backend) : SPRITE_COUNT;
+        printf("  %u quads out of place (expected 0)\n", wrong);
+        return wrong == 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<QueuedSprite> scene = MakeScene();
+    SpriteBatch batch;
+    NullSpriteBackend backend(SPRITE_COUNT);
+
+    double seconds = Benchmark::Measure(REPEATS, [&] { Queue(batch, scene); });
+    Benchmark::Report("Queue, 50k sprites", seconds, SPRITE_COUNT);
+
+    bool passed = BenchEnd(batch, backend, scene, nullptr, "Queue and End, 1 thread, 50k sprites");
+
+    JobSystem jobs;
+    jobs.Start();
+    char label[64];
+    snprintf(label, sizeof(label), "Queue and End, %u threads, 50k sprites", jobs.GetThreadCount());
+    passed &= BenchEnd(batch, backend, scene, &jobs, label);
+    jobs.Stop();
+
+    const SpriteBatchStats &stats = batch.GetStats();
+    printf("  %u sprites in %u draws, against %u draws unbatched; %u dropped\n", stats.sprites, stats.draws,
+           CountUnbatchedDraws(scene), stats.dropped);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+//
+// Cost of scheduling, cancelling and firing 100k SDL timers at once.
+//
+
+#include "Benchmark.h"
+
+#include "ThirdParty/SDL/include/SDL.h"
+
+#include <atomic>
+#include <vector>
+
+namespace {
+
+    const int TIMER_COUNT = 100000;
+    const int REPEATS = 3;
+
+    // Spread long timers over a minute so they land on every level of the wheel
+    const Uint32 LONG_INTERVAL_MS = 60000;
+    const Uint32 SHORT_INTERVAL_MS = 100;
+
+    std::atomic<int> fired(0);
+    std::atomic<Uint32> maxLateMs(0);
+
+    Uint32 SDLCALL Never(Uint32 interval, void *param) {
+        return 0;
+    }
+
+    Uint32 SDLCALL Fire(Uint32 interval, void *param) {
+        Uint32 late = SDL_GetTicks() - (Uint32)(uintptr_t)param;
+        Uint32 seen = maxLateMs.load(std::memory_order_relaxed);
+        while (late > seen && !maxLateMs.compare_exchange_weak(seen, late))
+            ;
+        fired.fetch_add(1, std::memory_order_release);
+        return 0;
+    }
+
+    Uint32 NextInterval(Uint32 &seed, Uint32 range) {
+        return 1 + Benchmark::Random(seed) % range;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (SDL_Init(SDL_INIT_TIMER) < 0) {
+        printf("Failed to init SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    std::vector<SDL_TimerID> ids(TIMER_COUNT);
+
+    double addSeconds = 0.0, removeSeconds = 0.0;
+    for (int run = 0; run < REPEATS; run++) {
+        Uint32 seed = 1;
+
+        double start = Benchmark::NowSeconds();
+        for (int i = 0; i < TIMER_COUNT; i++)
+            ids[i] = SDL_AddTimer(NextInterval(seed, LONG_INTERVAL_MS), Never, nullptr);
+        double added = Benchmark::NowSeconds();
+        for (int i = 0; i < TIMER_COUNT; i++)
+            SDL_RemoveTimer(ids[i]);
+        double removed = Benchmark::NowSeconds();
+
+        if (run == 0 || added - start < addSeconds)
+            addSeconds = added - start;
+        if (run == 0 || removed - added < removeSeconds)
+            removeSeconds = removed - added;
+    }
+    Benchmark::Report("SDL_AddTimer, 100k pending", addSeconds, TIMER_COUNT);
+    Benchmark::Report("SDL_RemoveTimer, 100k pending", removeSeconds, TIMER_COUNT);
+
+    // Let the timer thread retire the cancelled timers before measuring firing
+    SDL_Delay(LONG_INTERVAL_MS / 1000);
+
+    Uint32 seed = 1;
+    fired.store(0);
+    double start = Benchmark::NowSeconds();
+    for (int i = 0; i < TIMER_COUNT; i++) {
+        Uint32 interval = NextInterval(seed, SHORT_INTERVAL_MS);
+        SDL_AddTimer(interval, Fire, (void *)(uintptr_t)(SDL_GetTicks() + interval));
+    }
+    while (fired.load(std::memory_order_acquire) < TIMER_COUNT)
+        SDL_Delay(1);
+    double seconds = Benchmark::NowSeconds() - start;
+
+    Benchmark::Report("Schedule and fire 100k timers", seconds, TIMER_COUNT);
+    printf("Latest timer fired %u ms after its deadline\n", maxLateMs.load());
+
+    SDL_Quit();
+    return 0;
+}
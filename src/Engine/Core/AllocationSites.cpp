@@ -0,0 +1,342 @@
+//
+// Sampled call-site statistics for heap allocations, reported on shutdown.
+//
+
+#include "AllocationSites.h"
+
+#include "Hash.h"
+
+#include "ThirdParty/rapidjson/filewritestream.h"
+#include "ThirdParty/rapidjson/writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define ENGINE_HAS_EXECINFO 1
+#include <cxxabi.h>
+#include <execinfo.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+// Keeps CaptureStack() a frame of its own, so the frames to skip don't depend on the optimizer
+#if defined(_MSC_VER)
+#define ENGINE_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__) || defined(__clang__)
+#define ENGINE_NOINLINE __attribute__((noinline))
+#else
+#define ENGINE_NOINLINE
+#endif
+
+namespace Engine {
+
+    namespace {
+
+        // CaptureStack(), Record() and Memory::Allocate(), which every sampled stack starts with
+        const int SKIPPED_FRAMES = 3;
+
+        struct Site {
+            uint32_t hash;
+            int depth;
+            void *frames[AllocationSites::MAX_DEPTH];
+            std::atomic<uint64_t> allocations;
+            std::atomic<uint64_t> bytes;
+            std::atomic<int64_t> liveCount;
+            std::atomic<int64_t> liveBytes;
+        };
+
+        /**
+         * Sites are only ever added, under the mutex, and never move, so
+         * their counters can be updated without it. Slot 0 collects the
+         * samples that arrive once the table is full.
+         */
+        struct SiteTable {
+            std::mutex mutex;
+            uint32_t count;
+            Site sites[AllocationSites::MAX_SITES];
+            uint32_t slots[AllocationSites::MAX_SITES * 2];
+        };
+
+        SiteTable s_table;
+
+        // Kept after sampling stops, to scale the counts in the reports
+        uint32_t s_reportRate = 0;
+
+        thread_local uint32_t t_countdown = 0;
+        thread_local uint32_t t_random = 0;
+
+        ENGINE_NOINLINE int CaptureStack(void **frames, int maxDepth) {
+#if defined(ENGINE_HAS_EXECINFO)
+            void *captured[AllocationSites::MAX_DEPTH + SKIPPED_FRAMES];
+            int depth = backtrace(captured, maxDepth + SKIPPED_FRAMES) - SKIPPED_FRAMES;
+            if (depth <= 0)
+                return 0;
+            std::memcpy(frames, captured + SKIPPED_FRAMES, depth * sizeof(void *));
+            return depth;
+#elif defined(_WIN32)
+            return CaptureStackBackTrace(SKIPPED_FRAMES, maxDepth, frames, nullptr);
+#else
+            (void)frames;
+            (void)maxDepth;
+            return 0;
+#endif
+        }
+
+        uint32_t FindOrAddSite(void **frames, int depth) {
+            uint32_t hash = HashBytes(frames, depth * sizeof(void *));
+            const uint32_t mask = AllocationSites::MAX_SITES * 2 - 1;
+
+            std::lock_guard<std::mutex> lock(s_table.mutex);
+            if (s_table.count == 0)
+                s_table.count = 1;
+
+            for (uint32_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                uint32_t index = s_table.slots[slot];
+                if (index == 0) {
+                    if (s_table.count == AllocationSites::MAX_SITES)
+                        return 0;
+
+                    index = s_table.count++;
+                    Site &site = s_table.sites[index];
+                    site.hash = hash;
+                    site.depth = depth;
+                    std::memcpy(site.frames, frames, depth * sizeof(void *));
+                    s_table.slots[slot] = index;
+                    return index;
+                }
+
+                const Site &site = s_table.sites[index];
+                if (site.hash == hash && site.depth == depth &&
+                    std::memcmp(site.frames, frames, depth * sizeof(void *)) == 0)
+                    return index;
+            }
+        }
+
+        /**
+         * Turns a return address into "function+offset (module)" where the platform allows
+         */
+        std::string Symbolize(void *address) {
+#if defined(ENGINE_HAS_EXECINFO)
+            char **symbols = backtrace_symbols(&address, 1);
+            if (!symbols)
+                return "?";
+
+            // glibc prints "module(mangled+0x1f) [0x...]"
+            std::string symbol = symbols[0];
+            std::free(symbols);
+
+            size_t open = symbol.find('(');
+            size_t plus = symbol.find('+', open);
+            if (open == std::string::npos || plus == std::string::npos || plus == open + 1)
+                return symbol;
+
+            // C functions aren't mangled and keep their name
+            std::string name = symbol.substr(open + 1, plus - open - 1);
+            int status = 0;
+            char *demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+            if (status == 0 && demangled)
+                name = demangled;
+            std::free(demangled);
+
+            size_t close = symbol.find(')', plus);
+            return name + symbol.substr(plus, close - plus) + " (" + symbol.substr(0, open) + ")";
+#else
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%p", address);
+            return buffer;
+#endif
+        }
+
+        /**
+         * Gets up to \c top used sites, largest \c key first
+         */
+        template<typename Key>
+        std::vector<uint32_t> GetTopSites(Key key, int top) {
+            uint32_t count;
+            {
+                std::lock_guard<std::mutex> lock(s_table.mutex);
+                count = s_table.count;
+            }
+
+            std::vector<uint32_t> order;
+            for (uint32_t i = 0; i < count; i++) {
+                if (key(s_table.sites[i]) > 0)
+                    order.push_back(i);
+            }
+
+            std::sort(order.begin(), order.end(),
+                      [&](uint32_t a, uint32_t b) { return key(s_table.sites[a]) > key(s_table.sites[b]); });
+            if (order.size() > (size_t)top)
+                order.resize(top);
+            return order;
+        }
+
+        int64_t GetLiveBytes(const Site &site) {
+            return site.liveBytes.load(std::memory_order_relaxed);
+        }
+
+        int64_t GetAllocations(const Site &site) {
+            return (int64_t)site.allocations.load(std::memory_order_relaxed);
+        }
+
+        void PrintStack(const Site &site) {
+            if (site.depth == 0) {
+                printf("    (no stack)\n");
+                return;
+            }
+            for (int i = 0; i < site.depth; i++)
+                printf("    %s\n", Symbolize(site.frames[i]).c_str());
+        }
+
+        void WriteSites(rapidjson::Writer<rapidjson::FileWriteStream> &writer, const std::vector<uint32_t> &sites,
+                        uint32_t rate, uint64_t frames) {
+            writer.StartArray();
+            for (uint32_t index : sites) {
+                const Site &site = s_table.sites[index];
+                uint64_t allocations = site.allocations.load(std::memory_order_relaxed) * rate;
+
+                writer.StartObject();
+                writer.Key("live_bytes");
+                writer.Int64(site.liveBytes.load(std::memory_order_relaxed) * rate);
+                writer.Key("live_count");
+                writer.Int64(site.liveCount.load(std::memory_order_relaxed) * rate);
+                writer.Key("allocations");
+                writer.Uint64(allocations);
+                writer.Key("bytes");
+                writer.Uint64(site.bytes.load(std::memory_order_relaxed) * rate);
+                writer.Key("allocations_per_frame");
+                writer.Double(frames > 0 ? (double)allocations / frames : 0.0);
+                writer.Key("stack");
+                writer.StartArray();
+                for (int i = 0; i < site.depth; i++)
+                    writer.String(Symbolize(site.frames[i]).c_str());
+                writer.EndArray();
+                writer.EndObject();
+            }
+            writer.EndArray();
+        }
+    }
+
+    void AllocationSites::Enable(uint32_t rate) {
+        s_reportRate = rate > 0 ? rate : 1;
+        s_sampleRate.store(s_reportRate, std::memory_order_relaxed);
+    }
+
+    void AllocationSites::Disable() {
+        s_sampleRate.store(0, std::memory_order_relaxed);
+    }
+
+    bool AllocationSites::CountDown() {
+        if (t_countdown > 1) {
+            t_countdown--;
+            return false;
+        }
+
+        // Jitter the interval around the rate so allocations that repeat
+        // with the same period as the sampler can't hide from it
+        uint32_t rate = s_sampleRate.load(std::memory_order_relaxed);
+        if (t_random == 0) {
+            // Seed from the thread's own address so threads don't sample in lockstep
+            const uint32_t *seed = &t_countdown;
+            t_random = HashBytes(&seed, sizeof(seed)) | 1;
+        }
+        t_random ^= t_random << 13;
+        t_random ^= t_random >> 17;
+        t_random ^= t_random << 5;
+        t_countdown = rate > 1 ? 1 + t_random % (2 * rate - 1) : 1;
+        return true;
+    }
+
+    uint32_t AllocationSites::Record(size_t size) {
+        void *frames[MAX_DEPTH];
+        int depth = CaptureStack(frames, MAX_DEPTH);
+
+        uint32_t index = FindOrAddSite(frames, depth);
+        Site &site = s_table.sites[index];
+        site.allocations.fetch_add(1, std::memory_order_relaxed);
+        site.bytes.fetch_add(size, std::memory_order_relaxed);
+        site.liveCount.fetch_add(1, std::memory_order_relaxed);
+        site.liveBytes.fetch_add((int64_t)size, std::memory_order_relaxed);
+        return index + 1;
+    }
+
+    void AllocationSites::Release(uint32_t site, size_t size) {
+        Site &entry = s_table.sites[site - 1];
+        entry.liveCount.fetch_sub(1, std::memory_order_relaxed);
+        entry.liveBytes.fetch_sub((int64_t)size, std::memory_order_relaxed);
+    }
+
+    void AllocationSites::Resize(uint32_t site, size_t oldSize, size_t newSize) {
+        Site &entry = s_table.sites[site - 1];
+        entry.liveBytes.fetch_add((int64_t)newSize - (int64_t)oldSize, std::memory_order_relaxed);
+        if (newSize > oldSize)
+            entry.bytes.fetch_add(newSize - oldSize, std::memory_order_relaxed);
+    }
+
+    void AllocationSites::PrintReport(uint64_t frames, int top) {
+        uint32_t rate = s_reportRate;
+        if (rate == 0)
+            return;
+        Disable();
+
+        printf("Allocation sites, sampled 1 in %u; counts are estimates\n", rate);
+
+        printf("Top %d sites still holding memory at shutdown:\n", top);
+        for (uint32_t index : GetTopSites(GetLiveBytes, top)) {
+            const Site &site = s_table.sites[index];
+            printf("  %lld bytes in %lld blocks\n", (long long)(site.liveBytes.load(std::memory_order_relaxed) * rate),
+                   (long long)(site.liveCount.load(std::memory_order_relaxed) * rate));
+            PrintStack(site);
+        }
+
+        printf("Top %d sites by allocation count:\n", top);
+        for (uint32_t index : GetTopSites(GetAllocations, top)) {
+            const Site &site = s_table.sites[index];
+            uint64_t allocations = site.allocations.load(std::memory_order_relaxed) * rate;
+            printf("  %llu allocations (%.1f per frame), %llu bytes\n", (unsigned long long)allocations,
+                   frames > 0 ? (double)allocations / frames : 0.0,
+                   (unsigned long long)(site.bytes.load(std::memory_order_relaxed) * rate));
+            PrintStack(site);
+        }
+
+        if (s_table.count == MAX_SITES)
+            printf("Site table full; later stacks are counted without a stack\n");
+    }
+
+    bool AllocationSites::WriteJson(const char *path, uint64_t frames, int top) {
+        uint32_t rate = s_reportRate;
+        if (rate == 0)
+            return false;
+        Disable();
+
+        std::FILE *file = std::fopen(path, "wb");
+        if (!file)
+            return false;
+
+        char buffer[4096];
+        rapidjson::FileWriteStream stream(file, buffer, sizeof(buffer));
+        rapidjson::Writer<rapidjson::FileWriteStream> writer(stream);
+
+        writer.StartObject();
+        writer.Key("sample_rate");
+        writer.Uint(rate);
+        writer.Key("frames");
+        writer.Uint64(frames);
+        writer.Key("leaks");
+        WriteSites(writer, GetTopSites(GetLiveBytes, top), rate, frames);
+        writer.Key("churn");
+        WriteSites(writer, GetTopSites(GetAllocations, top), rate, frames);
+        writer.EndObject();
+
+        stream.Flush();
+        std::fclose(file);
+        return true;
+    }
+
+}
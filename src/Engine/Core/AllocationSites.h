@@ -0,0 +1,86 @@
+//
+// Sampled call-site statistics for heap allocations, reported on shutdown.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine {
+
+    /**
+     * Records the call stack of one allocation in about every N made through
+     * Memory, and keeps live and total counts per distinct stack. On exit the
+     * sites still holding memory point at leaks, and the sites allocating the
+     * most point at per-frame heap churn.
+     *
+     * Sampling is off by default and costs one relaxed load per allocation
+     * until Enable() is called. Counts in the reports are scaled back up by
+     * the sample rate, so they are estimates.
+     */
+    class AllocationSites {
+    public:
+        static const int MAX_DEPTH = 16;
+        static const uint32_t MAX_SITES = 4096;
+
+        /**
+         * Starts sampling about one allocation in \c rate on every thread
+         * @param rate the mean number of allocations between samples, 1 to record all of them
+         */
+        static void Enable(uint32_t rate);
+
+        /**
+         * Stops sampling new allocations. Sampled blocks are still counted when freed.
+         */
+        static void Disable();
+
+        static bool IsSampling() { return s_sampleRate.load(std::memory_order_relaxed) != 0; }
+
+        /**
+         * Decides whether the calling thread's next allocation is sampled
+         */
+        static bool ShouldSample() {
+            if (s_sampleRate.load(std::memory_order_relaxed) == 0)
+                return false;
+            return CountDown();
+        }
+
+        /**
+         * Captures the calling stack and charges an allocation to its site
+         * @return the site id to keep with the block, never 0
+         */
+        static uint32_t Record(size_t size);
+
+        /**
+         * Removes a freed block from the live counts of its site
+         */
+        static void Release(uint32_t site, size_t size);
+
+        /**
+         * Updates the live bytes of a site when one of its blocks is resized in place
+         */
+        static void Resize(uint32_t site, size_t oldSize, size_t newSize);
+
+        /**
+         * Prints the sites with the most live bytes and the most allocations.
+         * Stops sampling first, so the report's own allocations aren't counted.
+         * @param frames the number of frames run, to give allocations per frame
+         * @param top the number of sites in each list
+         */
+        static void PrintReport(uint64_t frames, int top);
+
+        /**
+         * Writes the same lists as PrintReport() as JSON
+         * @return false if the file couldn't be opened
+         */
+        static bool WriteJson(const char *path, uint64_t frames, int top);
+
+    private:
+        static inline std::atomic<uint32_t> s_sampleRate{0};
+
+        static bool CountDown();
+    };
+
+}
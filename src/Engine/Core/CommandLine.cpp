@@ -0,0 +1,59 @@
+//
+// Parses "--name" and "--name=value" style command line options.
+//
+
+#include "CommandLine.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace Engine {
+
+    CommandLine::CommandLine(int argc, char *argv[]) {
+        for (int i = 1; i < argc; i++) {
+            const char *arg = argv[i];
+            if (std::strncmp(arg, "--", 2) != 0)
+                continue;
+
+            arg += 2;
+            const char *equals = std::strchr(arg, '=');
+
+            Option option;
+            if (equals) {
+                option.name.assign(arg, equals - arg);
+                option.value = equals + 1;
+            } else {
+                option.name = arg;
+            }
+            m_options.push_back(option);
+        }
+    }
+
+    const CommandLine::Option *CommandLine::Find(const char *name) const {
+        // Later options override earlier ones
+        for (auto it = m_options.rbegin(); it != m_options.rend(); ++it) {
+            if (it->name == name)
+                return &*it;
+        }
+        return nullptr;
+    }
+
+    bool CommandLine::Has(const char *name) const {
+        return Find(name) != nullptr;
+    }
+
+    std::string CommandLine::GetString(const char *name, const char *fallback) const {
+        const Option *option = Find(name);
+        return option ? option->value : std::string(fallback);
+    }
+
+    long CommandLine::GetInt(const char *name, long fallback) const {
+        const Option *option = Find(name);
+        if (!option || option->value.empty())
+            return fallback;
+
+        char *end = nullptr;
+        long value = std::strtol(option->value.c_str(), &end, 10);
+        return *end == '\0' ? value : fallback;
+    }
+}
@@ -0,0 +1,44 @@
+//
+// Parses "--name" and "--name=value" style command line options.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    class CommandLine {
+    private:
+        struct Option {
+            std::string name;
+            std::string value;
+        };
+
+        std::vector<Option> m_options;
+
+        const Option *Find(const char *name) const;
+
+    public:
+        CommandLine(int argc, char *argv[]);
+
+        /**
+         * Checks whether an option was passed, with or without a value
+         */
+        bool Has(const char *name) const;
+
+        /**
+         * Gets the value of an option
+         * @return the value, or \c fallback if the option was not passed
+         */
+        std::string GetString(const char *name, const char *fallback = "") const;
+
+        /**
+         * Gets the value of an option as an integer
+         * @return the value, or \c fallback if the option was not passed or is not a number
+         */
+        long GetInt(const char *name, long fallback = 0) const;
+    };
+
+}
@@ -0,0 +1,163 @@
+//
+// Runtime selection between scalar and SIMD variants of engine kernels.
+//
+
+#include "CpuDispatch.h"
+
+#include "ThirdParty/SDL/include/SDL_cpuinfo.h"
+#include "ThirdParty/SDL/include/SDL_stdinc.h"
+
+#include <cstdio>
+
+namespace Engine {
+
+    namespace {
+
+        const char *const ISA_NAMES[] = {"scalar", "sse2", "sse4.1", "avx2", "neon"};
+
+        // Position within the instruction set's family; 0 is shared by scalar code
+        int GetIsaRank(Isa isa) {
+            switch (isa) {
+                case Isa::SSE2: return 1;
+                case Isa::SSE41: return 2;
+                case Isa::AVX2: return 3;
+                case Isa::NEON: return 1;
+                default: return 0;
+            }
+        }
+
+        bool IsX86(Isa isa) {
+            return isa == Isa::SSE2 || isa == Isa::SSE41 || isa == Isa::AVX2;
+        }
+
+        bool forced = false;
+        Isa forcedIsa = Isa::Scalar;
+
+        KernelDispatchBase *dispatchers = nullptr;
+    }
+
+    const char *GetIsaName(Isa isa) {
+        return isa < Isa::Count ? ISA_NAMES[(int)isa] : "unknown";
+    }
+
+    bool ParseIsa(const char *name, Isa &isa) {
+        for (int i = 0; i < (int)Isa::Count; i++) {
+            if (SDL_strcasecmp(name, ISA_NAMES[i]) == 0) {
+                isa = (Isa)i;
+                return true;
+            }
+        }
+
+        // Accept the spelling SDL uses too
+        if (SDL_strcasecmp(name, "sse41") == 0) {
+            isa = Isa::SSE41;
+            return true;
+        }
+        return false;
+    }
+
+    bool CpuDispatch::IsSupported(Isa isa) {
+        switch (isa) {
+            case Isa::Scalar: return true;
+            case Isa::SSE2: return SDL_HasSSE2() == SDL_TRUE;
+            case Isa::SSE41: return SDL_HasSSE41() == SDL_TRUE;
+            case Isa::AVX2: return SDL_HasAVX2() == SDL_TRUE;
+            case Isa::NEON: return SDL_HasNEON() == SDL_TRUE;
+            default: return false;
+        }
+    }
+
+    bool CpuDispatch::IsAllowed(Isa isa) {
+        if (isa == Isa::Scalar)
+            return true;
+        if (!IsSupported(isa))
+            return false;
+        if (!forced)
+            return true;
+        return IsX86(isa) == IsX86(forcedIsa) && GetIsaRank(isa) <= GetIsaRank(forcedIsa);
+    }
+
+    void CpuDispatch::ForceIsa(Isa isa) {
+        if (!IsSupported(isa))
+            printf("Forced instruction set %s is not supported by this CPU; its kernels stay disabled\n",
+                   GetIsaName(isa));
+
+        forced = true;
+        forcedIsa = isa;
+        ResolveAll();
+    }
+
+    bool CpuDispatch::ForceIsa(const char *name) {
+        Isa isa;
+        if (!ParseIsa(name, isa))
+            return false;
+
+        ForceIsa(isa);
+        return true;
+    }
+
+    void CpuDispatch::ClearForcedIsa() {
+        forced = false;
+        ResolveAll();
+    }
+
+    int CpuDispatch::GetCacheLineSize() {
+        return SDL_GetCPUCacheLineSize();
+    }
+
+    void CpuDispatch::PrintSummary() {
+        printf("CPU:");
+        for (int i = 1; i < (int)Isa::Count; i++) {
+            if (IsSupported((Isa)i))
+                printf(" %s", ISA_NAMES[i]);
+        }
+        printf(", %d byte cache lines", GetCacheLineSize());
+        if (forced)
+            printf(", limited to %s", GetIsaName(forcedIsa));
+        printf("\n");
+
+        for (KernelDispatchBase *dispatch = dispatchers; dispatch; dispatch = dispatch->m_next)
+            printf("  %-24s %s\n", dispatch->GetName(), GetIsaName(dispatch->GetSelectedIsa()));
+    }
+
+    void CpuDispatch::Register(KernelDispatchBase *dispatch) {
+        dispatch->m_next = dispatchers;
+        dispatchers = dispatch;
+        dispatch->Resolve();
+    }
+
+    void CpuDispatch::ResolveAll() {
+        for (KernelDispatchBase *dispatch = dispatchers; dispatch; dispatch = dispatch->m_next)
+            dispatch->Resolve();
+    }
+
+    KernelDispatchBase::KernelDispatchBase(const char *name)
+        : m_selected(nullptr), m_name(name), m_variants(), m_selectedIsa(Isa::Scalar), m_next(nullptr) {
+    }
+
+    void KernelDispatchBase::AddVariant(Isa isa, const void *kernels) {
+        if (isa < Isa::Count && kernels)
+            m_variants[(int)isa] = kernels;
+    }
+
+    void KernelDispatchBase::Resolve() {
+        int best = -1;
+        for (int i = 0; i < MAX_VARIANTS; i++) {
+            if (!m_variants[i] || !CpuDispatch::IsAllowed((Isa)i))
+                continue;
+            if (best < 0 || GetIsaRank((Isa)i) > GetIsaRank((Isa)best))
+                best = i;
+        }
+
+        // Every dispatcher is expected to register a scalar variant
+        if (best < 0) {
+            printf("Kernel %s has no variant this CPU can run\n", m_name);
+            m_selected = nullptr;
+            return;
+        }
+
+        m_selectedIsa = (Isa)best;
+        m_selected = m_variants[best];
+    }
+
+}
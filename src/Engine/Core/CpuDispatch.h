@@ -0,0 +1,145 @@
+//
+// Runtime selection between scalar and SIMD variants of engine kernels.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+
+namespace Engine {
+
+    /**
+     * Instruction sets a kernel variant can be written for. The x86 sets are
+     * ordered so each one implies those before it.
+     */
+    enum class Isa {
+        Scalar,
+        SSE2,
+        SSE41,
+        AVX2,
+        NEON,
+        Count
+    };
+
+    const char *GetIsaName(Isa isa);
+
+    /**
+     * Parses an instruction set name as printed by GetIsaName, ignoring case
+     * @return false if the name is unknown
+     */
+    bool ParseIsa(const char *name, Isa &isa);
+
+    class KernelDispatchBase;
+
+    /**
+     * Detects CPU features once and keeps track of every kernel dispatcher,
+     * so the instruction set limit can be changed for all of them at once.
+     */
+    class CpuDispatch {
+    public:
+        /**
+         * Checks whether this CPU can run code for an instruction set
+         */
+        static bool IsSupported(Isa isa);
+
+        /**
+         * Checks whether a kernel variant may be picked: the CPU supports
+         * it and it is within the forced limit, if any
+         */
+        static bool IsAllowed(Isa isa);
+
+        /**
+         * Caps every dispatcher at an instruction set and its predecessors,
+         * then re-resolves the dispatchers created so far. Variants the CPU
+         * can't run stay excluded. Not thread safe; call at startup.
+         */
+        static void ForceIsa(Isa isa);
+
+        /**
+         * Same as above from a name, as given to --force-isa=
+         * @return false if the name is unknown, leaving the selection unchanged
+         */
+        static bool ForceIsa(const char *name);
+
+        /**
+         * Removes any forced limit
+         */
+        static void ClearForcedIsa();
+
+        static int GetCacheLineSize();
+
+        /**
+         * Prints the CPU features and the variant chosen by each dispatcher
+         */
+        static void PrintSummary();
+
+        static void Register(KernelDispatchBase *dispatch);
+
+    private:
+        static void ResolveAll();
+    };
+
+    /**
+     * Untyped part of KernelDispatch, so dispatchers of any kernel type can be listed together
+     */
+    class KernelDispatchBase {
+    public:
+        static const int MAX_VARIANTS = (int)Isa::Count;
+
+        const char *GetName() const { return m_name; }
+        Isa GetSelectedIsa() const { return m_selectedIsa; }
+
+        /**
+         * Picks the best allowed variant; the scalar variant is always allowed
+         */
+        void Resolve();
+
+    protected:
+        explicit KernelDispatchBase(const char *name);
+
+        void AddVariant(Isa isa, const void *kernels);
+
+        const void *m_selected;
+
+    private:
+        friend class CpuDispatch;
+
+        const char *m_name;
+        const void *m_variants[MAX_VARIANTS];
+        Isa m_selectedIsa;
+        KernelDispatchBase *m_next;
+    };
+
+    /**
+     * Holds one kernel table per instruction set and hands out the best one.
+     * Meant to live in a function-local static, so registration happens once:
+     *
+     *     static KernelDispatch<BlurKernels> dispatch("Blur", {
+     *         {Isa::AVX2, GetBlurKernelsAVX2()},
+     *         {Isa::Scalar, GetBlurKernelsScalar()},
+     *     });
+     *     return dispatch.Get();
+     */
+    template <typename Kernels>
+    class KernelDispatch : public KernelDispatchBase {
+    public:
+        struct Variant {
+            Isa isa;
+            const Kernels *kernels;
+        };
+
+        /**
+         * @param variants kernel tables by instruction set; null tables, from
+         *        variants this build can't compile, are skipped
+         */
+        KernelDispatch(const char *name, std::initializer_list<Variant> variants) : KernelDispatchBase(name) {
+            for (const Variant &variant : variants)
+                AddVariant(variant.isa, variant.kernels);
+            CpuDispatch::Register(this);
+        }
+
+        const Kernels &Get() const { return *static_cast<const Kernels *>(m_selected); }
+    };
+
+}
@@ -0,0 +1,72 @@
+//
+// Fixed-timestep clock driving the simulation phase of the main loop.
+//
+
+#include "FixedTimestep.h"
+
+#include "ThirdParty/SDL/include/SDL_timer.h"
+
+namespace Engine {
+
+    FixedTimestep::FixedTimestep(double stepSeconds, int maxSteps) {
+        m_frequency = SDL_GetPerformanceFrequency();
+        m_stepTicks = (Uint64)(stepSeconds * (double)m_frequency);
+        if (m_stepTicks == 0)
+            m_stepTicks = 1;
+
+        m_maxSteps = maxSteps > 0 ? maxSteps : 1;
+        m_droppedSteps = 0;
+        m_lockstep = false;
+        Reset();
+    }
+
+    void FixedTimestep::Reset() {
+        m_lastCounter = SDL_GetPerformanceCounter();
+        m_accumulator = 0;
+        m_frameTicks = 0;
+    }
+
+    void FixedTimestep::SetLockstep(bool lockstep) {
+        m_lockstep = lockstep;
+        m_accumulator = 0;
+    }
+
+    int FixedTimestep::Advance() {
+        Uint64 now = SDL_GetPerformanceCounter();
+        m_frameTicks = now - m_lastCounter;
+        m_lastCounter = now;
+
+        if (m_lockstep)
+            return 1;
+
+        m_accumulator += m_frameTicks;
+
+        Uint64 due = m_accumulator / m_stepTicks;
+        if (due > (Uint64)m_maxSteps) {
+            // Drop whatever we cannot catch up on, but keep the fractional
+            // part so the interpolation factor stays continuous
+            m_droppedSteps += (int)(due - m_maxSteps);
+            m_accumulator = m_accumulator % m_stepTicks + m_maxSteps * m_stepTicks;
+            due = m_maxSteps;
+        }
+
+        m_accumulator -= due * m_stepTicks;
+        return (int)due;
+    }
+
+    double FixedTimestep::GetStepSeconds() const {
+        return (double)m_stepTicks / (double)m_frequency;
+    }
+
+    float FixedTimestep::GetAlpha() const {
+        return (float)((double)m_accumulator / (double)m_stepTicks);
+    }
+
+    double FixedTimestep::GetFrameSeconds() const {
+        return (double)m_frameTicks / (double)m_frequency;
+    }
+
+    int FixedTimestep::GetDroppedSteps() const {
+        return m_droppedSteps;
+    }
+}
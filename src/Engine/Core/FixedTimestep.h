@@ -0,0 +1,81 @@
+//
+// Fixed-timestep clock driving the simulation phase of the main loop.
+//
+
+#pragma once
+
+#include "ThirdParty/SDL/include/SDL_stdinc.h"
+
+namespace Engine {
+
+    /**
+     * Accumulates wall-clock time measured with SDL's performance counter
+     * and hands it out in fixed-size simulation steps. Whatever is left in
+     * the accumulator after the steps is exposed as an interpolation factor
+     * so the render phase can blend between the last two simulated states.
+     */
+    class FixedTimestep {
+    private:
+        Uint64 m_frequency;
+        Uint64 m_lastCounter;
+        Uint64 m_stepTicks;
+        Uint64 m_accumulator;
+        Uint64 m_frameTicks;
+        int m_maxSteps;
+        int m_droppedSteps;
+        bool m_lockstep;
+
+    public:
+        /**
+         * @param stepSeconds duration of one simulation step
+         * @param maxSteps maximum number of steps run in a single frame. Time
+         * beyond that is dropped so a long hitch cannot snowball into ever
+         * longer catch-up frames.
+         */
+        FixedTimestep(double stepSeconds, int maxSteps);
+
+        /**
+         * Restarts the clock, discarding any accumulated time
+         */
+        void Reset();
+
+        /**
+         * In lockstep mode every frame runs exactly one step, whatever the
+         * elapsed time, and the interpolation factor is always 0. Frame time
+         * is still measured. Used by benchmarks that must do the same work
+         * on every machine.
+         */
+        void SetLockstep(bool lockstep);
+
+        /**
+         * Samples the performance counter and consumes the elapsed time
+         * @return the number of simulation steps to run this frame
+         */
+        int Advance();
+
+        /**
+         * Gets the duration of one simulation step
+         * @return the step duration in seconds
+         */
+        double GetStepSeconds() const;
+
+        /**
+         * Gets how far the clock is between the last simulated step and the next one
+         * @return the interpolation factor in [0, 1)
+         */
+        float GetAlpha() const;
+
+        /**
+         * Gets the wall-clock time measured by the last call to Advance()
+         * @return the frame duration in seconds
+         */
+        double GetFrameSeconds() const;
+
+        /**
+         * Gets the total number of steps that were dropped because a frame
+         * needed more than the maximum catch-up steps
+         */
+        int GetDroppedSteps() const;
+    };
+
+}
@@ -0,0 +1,102 @@
+//
+// Double-buffered bump allocator for memory that lives for one or two frames.
+//
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+namespace Engine {
+
+    namespace {
+
+        uintptr_t AlignUp(uintptr_t value, size_t alignment) {
+            return (value + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        }
+    }
+
+    FrameArena::FrameArena(size_t capacity)
+        : m_current(0), m_capacity(capacity), m_used(0), m_overflowBytes(0), m_lastFrameBytes(0), m_peakBytes(0),
+          m_overflowCount(0) {
+        for (Buffer &buffer : m_buffers) {
+            buffer.data = static_cast<unsigned char *>(std::malloc(capacity));
+            buffer.overflow = nullptr;
+        }
+    }
+
+    FrameArena::~FrameArena() {
+        for (Buffer &buffer : m_buffers) {
+            Release(buffer);
+            std::free(buffer.data);
+        }
+    }
+
+    void FrameArena::BeginFrame() {
+        m_lastFrameBytes = GetFrameBytes();
+        m_peakBytes = std::max(m_peakBytes, m_lastFrameBytes);
+
+        // The buffer we switch to was last used two frames ago
+        m_current ^= 1;
+        Release(m_buffers[m_current]);
+        m_used = 0;
+        m_overflowBytes = 0;
+    }
+
+    void *FrameArena::Allocate(size_t size, size_t alignment) {
+        Buffer &buffer = m_buffers[m_current];
+
+        if (buffer.data) {
+            uintptr_t base = (uintptr_t)buffer.data;
+            uintptr_t start = AlignUp(base + m_used, alignment);
+            if (start + size <= base + m_capacity) {
+                m_used = start + size - base;
+                return (void *)start;
+            }
+        }
+
+        // Too big for what's left; keep it on a list released with this buffer
+        size_t header = AlignUp(sizeof(Overflow), alignment);
+        Overflow *block = static_cast<Overflow *>(std::malloc(header + size + alignment));
+        if (!block)
+            throw std::bad_alloc();
+
+        block->next = buffer.overflow;
+        buffer.overflow = block;
+        m_overflowBytes += size;
+        m_overflowCount++;
+        return (void *)AlignUp((uintptr_t)block + header, alignment);
+    }
+
+    const char *FrameArena::Format(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        va_list measure;
+        va_copy(measure, args);
+        int length = std::vsnprintf(nullptr, 0, format, measure);
+        va_end(measure);
+
+        char *text = static_cast<char *>(Allocate(length > 0 ? (size_t)length + 1 : 1, 1));
+        if (length > 0)
+            std::vsnprintf(text, (size_t)length + 1, format, args);
+        else
+            text[0] = '\0';
+        va_end(args);
+        return text;
+    }
+
+    size_t FrameArena::GetPeakBytes() const {
+        return std::max(m_peakBytes, GetFrameBytes());
+    }
+
+    void FrameArena::Release(Buffer &buffer) {
+        while (buffer.overflow) {
+            Overflow *next = buffer.overflow->next;
+            std::free(buffer.overflow);
+            buffer.overflow = next;
+        }
+    }
+
+}
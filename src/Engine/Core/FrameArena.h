@@ -0,0 +1,145 @@
+//
+// Double-buffered bump allocator for memory that lives for one or two frames.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace Engine {
+
+    /**
+     * Hands out frame-transient memory with a pointer bump. There are two
+     * buffers: BeginFrame() switches to the other one and empties it, so
+     * memory allocated during a frame stays valid through the next frame
+     * and is reclaimed all at once after that. Nothing is ever freed
+     * individually and destructors are never run.
+     *
+     * Requests that don't fit fall back to the heap and are released with
+     * their buffer; the overflow counters show when the capacity is too
+     * small. Not thread safe: meant for the thread running the main loop.
+     */
+    class FrameArena {
+    public:
+        static const size_t DEFAULT_CAPACITY = 1 << 20;
+
+        /**
+         * @param capacity size of each of the two buffers, in bytes
+         */
+        explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+        ~FrameArena();
+
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        /**
+         * Starts a new frame, releasing everything allocated two frames ago
+         */
+        void BeginFrame();
+
+        /**
+         * Allocates uninitialized memory valid until the end of the next frame
+         * @param alignment a power of two
+         */
+        void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        /**
+         * Allocates an uninitialized array
+         */
+        template <typename T>
+        T *AllocateArray(size_t count) {
+            static_assert(std::is_trivially_destructible<T>::value, "Frame memory is never destroyed");
+            return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        /**
+         * Constructs an object in frame memory
+         */
+        template <typename T, typename... Args>
+        T *New(Args &&... args) {
+            static_assert(std::is_trivially_destructible<T>::value, "Frame memory is never destroyed");
+            return new (Allocate(sizeof(T), alignof(T))) T(static_cast<Args &&>(args)...);
+        }
+
+        /**
+         * Formats a string with printf-style arguments into frame memory
+         */
+        const char *Format(const char *format, ...);
+
+        size_t GetCapacity() const { return m_capacity; }
+
+        /**
+         * Gets the bytes used so far this frame, including heap overflow
+         */
+        size_t GetFrameBytes() const { return m_used + m_overflowBytes; }
+
+        /**
+         * Gets the bytes used by the previous frame
+         */
+        size_t GetLastFrameBytes() const { return m_lastFrameBytes; }
+
+        /**
+         * Gets the most bytes any single frame has used
+         */
+        size_t GetPeakBytes() const;
+
+        /**
+         * Gets how many allocations didn't fit and went to the heap, over the whole run
+         */
+        uint64_t GetOverflowCount() const { return m_overflowCount; }
+
+    private:
+        struct Overflow {
+            Overflow *next;
+        };
+
+        struct Buffer {
+            unsigned char *data;
+            Overflow *overflow;
+        };
+
+        void Release(Buffer &buffer);
+
+        Buffer m_buffers[2];
+        int m_current;
+        size_t m_capacity;
+        size_t m_used;
+        size_t m_overflowBytes;
+        size_t m_lastFrameBytes;
+        size_t m_peakBytes;
+        uint64_t m_overflowCount;
+    };
+
+    /**
+     * STL allocator drawing from a FrameArena. Deallocation does nothing, so
+     * containers using it must not outlive the next frame.
+     */
+    template <typename T>
+    class FrameAllocator {
+    public:
+        typedef T value_type;
+
+        explicit FrameAllocator(FrameArena &arena) : m_arena(&arena) {}
+
+        template <typename U>
+        FrameAllocator(const FrameAllocator<U> &other) : m_arena(other.GetArena()) {}
+
+        T *allocate(size_t count) { return static_cast<T *>(m_arena->Allocate(count * sizeof(T), alignof(T))); }
+        void deallocate(T *, size_t) {}
+
+        FrameArena *GetArena() const { return m_arena; }
+
+        template <typename U>
+        bool operator==(const FrameAllocator<U> &rhs) const { return m_arena == rhs.GetArena(); }
+
+        template <typename U>
+        bool operator!=(const FrameAllocator<U> &rhs) const { return m_arena != rhs.GetArena(); }
+
+    private:
+        FrameArena *m_arena;
+    };
+
+}
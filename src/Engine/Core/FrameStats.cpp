@@ -0,0 +1,215 @@
+//
+// Frame time statistics backed by a fixed-size log-linear histogram.
+//
+
+#include "FrameStats.h"
+
+#include "ThirdParty/rapidjson/filewritestream.h"
+#include "ThirdParty/rapidjson/writer.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Engine {
+
+    namespace {
+
+        int HighestBit(uint64_t value) {
+            int bit = 0;
+            while (value >>= 1)
+                bit++;
+            return bit;
+        }
+
+        double ToMs(uint64_t us) {
+            return (double)us / 1000.0;
+        }
+    }
+
+    FrameHistogram::FrameHistogram() {
+        Reset();
+    }
+
+    void FrameHistogram::Reset() {
+        std::memset(m_buckets, 0, sizeof(m_buckets));
+        m_count = 0;
+        m_max = 0;
+        m_sum = 0;
+    }
+
+    int FrameHistogram::GetBucketIndex(uint64_t value) {
+        if (value < (uint64_t)SUB_BUCKET_COUNT)
+            return (int)value;
+
+        // Keep the top SUB_BUCKET_BITS - 1 bits below the leading one
+        int shift = HighestBit(value) - (SUB_BUCKET_BITS - 1);
+        int sub = (int)(value >> shift);
+        return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + (sub - SUB_BUCKET_HALF);
+    }
+
+    uint64_t FrameHistogram::GetBucketUpperBound(int bucket) {
+        if (bucket < SUB_BUCKET_COUNT)
+            return (uint64_t)bucket;
+
+        int shift = (bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF + 1;
+        uint64_t sub = (uint64_t)((bucket - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF + SUB_BUCKET_HALF);
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void FrameHistogram::Record(uint64_t value) {
+        if (value > MAX_VALUE)
+            value = MAX_VALUE;
+
+        m_buckets[GetBucketIndex(value)]++;
+        m_count++;
+        m_sum += value;
+        if (value > m_max)
+            m_max = value;
+    }
+
+    uint64_t FrameHistogram::GetValueAtPercentile(double percentile) const {
+        if (m_count == 0)
+            return 0;
+
+        uint64_t target = (uint64_t)(percentile / 100.0 * (double)m_count + 0.5);
+        if (target < 1)
+            target = 1;
+        if (target > m_count)
+            target = m_count;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += m_buckets[i];
+            if (seen >= target) {
+                uint64_t value = GetBucketUpperBound(i);
+                return value < m_max ? value : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    double FrameHistogram::GetMean() const {
+        return m_count ? (double)m_sum / (double)m_count : 0.0;
+    }
+
+    FrameStats::FrameStats(double budgetMs) {
+        m_budgetUs = (uint64_t)(budgetMs * 1000.0);
+        m_overBudget = 0;
+        m_overDoubleBudget = 0;
+        m_windowOverBudget = 0;
+        m_windowOverDoubleBudget = 0;
+    }
+
+    void FrameStats::Record(double frameSeconds) {
+        uint64_t us = (uint64_t)(frameSeconds * 1000000.0);
+        m_total.Record(us);
+        m_window.Record(us);
+
+        if (us > m_budgetUs) {
+            m_overBudget++;
+            m_windowOverBudget++;
+        }
+        if (us > m_budgetUs * 2) {
+            m_overDoubleBudget++;
+            m_windowOverDoubleBudget++;
+        }
+    }
+
+    void FrameStats::ResetWindow() {
+        m_window.Reset();
+        m_windowOverBudget = 0;
+        m_windowOverDoubleBudget = 0;
+    }
+
+    FrameStatsSummary FrameStats::Summarize(const FrameHistogram &histogram,
+                                            uint64_t overBudget, uint64_t overDoubleBudget) const {
+        FrameStatsSummary summary;
+        summary.frames = histogram.GetCount();
+        summary.meanMs = histogram.GetMean() / 1000.0;
+        summary.p50Ms = ToMs(histogram.GetValueAtPercentile(50.0));
+        summary.p90Ms = ToMs(histogram.GetValueAtPercentile(90.0));
+        summary.p99Ms = ToMs(histogram.GetValueAtPercentile(99.0));
+        summary.p999Ms = ToMs(histogram.GetValueAtPercentile(99.9));
+        summary.maxMs = ToMs(histogram.GetMax());
+        summary.budgetMs = ToMs(m_budgetUs);
+        summary.overBudget = overBudget;
+        summary.overDoubleBudget = overDoubleBudget;
+        return summary;
+    }
+
+    FrameStatsSummary FrameStats::GetTotalSummary() const {
+        return Summarize(m_total, m_overBudget, m_overDoubleBudget);
+    }
+
+    FrameStatsSummary FrameStats::GetWindowSummary() const {
+        return Summarize(m_window, m_windowOverBudget, m_windowOverDoubleBudget);
+    }
+
+    bool FrameStats::WriteCsv(const char *path) const {
+        std::FILE *file = std::fopen(path, "w");
+        if (!file)
+            return false;
+
+        FrameStatsSummary s = GetTotalSummary();
+        fprintf(file, "frames,mean_ms,p50_ms,p90_ms,p99_ms,p99_9_ms,max_ms,budget_ms,over_budget,over_2x_budget\n");
+        fprintf(file, "%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu\n",
+                (unsigned long long)s.frames, s.meanMs, s.p50Ms, s.p90Ms, s.p99Ms, s.p999Ms, s.maxMs,
+                s.budgetMs, (unsigned long long)s.overBudget, (unsigned long long)s.overDoubleBudget);
+
+        std::fclose(file);
+        return true;
+    }
+
+    bool FrameStats::WriteJson(const char *path) const {
+        std::FILE *file = std::fopen(path, "wb");
+        if (!file)
+            return false;
+
+        char buffer[4096];
+        rapidjson::FileWriteStream stream(file, buffer, sizeof(buffer));
+        rapidjson::Writer<rapidjson::FileWriteStream> writer(stream);
+
+        FrameStatsSummary s = GetTotalSummary();
+        writer.StartObject();
+        writer.Key("frames");
+        writer.Uint64(s.frames);
+        writer.Key("mean_ms");
+        writer.Double(s.meanMs);
+        writer.Key("p50_ms");
+        writer.Double(s.p50Ms);
+        writer.Key("p90_ms");
+        writer.Double(s.p90Ms);
+        writer.Key("p99_ms");
+        writer.Double(s.p99Ms);
+        writer.Key("p99_9_ms");
+        writer.Double(s.p999Ms);
+        writer.Key("max_ms");
+        writer.Double(s.maxMs);
+        writer.Key("budget_ms");
+        writer.Double(s.budgetMs);
+        writer.Key("over_budget");
+        writer.Uint64(s.overBudget);
+        writer.Key("over_2x_budget");
+        writer.Uint64(s.overDoubleBudget);
+
+        // Non-empty buckets as [upper bound in us, count] pairs
+        writer.Key("histogram_us");
+        writer.StartArray();
+        for (int i = 0; i < FrameHistogram::BUCKET_COUNT; i++) {
+            uint64_t count = m_total.GetBucketCount(i);
+            if (count == 0)
+                continue;
+
+            writer.StartArray();
+            writer.Uint64(FrameHistogram::GetBucketUpperBound(i));
+            writer.Uint64(count);
+            writer.EndArray();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        stream.Flush();
+
+        std::fclose(file);
+        return true;
+    }
+}
@@ -0,0 +1,119 @@
+//
+// Frame time statistics backed by a fixed-size log-linear histogram.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace Engine {
+
+    /**
+     * HDR-style histogram of microsecond values. Values below 128us are
+     * stored exactly; above that every power of two is split into 64
+     * buckets, keeping the relative error under 1.6% up to ~268 seconds.
+     * All storage is inline, so recording never allocates.
+     */
+    class FrameHistogram {
+    public:
+        static const int SUB_BUCKET_BITS = 7;
+        static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+        static const int SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+        static const int MAGNITUDES = 21;
+        static const int BUCKET_COUNT = SUB_BUCKET_COUNT + MAGNITUDES * SUB_BUCKET_HALF;
+        static const uint64_t MAX_VALUE = (uint64_t(1) << (SUB_BUCKET_BITS + MAGNITUDES)) - 1;
+
+        FrameHistogram();
+
+        void Reset();
+
+        /**
+         * Adds a value, clamped to MAX_VALUE
+         */
+        void Record(uint64_t value);
+
+        /**
+         * Gets the smallest recorded value such that \c percentile percent
+         * of all values are less or equal to it
+         * @param percentile in [0, 100]
+         * @return the upper bound of the matching bucket, never above the maximum
+         */
+        uint64_t GetValueAtPercentile(double percentile) const;
+
+        uint64_t GetCount() const { return m_count; }
+        uint64_t GetMax() const { return m_max; }
+        double GetMean() const;
+
+        uint64_t GetBucketCount(int bucket) const { return m_buckets[bucket]; }
+
+        /**
+         * Gets the largest value that falls into a bucket
+         */
+        static uint64_t GetBucketUpperBound(int bucket);
+
+        static int GetBucketIndex(uint64_t value);
+
+    private:
+        uint64_t m_buckets[BUCKET_COUNT];
+        uint64_t m_count;
+        uint64_t m_max;
+        uint64_t m_sum;
+    };
+
+    struct FrameStatsSummary {
+        uint64_t frames;
+        double meanMs;
+        double p50Ms;
+        double p90Ms;
+        double p99Ms;
+        double p999Ms;
+        double maxMs;
+        double budgetMs;
+        uint64_t overBudget;
+        uint64_t overDoubleBudget;
+    };
+
+    /**
+     * Records the duration of every frame, both over the whole run and over
+     * a window the caller resets (e.g. once per second for on-screen stats)
+     */
+    class FrameStats {
+    public:
+        /**
+         * @param budgetMs the frame time target; longer frames are counted as over budget
+         */
+        explicit FrameStats(double budgetMs);
+
+        void Record(double frameSeconds);
+
+        void ResetWindow();
+
+        FrameStatsSummary GetTotalSummary() const;
+        FrameStatsSummary GetWindowSummary() const;
+
+        const FrameHistogram &GetTotal() const { return m_total; }
+
+        /**
+         * Writes the run summary as a CSV header and a single row
+         */
+        bool WriteCsv(const char *path) const;
+
+        /**
+         * Writes the run summary and the non-empty histogram buckets as JSON
+         */
+        bool WriteJson(const char *path) const;
+
+    private:
+        FrameStatsSummary Summarize(const FrameHistogram &histogram,
+                                    uint64_t overBudget, uint64_t overDoubleBudget) const;
+
+        FrameHistogram m_total;
+        FrameHistogram m_window;
+        uint64_t m_budgetUs;
+        uint64_t m_overBudget;
+        uint64_t m_overDoubleBudget;
+        uint64_t m_windowOverBudget;
+        uint64_t m_windowOverDoubleBudget;
+    };
+
+}
@@ -0,0 +1,28 @@
+//
+// Small non-cryptographic hashes.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine {
+
+    const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    const uint32_t FNV_PRIME = 16777619u;
+
+    /**
+     * Hashes a block of memory with 32-bit FNV-1a
+     * @param hash the hash of the data before this block, to hash several blocks in sequence
+     */
+    inline uint32_t HashBytes(const void *data, size_t size, uint32_t hash = FNV_OFFSET_BASIS) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+}
@@ -0,0 +1,354 @@
+//
+// Work-stealing job system with counters for dependencies between jobs.
+//
+
+#include "JobSystem.h"
+
+#include "Thread.h"
+
+#include <cstdio>
+
+namespace Engine {
+
+    namespace {
+
+        // Rounds of stealing attempts before a worker goes to sleep
+        const int SPIN_ROUNDS = 64;
+
+        thread_local void *t_worker = nullptr;
+    }
+
+    JobSystem::Deque::Deque() : m_top(0), m_bottom(0) {
+        for (uint32_t i = 0; i < DEQUE_CAPACITY; i++)
+            m_jobs[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    // Orderings follow Lê, Pop, Cohen and Zappa Nardelli, "Correct and
+    // Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013)
+
+    bool JobSystem::Deque::Push(Job *job) {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= (int64_t)DEQUE_CAPACITY)
+            return false;
+
+        m_jobs[bottom & (DEQUE_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job *JobSystem::Deque::Pop() {
+        int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job *job = m_jobs[bottom & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last job: race the thieves for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job *JobSystem::Deque::Steal() {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom)
+            return nullptr;
+
+        Job *job = m_jobs[top & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+    JobSystem::JobSystem() : m_sharedQueued(0), m_nextSharedJob(0), m_queued(0), m_sleeping(0), m_stopping(false) {
+    }
+
+    JobSystem::~JobSystem() {
+        Stop();
+    }
+
+    void JobSystem::Start(uint32_t workerCount, bool pinThreads) {
+        if (IsRunning())
+            return;
+
+        if (workerCount == 0)
+            workerCount = GetHardwareThreadCount() - 1;
+
+        m_stopping.store(false, std::memory_order_relaxed);
+        for (uint32_t i = 0; i <= workerCount; i++) {
+            Worker *worker = new Worker();
+            worker->system = this;
+            worker->index = i;
+            worker->nextVictim = i + 1;
+            worker->nextJob = 0;
+            m_workers.push_back(worker);
+        }
+
+        // The caller runs jobs itself while it waits
+        t_worker = m_workers[0];
+        if (pinThreads)
+            PinCurrentThread(0);
+
+        for (uint32_t i = 1; i <= workerCount; i++)
+            m_workers[i]->thread = std::thread(&JobSystem::WorkerMain, this, m_workers[i], pinThreads);
+    }
+
+    void JobSystem::Stop() {
+        if (!IsRunning())
+            return;
+
+        // Drain whatever is still queued, then let the workers go
+        Worker *self = GetCurrentWorker();
+        while (m_queued.load(std::memory_order_acquire) > 0) {
+            Job *job = FindJob(self);
+            if (job)
+                Execute(job);
+            else
+                std::this_thread::yield();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping.store(true, std::memory_order_seq_cst);
+        }
+        m_wake.notify_all();
+
+        for (size_t i = 1; i < m_workers.size(); i++)
+            m_workers[i]->thread.join();
+
+        if (t_worker == m_workers[0])
+            t_worker = nullptr;
+        for (Worker *worker : m_workers)
+            delete worker;
+        m_workers.clear();
+    }
+
+    int JobSystem::GetThreadIndex() const {
+        Worker *worker = GetCurrentWorker();
+        return worker ? (int)worker->index : -1;
+    }
+
+    JobSystem::Worker *JobSystem::GetCurrentWorker() const {
+        Worker *worker = static_cast<Worker *>(t_worker);
+        return worker && worker->system == this ? worker : nullptr;
+    }
+
+    Job *JobSystem::AllocateJob() {
+        Worker *worker = GetCurrentWorker();
+        Job *job;
+        if (worker) {
+            job = &worker->jobs[worker->nextJob++ & (JOB_RING_SIZE - 1)];
+        } else {
+            std::lock_guard<std::mutex> lock(m_sharedMutex);
+            job = &m_sharedJobs[m_nextSharedJob++ & (JOB_RING_SIZE - 1)];
+        }
+
+        // The ring wrapped onto a job still queued or running. Helping
+        // happens outside the lock, since the jobs run may submit too.
+        int misses = 0;
+        while (job->busy.exchange(true, std::memory_order_acquire)) {
+            Job *other = IsRunning() ? FindJob(worker) : nullptr;
+            if (other) {
+                Execute(other);
+                misses = 0;
+            } else if (++misses < SPIN_ROUNDS) {
+                CpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        return job;
+    }
+
+    // Counters take their lock only around reaching zero and adding
+    // waiters; every other change is a plain compare-and-swap
+
+    void JobSystem::Lock(JobCounter &counter) {
+        while (counter.m_locked.exchange(true, std::memory_order_acquire))
+            CpuRelax();
+    }
+
+    void JobSystem::Unlock(JobCounter &counter) {
+        counter.m_locked.store(false, std::memory_order_release);
+    }
+
+    void JobSystem::Retain(JobCounter &counter) {
+        int32_t pending = counter.m_pending.load(std::memory_order_relaxed);
+        while (pending > 0) {
+            if (counter.m_pending.compare_exchange_weak(pending, pending + 1, std::memory_order_acq_rel))
+                return;
+        }
+
+        Lock(counter);
+        counter.m_pending.fetch_add(1, std::memory_order_acq_rel);
+        Unlock(counter);
+    }
+
+    void JobSystem::Release(JobCounter &counter) {
+        int32_t pending = counter.m_pending.load(std::memory_order_relaxed);
+        while (pending > 1) {
+            if (counter.m_pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+                return;
+        }
+
+        Lock(counter);
+        Job *waiter = nullptr;
+        if (counter.m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            waiter = counter.m_waiters;
+            counter.m_waiters = nullptr;
+        }
+        Unlock(counter);
+
+        // The counter may be gone by now
+        while (waiter) {
+            Job *next = waiter->next;
+            Push(waiter);
+            waiter = next;
+        }
+    }
+
+    void JobSystem::Push(Job *job) {
+        if (!IsRunning()) {
+            Execute(job);
+            return;
+        }
+
+        Worker *worker = GetCurrentWorker();
+        m_queued.fetch_add(1, std::memory_order_seq_cst);
+        if (worker) {
+            if (!worker->deque.Push(job)) {
+                // Deque full: running the job here is the cheapest back-pressure
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                Execute(job);
+                return;
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(m_sharedMutex);
+            m_sharedQueue.push_back(job);
+            m_sharedQueued.fetch_add(1, std::memory_order_release);
+        }
+
+        if (m_sleeping.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_wake.notify_one();
+        }
+    }
+
+    void JobSystem::AddWaiter(JobCounter &counter, Job *job) {
+        Lock(counter);
+        bool ready = counter.m_pending.load(std::memory_order_acquire) == 0;
+        if (!ready) {
+            job->next = counter.m_waiters;
+            counter.m_waiters = job;
+        }
+        Unlock(counter);
+
+        if (ready)
+            Push(job);
+    }
+
+    Job *JobSystem::FindJob(Worker *worker) {
+        Job *job = nullptr;
+        if (worker)
+            job = worker->deque.Pop();
+
+        // Steal round-robin, starting after the last victim that had work
+        uint32_t count = (uint32_t)m_workers.size();
+        for (uint32_t i = 0; !job && i < count; i++) {
+            uint32_t victim = worker ? (worker->nextVictim + i) % count : i;
+            if (worker && victim == worker->index)
+                continue;
+            job = m_workers[victim]->deque.Steal();
+            if (job && worker)
+                worker->nextVictim = victim;
+        }
+
+        // Only take the lock when something was submitted from outside
+        if (!job && m_sharedQueued.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock(m_sharedMutex);
+            if (!m_sharedQueue.empty()) {
+                job = m_sharedQueue.front();
+                m_sharedQueue.pop_front();
+                m_sharedQueued.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (job)
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    void JobSystem::Execute(Job *job) {
+        JobCounter *counter = job->counter;
+        job->function(*job);
+        job->busy.store(false, std::memory_order_release);
+        if (counter)
+            Release(*counter);
+    }
+
+    void JobSystem::Wait(JobCounter &counter) {
+        Worker *worker = GetCurrentWorker();
+        int misses = 0;
+        while (!counter.IsDone()) {
+            Job *job = FindJob(worker);
+            if (job) {
+                Execute(job);
+                misses = 0;
+            } else if (++misses < SPIN_ROUNDS) {
+                CpuRelax();
+            } else {
+                // The jobs left are running elsewhere; give their threads the core
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::WorkerMain(Worker *worker, bool pin) {
+        t_worker = worker;
+
+        char name[32];
+        snprintf(name, sizeof(name), "Job worker %u", worker->index);
+        SetCurrentThreadName(name);
+        if (pin)
+            PinCurrentThread(worker->index);
+
+        for (;;) {
+            Job *job = nullptr;
+            for (int i = 0; !job && i < SPIN_ROUNDS; i++) {
+                job = FindJob(worker);
+                if (!job)
+                    CpuRelax();
+            }
+
+            if (job) {
+                Execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            m_wake.wait(lock, [this]() {
+                return m_queued.load(std::memory_order_seq_cst) > 0 || m_stopping.load(std::memory_order_relaxed);
+            });
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+
+            if (m_stopping.load(std::memory_order_relaxed) && m_queued.load(std::memory_order_acquire) == 0)
+                break;
+        }
+
+        t_worker = nullptr;
+    }
+
+}
@@ -0,0 +1,270 @@
+//
+// Work-stealing job system with counters for dependencies between jobs.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Thread.h"
+
+namespace Engine {
+
+    class JobCounter;
+
+    /**
+     * A unit of work. The callable is stored inline, so submitting a job never allocates.
+     */
+    struct Job {
+        static const size_t STORAGE_SIZE = 48;
+
+        void (*function)(Job &job);
+        JobCounter *counter;
+        Job *next;
+
+        // Set from allocation until the callable has run, so a ring that wraps never reuses a live job
+        std::atomic<bool> busy{false};
+
+        alignas(std::max_align_t) unsigned char storage[STORAGE_SIZE];
+    };
+
+    /**
+     * Counts the unfinished jobs submitted against it. Other jobs can wait
+     * for it to reach zero, which is how "B runs after A" is expressed.
+     *
+     * A counter can be reused once it has reached zero, but jobs must be
+     * submitted against it before anything starts waiting on it, or the
+     * waiters run straight away.
+     */
+    class JobCounter {
+    public:
+        JobCounter() : m_pending(0), m_locked(false), m_waiters(nullptr) {}
+
+        JobCounter(const JobCounter &) = delete;
+        JobCounter &operator=(const JobCounter &) = delete;
+
+        /**
+         * Once this returns true the counter is no longer touched by the
+         * job system and may be destroyed
+         */
+        bool IsDone() const {
+            return m_pending.load(std::memory_order_acquire) == 0 && !m_locked.load(std::memory_order_acquire);
+        }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<int32_t> m_pending;
+
+        // Guards reaching zero against waiters being added
+        std::atomic<bool> m_locked;
+        Job *m_waiters;
+    };
+
+    /**
+     * Runs jobs on one worker thread per hardware thread, plus the thread
+     * that calls Start(), which joins in whenever it waits on a counter.
+     *
+     * Each thread owns a Chase-Lev deque: it pushes and pops its own jobs
+     * at the bottom, newest first, and idle threads steal the oldest from
+     * the top of the others. Threads outside the system submit through a
+     * shared locked queue. Workers spin briefly before sleeping when there
+     * is nothing to run.
+     *
+     * Jobs come from a ring on the submitting thread, or one ring shared
+     * by every outside thread. When a ring wraps around onto a job that
+     * hasn't run yet, the submitter runs other jobs until the slot frees.
+     */
+    class JobSystem {
+    public:
+        static const uint32_t DEQUE_CAPACITY = 4096;
+        static const uint32_t JOB_RING_SIZE = 4096;
+
+        JobSystem();
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        /**
+         * Starts the worker threads. The calling thread becomes thread 0.
+         * @param workerCount number of threads besides the caller, or 0 for one per remaining hardware thread
+         * @param pinThreads pin thread i to logical CPU i
+         */
+        void Start(uint32_t workerCount = 0, bool pinThreads = false);
+
+        /**
+         * Finishes every queued job and joins the workers
+         */
+        void Stop();
+
+        bool IsRunning() const { return !m_workers.empty(); }
+
+        /**
+         * Gets the number of threads running jobs, including the one that called Start()
+         */
+        uint32_t GetThreadCount() const { return (uint32_t)m_workers.size(); }
+
+        /**
+         * Gets the index of the calling thread, or -1 if it isn't part of the system
+         */
+        int GetThreadIndex() const;
+
+        /**
+         * Queues a callable taking no arguments
+         * @param counter incremented now and decremented when the job finishes
+         */
+        template <typename Fn>
+        void Submit(Fn &&fn, JobCounter *counter = nullptr) {
+            Job *job = MakeJob(static_cast<Fn &&>(fn), counter);
+            Push(job);
+        }
+
+        /**
+         * Queues a callable once \c dependency reaches zero. \c counter
+         * counts the job from now on, so waiting on it also waits for the dependency.
+         */
+        template <typename Fn>
+        void SubmitAfter(JobCounter &dependency, Fn &&fn, JobCounter *counter = nullptr) {
+            Job *job = MakeJob(static_cast<Fn &&>(fn), counter);
+            AddWaiter(dependency, job);
+        }
+
+        /**
+         * Runs other jobs on the calling thread until \c counter reaches zero
+         */
+        void Wait(JobCounter &counter);
+
+        /**
+         * Calls fn(begin, end) over [0, count) in chunks spread across every
+         * thread, and returns once all of them are done.
+         * @param minChunk smallest range worth a job of its own
+         */
+        template <typename Fn>
+        void ParallelFor(size_t count, Fn &&fn, size_t minChunk = 64);
+
+    private:
+        class Deque {
+        public:
+            Deque();
+
+            /**
+             * Owner only
+             * @return false when full
+             */
+            bool Push(Job *job);
+
+            /**
+             * Owner only; takes the newest job
+             */
+            Job *Pop();
+
+            /**
+             * Any thread; takes the oldest job
+             */
+            Job *Steal();
+
+        private:
+            alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_top;
+            alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_bottom;
+            alignas(CACHE_LINE_SIZE) std::atomic<Job *> m_jobs[DEQUE_CAPACITY];
+        };
+
+        struct Worker {
+            JobSystem *system;
+            uint32_t index;
+            uint32_t nextVictim;
+            uint32_t nextJob;
+            Deque deque;
+            Job jobs[JOB_RING_SIZE];
+            std::thread thread;
+        };
+
+        std::vector<Worker *> m_workers;
+
+        // Jobs and ring for threads outside the system
+        std::mutex m_sharedMutex;
+        std::deque<Job *> m_sharedQueue;
+        std::atomic<int32_t> m_sharedQueued;
+        Job m_sharedJobs[JOB_RING_SIZE];
+        uint32_t m_nextSharedJob;
+
+        // Jobs queued but not yet started, to decide when workers may sleep
+        std::atomic<int32_t> m_queued;
+        std::atomic<int32_t> m_sleeping;
+        std::atomic<bool> m_stopping;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wake;
+
+        Job *AllocateJob();
+
+        template <typename Fn>
+        Job *MakeJob(Fn &&fn, JobCounter *counter) {
+            typedef typename std::decay<Fn>::type Callable;
+            static_assert(sizeof(Callable) <= Job::STORAGE_SIZE, "Capture less, or capture a pointer to the state");
+            static_assert(alignof(Callable) <= alignof(std::max_align_t), "Over-aligned job callable");
+
+            Job *job = AllocateJob();
+            new (job->storage) Callable(static_cast<Fn &&>(fn));
+            job->function = [](Job &self) {
+                Callable *callable = reinterpret_cast<Callable *>(self.storage);
+                (*callable)();
+                callable->~Callable();
+            };
+            job->counter = counter;
+            job->next = nullptr;
+            if (counter)
+                Retain(*counter);
+            return job;
+        }
+
+        Worker *GetCurrentWorker() const;
+        void Lock(JobCounter &counter);
+        void Unlock(JobCounter &counter);
+        void Retain(JobCounter &counter);
+        void Release(JobCounter &counter);
+        void Push(Job *job);
+        void AddWaiter(JobCounter &counter, Job *job);
+        Job *FindJob(Worker *worker);
+        void Execute(Job *job);
+        void WorkerMain(Worker *worker, bool pin);
+    };
+
+    template <typename Fn>
+    void JobSystem::ParallelFor(size_t count, Fn &&fn, size_t minChunk) {
+        if (count == 0)
+            return;
+
+        // A few chunks per thread lets stealing even out uneven chunks
+        size_t threads = m_workers.empty() ? 1 : m_workers.size();
+        size_t chunk = (count + threads * 4 - 1) / (threads * 4);
+        if (chunk < minChunk)
+            chunk = minChunk;
+
+        if (chunk >= count || m_workers.empty()) {
+            fn((size_t)0, count);
+            return;
+        }
+
+        JobCounter counter;
+        auto *body = &fn;
+        for (size_t begin = chunk; begin < count; begin += chunk) {
+            size_t end = begin + chunk < count ? begin + chunk : count;
+            Submit([body, begin, end]() { (*body)(begin, end); }, &counter);
+        }
+
+        // The first chunk runs here rather than waiting for a thief
+        fn((size_t)0, chunk);
+        Wait(counter);
+    }
+
+}
@@ -5,7 +5,24 @@
 #include <vector>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
 #include "Vector2.h"
+#include "FixedTimestep.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "Thread.h"
+#include "TripleBuffer.h"
+#include "CommandLine.h"
+#include "CpuDispatch.h"
+#include "FrameStats.h"
+#include "Memory.h"
+#include "AllocationSites.h"
+#include "Hash.h"
+#include "InputRecording.h"
+#include "EventDispatcher.h"
+#include "GLStateCache.h"
+#include "SoftwareRenderBackend.h"
 
 // OpenGL / glew Headers
 #define GL3_PROTOTYPES 1
@@ -19,8 +36,9 @@
 #include "ThirdParty/rapidjson/document.h"
 #include "ThirdParty/rapidjson/filereadstream.h"
 
-// Stopwatch
-#include <Stopwatch.h>
+// Profiler
+#include "Profiler.h"
+#include "TraceExporter.h"
 
 // Our SDL_Window ( just like with SDL2 wihout OpenGL)
 SDL_Window *mainWindow;
@@ -28,6 +46,36 @@ SDL_Window *mainWindow;
 // Our opengl context handle
 SDL_GLContext mainContext;
 
+// Set by --headless: the dummy video driver and a software framebuffer
+// stand in for the display and OpenGL
+bool headless = false;
+
+// Writes profiler captures requested with F9 or --trace-capture
+Engine::TraceExporter traceExporter;
+
+// Number of frames captured when pressing F9
+const uint32_t TRACE_HOTKEY_FRAMES = 300;
+
+// Input recording and playback, set up with --record and --replay
+Engine::InputRecorder inputRecorder;
+Engine::InputReplayer inputReplayer;
+
+// Drains SDL's event queue in batches and routes events to the handlers below
+Engine::EventDispatcher eventDispatcher;
+
+// Scratch memory for the current and previous frame, emptied as each frame starts
+Engine::FrameArena frameArena;
+
+// Worker threads; the main thread runs jobs too while it waits on them
+Engine::JobSystem jobSystem;
+
+// Shadow of the GL state, so repeated state calls never reach the driver.
+// Used by whichever thread has the context current.
+Engine::GLStateCache glState;
+
+// Draws headless frames on the CPU into the dummy driver's window surface
+Engine::SoftwareRenderBackend *softwareRenderer = nullptr;
+
 bool SetOpenGLAttributes();
 void PrintSDL_GL_Attributes();
 
@@ -36,11 +84,18 @@ void PrintSDL_GL_Attributes();
  *  it using \c SDL_Log()
  * */
 void CheckSDLError(int line);
-void RunGame();
+void RunGame(const Engine::CommandLine &args);
 void Cleanup();
 
 bool Init(const char *wndName)
 {
+    // Window, GL context and driver state are charged to video
+    Engine::MemoryTagScope memoryTag(Engine::MemoryTag::Video);
+
+    // The dummy driver needs neither a display nor a GPU. SDL 2.0.8 only
+    // picks the driver up from the environment.
+    if (headless)
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
 
     // Initialize SDL's Video subsystem
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
@@ -49,11 +104,19 @@ bool Init(const char *wndName)
         return false;
     }
 
-    SetOpenGLAttributes();
+    if (headless)
+    {
+        mainWindow = SDL_CreateWindow(wndName, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                      800, 600, 0);
+    }
+    else
+    {
+        SetOpenGLAttributes();
 
-    // Create our window centered at 512x512 resolution
-    mainWindow = SDL_CreateWindow(wndName, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                  800, 600, SDL_WINDOW_OPENGL | SDL_WINDOW_FULLSCREEN_DESKTOP);
+        // Create our window centered at 512x512 resolution
+        mainWindow = SDL_CreateWindow(wndName, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                      800, 600, SDL_WINDOW_OPENGL | SDL_WINDOW_FULLSCREEN_DESKTOP);
+    }
 
     // Check that everything worked out okay
     if (!mainWindow)
@@ -63,6 +126,10 @@ bool Init(const char *wndName)
         return false;
     }
 
+    // Rendering goes through the window surface instead
+    if (headless)
+        return true;
+
     // Create our opengl context and attach it to our window
     mainContext = SDL_GL_CreateContext(mainWindow);
 
@@ -74,11 +141,15 @@ bool Init(const char *wndName)
     SDL_GL_SetSwapInterval(1);
 
     // Init GLEW
-    // Apparently, this is needed for Apple. Thanks to Ross Vander for letting me know
-#ifdef __APPLE__
+    // Core profiles need glewExperimental, or GLEW skips every entry point
+    // missing from the extension string. Thanks to Ross Vander for the Apple fix.
+    // Clearing and swapping don't need GLEW, so a failure is only reported.
     glewExperimental = GL_TRUE;
-    glewInit();
-#endif
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK)
+        std::cout << "Failed to init GLEW: " << glewGetErrorString(glewStatus) << std::endl;
+
+    glState.SetFunctions(Engine::LoadGLFunctions());
 
     return true;
 }
@@ -106,113 +177,553 @@ bool SetOpenGLAttributes()
 
 int main(int argc, char *argv[])
 {
+    // SDL can't switch allocators once it holds memory, so this goes first
+    Engine::Memory::Install();
+
+    Engine::CommandLine args(argc, argv);
+    headless = args.Has("headless");
+
+    // --alloc-sites[=N] records the call stack of one allocation in N and reports the worst sites on exit
+    if (args.Has("alloc-sites"))
+        Engine::AllocationSites::Enable((uint32_t)args.GetInt("alloc-sites", 64));
+
+    // Cap SIMD kernels at one instruction set, to exercise every path on one machine
+    if (args.Has("force-isa") && !Engine::CpuDispatch::ForceIsa(args.GetString("force-isa").c_str()))
+    {
+        printf("Unknown instruction set for --force-isa: %s\n", args.GetString("force-isa").c_str());
+        return -1;
+    }
+
     if (!Init("Game Window"))
         return -1;
 
+    // --gl-validate checks the GL state cache against glGet* on every call
+    glState.SetValidation(args.Has("gl-validate"));
 
-    // Clear our buffer with a black background
-    // This is the same as :
-    // 		SDL_SetRenderDrawColor(&renderer, 255, 0, 0, 255);
-    // 		SDL_RenderClear(&renderer);
-    //
-    glClearColor(0.7, 0.0, 0.0, 1.0);
-    glClear(GL_COLOR_BUFFER_BIT);
-    SDL_GL_SwapWindow(mainWindow);
+    // --job-threads=N overrides one worker per spare hardware thread, --pin-threads pins them to cores
+    jobSystem.Start((uint32_t)args.GetInt("job-threads", 0), args.Has("pin-threads"));
+    std::cout << "Job system: " << jobSystem.GetThreadCount() << " threads" << std::endl;
+
+    if (headless)
+    {
+        // Sized to the surface, which is what gets presented
+        SDL_Surface *surface = SDL_GetWindowSurface(mainWindow);
+        if (surface)
+        {
+            Engine::MemoryTagScope memoryTag(Engine::MemoryTag::Render);
+            softwareRenderer =
+                new Engine::SoftwareRenderBackend((uint32_t)surface->w, (uint32_t)surface->h, &jobSystem);
+            softwareRenderer->SetWindow(mainWindow);
+        }
+    }
+    else
+    {
+        // Clear our buffer with a black background
+        // This is the same as :
+        // 		SDL_SetRenderDrawColor(&renderer, 255, 0, 0, 255);
+        // 		SDL_RenderClear(&renderer);
+        //
+        glState.ClearColor(0.7, 0.0, 0.0, 1.0);
+        glState.Clear(GL_COLOR_BUFFER_BIT);
+        SDL_GL_SwapWindow(mainWindow);
+    }
 
-    RunGame();
+    RunGame(args);
+
+    if (args.Has("force-isa"))
+        Engine::CpuDispatch::PrintSummary();
 
     Cleanup();
 
+    // After SDL_Quit, so whatever is still live was never given back
+    if (args.Has("alloc-sites"))
+    {
+        Engine::AllocationSites::PrintReport(Engine::Memory::GetFrameCount(), 10);
+        Engine::AllocationSites::WriteJson(args.GetString("alloc-report", "alloc_sites.json").c_str(),
+                                           Engine::Memory::GetFrameCount(), 10);
+    }
+
     return 0;
 }
 
 
-void RunGame()
+// Simulation rate, independent of the display refresh rate
+const double SIMULATION_STEP = 1.0 / 60.0;
+
+// Maximum number of simulation steps run to catch up after a slow frame
+const int MAX_SIMULATION_STEPS = 5;
+
+// Frame time target; slower frames are counted as over budget
+const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+
+// Units per second the clear color moves towards its target
+const float COLOR_FADE_SPEED = 4.0f;
+
+struct Color
 {
-    bool fullscreen = true;
-    bool loop = true;
-    long millis = 0;
-    int frames = 0;
+    float r, g, b, a;
+};
 
+struct GameState
+{
+    bool fullscreen;
 
-    SDL_Event event;
-    while (loop)
-    {
-        STOPWATCH_START()
+    // The clear color fades towards the target instead of snapping to it,
+    // so the render phase has something to interpolate
+    Color target;
+    Color previous;
+    Color current;
+};
 
-        while (SDL_PollEvent(&event))
-        {
-            if (event.type == SDL_QUIT)
-                loop = false;
+/**
+ *  What the render thread needs to draw one frame, copied out of the game
+ *  state so the simulation can move on while the frame is drawn
+ * */
+struct RenderSnapshot
+{
+    Color previous;
+    Color current;
+    float alpha;
+};
+
+/**
+ *  Hashes the simulated state, to detect replays diverging from their recording
+ * */
+uint32_t ChecksumState(const GameState &state)
+{
+    uint32_t hash = Engine::HashBytes(&state.fullscreen, sizeof(state.fullscreen));
+    hash = Engine::HashBytes(&state.target, sizeof(state.target), hash);
+    hash = Engine::HashBytes(&state.previous, sizeof(state.previous), hash);
+    return Engine::HashBytes(&state.current, sizeof(state.current), hash);
+}
+
+/**
+ *  State the input handlers work on
+ * */
+struct InputContext
+{
+    GameState *state;
+    bool quit;
+};
+
+void OnQuit(const SDL_Event &event, void *userData)
+{
+    static_cast<InputContext *>(userData)->quit = true;
+}
 
-            if (event.type == SDL_KEYDOWN)
+void OnKeyDown(const SDL_Event &event, void *userData)
+{
+    InputContext &input = *static_cast<InputContext *>(userData);
+    GameState &state = *input.state;
+
+    switch (event.key.keysym.sym)
+    {
+        case SDLK_ESCAPE:
+            input.quit = true;
+            break;
+        case SDLK_r:
+            // Fade to red
+            state.target = {1.0f, 0.0f, 0.0f, 1.0f};
+            break;
+        case SDLK_g:
+            // Fade to green
+            state.target = {0.0f, 1.0f, 0.0f, 1.0f};
+            break;
+        case SDLK_b:
+            // Fade to blue
+            state.target = {0.0f, 0.0f, 1.0f, 1.0f};
+            break;
+        case SDLK_F7:
+            Engine::Profiler::SetEnabled(!Engine::Profiler::IsEnabled());
+            break;
+        case SDLK_F8:
+            Engine::Profiler::PrintLastFrame();
+            break;
+        case SDLK_F9:
+            if (!traceExporter.IsCapturing())
             {
-                switch (event.key.keysym.sym)
-                {
-                    case SDLK_ESCAPE:
-                        loop = false;
-                        break;
-                    case SDLK_r:
-                        // Cover with red and update
-                        glClearColor(1.0, 0.0, 0.0, 1.0);
-                        //glClear(GL_COLOR_BUFFER_BIT);
-                        break;
-                    case SDLK_g:
-                        // Cover with green and update
-                        glClearColor(0.0, 1.0, 0.0, 1.0);
-                        //glClear(GL_COLOR_BUFFER_BIT);
-                        break;
-                    case SDLK_b:
-                        // Cover with blue and update
-                        glClearColor(0.0, 0.0, 1.0, 1.0);
-                        //glClear(GL_COLOR_BUFFER_BIT);
-                        break;
-                    case SDLK_F11:
-                        fullscreen = !fullscreen;
-
-                        if (fullscreen)
-                            SDL_SetWindowFullscreen(mainWindow, SDL_WINDOW_FULLSCREEN_DESKTOP);
-                        else
-                            SDL_SetWindowFullscreen(mainWindow, 0);
-
-                        //glClear(GL_COLOR_BUFFER_BIT);
-                        break;
-                    default:
-                        break;
-                }
+                std::string path = "trace_" + std::to_string(SDL_GetTicks()) + ".json";
+                traceExporter.Start(path, TRACE_HOTKEY_FRAMES);
             }
+            break;
+        case SDLK_F11:
+            state.fullscreen = !state.fullscreen;
+
+            if (state.fullscreen)
+                SDL_SetWindowFullscreen(mainWindow, SDL_WINDOW_FULLSCREEN_DESKTOP);
+            else
+                SDL_SetWindowFullscreen(mainWindow, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+void RecordInput(const SDL_Event &event, void *userData)
+{
+    static_cast<Engine::InputRecorder *>(userData)->RecordEvent(event);
+}
+
+/**
+ *  Pumps SDL once and dispatches every queued event to the input handlers
+ *  @return false once the game has been asked to quit
+ * */
+bool ProcessEvents(InputContext &input, uint32_t frame)
+{
+    PROFILE_FUNCTION();
+    Engine::MemoryTagScope memoryTag(Engine::MemoryTag::Events);
+
+    eventDispatcher.Pump();
+
+    if (inputReplayer.IsOpen())
+    {
+        // Only the recording drives the game, but closing the window still
+        // ends the replay
+        if (SDL_HasEvent(SDL_QUIT))
+            input.quit = true;
+        SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+        if (!inputReplayer.BeginFrame(frame))
+            return false;
+    }
+
+    // Dispatch does not pump again, so a replayed frame only ever sees its
+    // recorded events
+    eventDispatcher.Dispatch();
+
+    return !input.quit;
+}
+
+float MoveTowards(float value, float target, float maxDelta)
+{
+    if (target - value > maxDelta)
+        return value + maxDelta;
+    if (value - target > maxDelta)
+        return value - maxDelta;
+    return target;
+}
+
+/**
+ *  Advances the simulation by one fixed step of \c dt seconds
+ * */
+void Update(GameState &state, float dt)
+{
+    PROFILE_FUNCTION();
+
+    state.previous = state.current;
+
+    float delta = COLOR_FADE_SPEED * dt;
+    state.current.r = MoveTowards(state.current.r, state.target.r, delta);
+    state.current.g = MoveTowards(state.current.g, state.target.g, delta);
+    state.current.b = MoveTowards(state.current.b, state.target.b, delta);
+    state.current.a = MoveTowards(state.current.a, state.target.a, delta);
+}
+
+// Shows this frame's heap traffic next to the zones in the profiler
+void PublishMemoryCounters()
+{
+    Engine::MemoryFrameStats frame = Engine::Memory::GetLastFrameStats();
+    PROFILE_COUNTER("Allocations per frame", frame.allocations);
+    PROFILE_COUNTER("Frees per frame", frame.frees);
+    PROFILE_COUNTER("Bytes allocated per frame", frame.bytes);
+    (void)frame;
+
+    int64_t liveBytes = 0;
+    for (int i = 0; i < (int)Engine::MemoryTag::Count; i++)
+        liveBytes += Engine::Memory::GetTagStats((Engine::MemoryTag)i).liveBytes;
+    PROFILE_COUNTER("Live bytes", liveBytes);
+    (void)liveBytes;
+}
+
+// Shows how many GL calls the state cache kept from the driver in the last drawn frame
+void PublishRenderCounters()
+{
+    Engine::GLStateStats gl = glState.GetLastFrameStats();
+    PROFILE_COUNTER("GL calls issued", gl.issued);
+    PROFILE_COUNTER("GL calls filtered", gl.filtered);
+    (void)gl;
+}
+
+/**
+ *  Runs \c steps fixed simulation steps of \c dt seconds
+ * */
+void Simulate(GameState &state, int steps, float dt)
+{
+    PROFILE_FUNCTION();
+
+    for (int i = 0; i < steps; i++)
+        Update(state, dt);
+}
+
+/**
+ *  Draws a snapshot, blending its two simulated states by its alpha
+ * */
+void Render(const RenderSnapshot &snapshot)
+{
+    PROFILE_FUNCTION();
+
+    const Color &a = snapshot.previous;
+    const Color &b = snapshot.current;
+    float alpha = snapshot.alpha;
+
+    Color color = {a.r + (b.r - a.r) * alpha,
+                   a.g + (b.g - a.g) * alpha,
+                   a.b + (b.b - a.b) * alpha,
+                   a.a + (b.a - a.a) * alpha};
+
+    if (headless)
+    {
+        // The software backend clears and presents the dummy driver's framebuffer instead
+        if (softwareRenderer)
+        {
+            softwareRenderer->BeginFrame(Engine::Vector4(color.r, color.g, color.b, color.a));
+            softwareRenderer->EndFrame();
         }
+        return;
+    }
+
+    glState.ClearColor(color.r, color.g, color.b, color.a);
+    glState.Clear(GL_COLOR_BUFFER_BIT);
 
-        glClear(GL_COLOR_BUFFER_BIT);
+    // Swap our back buffer to the front
+    // This is the same as :
+    // 		SDL_RenderPresent(&renderer);
+    {
+        PROFILE_SCOPE("SwapWindow");
         SDL_GL_SwapWindow(mainWindow);
-        SDL_Delay(1);
+    }
+
+    glState.EndFrame();
+}
+
+// Snapshots go from the main thread to the render thread through a triple
+// buffer. The mutex and condition variable only let either side sleep while
+// the other has nothing for it.
+Engine::TripleBuffer<RenderSnapshot> renderSnapshots;
+std::mutex renderMutex;
+std::condition_variable renderWake;
+bool renderStopping = false;
+std::thread renderThread;
+
+/**
+ *  Owns the GL context and draws each snapshot as it is published
+ * */
+void RenderThreadMain()
+{
+    Engine::SetCurrentThreadName("Render");
+    if (!headless)
+        SDL_GL_MakeCurrent(mainWindow, mainContext);
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(renderMutex);
+            renderWake.wait(lock, [] { return renderSnapshots.HasNew() || renderStopping; });
+
+            // Stopping still draws the last published frame
+            if (!renderSnapshots.Acquire())
+                break;
+        }
 
-        STOPWATCH_END()
-        //millis += elapsed.count();
-        millis += STOPWATCH_ELAPSED;
-        frames++;
+        // The main thread may publish the next frame while this one is drawn
+        renderWake.notify_all();
+        Render(renderSnapshots.GetFront());
+    }
+
+    if (!headless)
+        SDL_GL_MakeCurrent(mainWindow, nullptr);
+}
+
+void StartRenderThread()
+{
+    // A context is current on one thread at a time
+    if (!headless)
+        SDL_GL_MakeCurrent(mainWindow, nullptr);
+
+    renderStopping = false;
+    renderThread = std::thread(RenderThreadMain);
+}
+
+void StopRenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        renderStopping = true;
+    }
+    renderWake.notify_all();
+    renderThread.join();
+
+    if (!headless)
+        SDL_GL_MakeCurrent(mainWindow, mainContext);
+}
+
+/**
+ *  Blocks until the render thread has taken the last published snapshot,
+ *  so at most one frame waits behind the one being drawn
+ * */
+void WaitForRenderPickup()
+{
+    PROFILE_FUNCTION();
+
+    std::unique_lock<std::mutex> lock(renderMutex);
+    renderWake.wait(lock, [] { return !renderSnapshots.HasNew(); });
+}
+
+void PublishSnapshot()
+{
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        renderSnapshots.Publish();
+    }
+    renderWake.notify_all();
+}
+
+void RunGame(const Engine::CommandLine &args)
+{
+    GameState state;
+    state.fullscreen = true;
+    state.target = {0.7f, 0.0f, 0.0f, 1.0f};
+    state.previous = state.target;
+    state.current = state.target;
+
+    bool loop = true;
+    double millis = 0;
+
+    Engine::FrameStats frameStats(FRAME_BUDGET_MS);
+
+    PROFILE_THREAD_NAME("Main");
+
+    // --trace-capture=N records the first N frames, --trace-file picks where
+    long traceFrames = args.GetInt("trace-capture", 0);
+    if (traceFrames > 0)
+        traceExporter.Start(args.GetString("trace-file", "trace.json"), (uint32_t)traceFrames);
+
+    // --frames=N stops after N frames, 0 runs until quit
+    long maxFrames = args.GetInt("frames", 0);
+    long frameIndex = 0;
+
+    Engine::FixedTimestep timestep(SIMULATION_STEP, MAX_SIMULATION_STEPS);
+    float dt = (float)timestep.GetStepSeconds();
+
+    // Without vsync pacing the loop, headless runs simulate one step per
+    // frame so every machine does the same amount of work
+    timestep.SetLockstep(headless);
+
+    if (args.Has("record"))
+        inputRecorder.Open(args.GetString("record").c_str());
+    if (args.Has("replay"))
+        inputReplayer.Open(args.GetString("replay").c_str());
+
+    InputContext input = {&state, false};
+    eventDispatcher.SubscribeAll(RecordInput, &inputRecorder);
+    eventDispatcher.Subscribe(SDL_QUIT, OnQuit, &input);
+    eventDispatcher.Subscribe(SDL_KEYDOWN, OnKeyDown, &input);
+
+    // Frame N is drawn on the render thread while the main thread pumps
+    // events and simulates frame N + 1. --no-render-thread draws inline.
+    bool renderThreaded = !args.Has("no-render-thread");
+    RenderSnapshot inlineSnapshot;
+    if (renderThreaded)
+        StartRenderThread();
+
+    while (loop && (maxFrames <= 0 || frameIndex < maxFrames))
+    {
+        frameArena.BeginFrame();
+
+        loop = ProcessEvents(input, (uint32_t)frameIndex);
+
+        // Replays run exactly as many steps per frame as the recording did
+        int steps = timestep.Advance();
+        if (inputReplayer.IsOpen())
+            steps = inputReplayer.GetSteps();
+
+        // Input handlers only touch the state between simulation jobs
+        Engine::JobCounter simulation;
+        jobSystem.Submit([&state, steps, dt]() { Simulate(state, steps, dt); }, &simulation);
+        if (renderThreaded)
+            WaitForRenderPickup();
+        jobSystem.Wait(simulation);
+
+        uint32_t checksum = ChecksumState(state);
+        inputRecorder.EndFrame((uint32_t)frameIndex, steps, checksum);
+        if (inputReplayer.IsOpen() && loop)
+            inputReplayer.CheckFrame(checksum);
+
+        RenderSnapshot &snapshot = renderThreaded ? renderSnapshots.GetBack() : inlineSnapshot;
+        snapshot.previous = state.previous;
+        snapshot.current = state.current;
+        snapshot.alpha = timestep.GetAlpha();
+        if (renderThreaded)
+            PublishSnapshot();
+        else
+            Render(snapshot);
+        Engine::Memory::EndFrame();
+        PublishMemoryCounters();
+        if (!headless)
+            PublishRenderCounters();
+        PROFILE_END_FRAME();
+
+        millis += timestep.GetFrameSeconds() * 1000.0;
+        frameStats.Record(timestep.GetFrameSeconds());
+        frameIndex++;
 
         if (millis >= 1000)
         {
-            std::string title("My Game");
+            Engine::FrameStatsSummary window = frameStats.GetWindowSummary();
 
-            double msPerFrame = (double)millis/frames;
-            title += " " + std::to_string(msPerFrame) + "ms/frame  ";
-            title += "(" + std::to_string(frames) + "FPS)";
-            SDL_SetWindowTitle(mainWindow, title.c_str());
+            const char *title = frameArena.Format(
+                "My Game p50 %.3fms  p99 %.3fms  max %.3fms  (%llu FPS, %llu over budget)", window.p50Ms,
+                window.p99Ms, window.maxMs, (unsigned long long)window.frames,
+                (unsigned long long)window.overBudget);
+            SDL_SetWindowTitle(mainWindow, title);
 
             millis = 0;
-            frames = 0;
+            frameStats.ResetWindow();
         }
+    }
 
-        // Swap our back buffer to the front
-        // This is the same as :
-        // 		SDL_RenderPresent(&renderer);
+    if (renderThreaded)
+        StopRenderThread();
+
+    eventDispatcher.Unsubscribe(RecordInput, &inputRecorder);
+    eventDispatcher.Unsubscribe(OnQuit, &input);
+    eventDispatcher.Unsubscribe(OnKeyDown, &input);
+
+    inputRecorder.Close();
+    if (inputReplayer.IsOpen())
+    {
+        std::cout << "Replay finished, " << inputReplayer.GetDivergentFrames() << " divergent frames" << std::endl;
+        inputReplayer.Close();
     }
+
+    // --frame-stats=name picks the base name of the dumps
+    std::string statsPath = args.GetString("frame-stats", "frame_stats");
+    frameStats.WriteCsv((statsPath + ".csv").c_str());
+    frameStats.WriteJson((statsPath + ".json").c_str());
+
+    // Benchmark runs also write the results where the build machine expects them
+    if (headless)
+        frameStats.WriteJson(args.GetString("bench-output", "headless_bench.json").c_str());
+
+    Engine::FrameStatsSummary total = frameStats.GetTotalSummary();
+    std::cout << "Frames: " << total.frames << "  p50 " << total.p50Ms << "ms  p90 " << total.p90Ms
+              << "ms  p99 " << total.p99Ms << "ms  p99.9 " << total.p999Ms << "ms  max " << total.maxMs
+              << "ms  over budget " << total.overBudget << std::endl;
+    std::cout << "Frame arena: peak " << frameArena.GetPeakBytes() << " of " << frameArena.GetCapacity()
+              << " bytes, " << frameArena.GetOverflowCount() << " overflow allocations" << std::endl;
+    Engine::Memory::PrintSummary();
 }
 
 void Cleanup()
 {
+    delete softwareRenderer;
+    softwareRenderer = nullptr;
+
+    jobSystem.Stop();
+
+    // Finish writing any capture still in flight
+    traceExporter.Stop();
+
     // Delete our OpengL context
     SDL_GL_DeleteContext(mainContext);
 
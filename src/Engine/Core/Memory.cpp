@@ -0,0 +1,452 @@
+//
+// Tracked, tagged allocator shared by SDL and the engine.
+//
+
+#include "Memory.h"
+
+#include "AllocationSites.h"
+
+#include "ThirdParty/SDL/include/SDL_stdinc.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace Engine {
+
+    namespace {
+
+        const char *const TAG_NAMES[] = {"Engine", "SDL", "Video", "Events", "Audio", "Input", "Profiler", "Render", "ECS"};
+
+        // Payload sizes of the small-block classes; anything larger goes to malloc
+        const size_t CLASS_SIZES[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+        const int CLASS_COUNT = sizeof(CLASS_SIZES) / sizeof(CLASS_SIZES[0]);
+        const uint8_t LARGE_CLASS = 0xFF;
+
+        const size_t SLAB_SIZE = 64 * 1024;
+
+        // Blocks moved between a thread cache and the shared lists at a time
+        const uint32_t BATCH_SIZE = 32;
+
+        const uint16_t HEADER_MAGIC = 0xA11C;
+
+        struct Header {
+            uint64_t size;
+            uint8_t tag;
+            uint8_t sizeClass;
+            uint16_t magic;
+            // AllocationSites id when the block was sampled, 0 otherwise
+            uint32_t site;
+        };
+
+        static_assert(sizeof(Header) == 16, "Blocks must stay 16-byte aligned");
+
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        struct FreeList {
+            FreeBlock *head;
+            uint32_t count;
+        };
+
+        /**
+         * Blocks shared by all threads. Constant-initialized, so it works
+         * for allocations made before main().
+         */
+        struct SharedPool {
+            std::mutex mutex;
+            FreeList lists[CLASS_COUNT];
+        };
+
+        SharedPool s_shared;
+
+        struct TagCounters {
+            std::atomic<int64_t> liveBytes;
+            std::atomic<int64_t> liveCount;
+            std::atomic<uint64_t> allocations;
+            std::atomic<uint64_t> frees;
+        };
+
+        TagCounters s_tags[(int)MemoryTag::Count];
+
+        std::atomic<uint64_t> s_frameAllocations(0);
+        std::atomic<uint64_t> s_frameFrees(0);
+        std::atomic<uint64_t> s_frameBytes(0);
+        uint64_t s_frameCount = 0;
+        MemoryFrameStats s_lastFrame = {0, 0, 0};
+
+        int GetSizeClass(size_t size) {
+            for (int i = 0; i < CLASS_COUNT; i++) {
+                if (size <= CLASS_SIZES[i])
+                    return i;
+            }
+            return -1;
+        }
+
+        /**
+         * Carves a fresh slab into blocks of one class
+         * @return the number of blocks pushed onto \c list
+         */
+        uint32_t CarveSlab(FreeList &list, int sizeClass) {
+            size_t blockSize = sizeof(Header) + CLASS_SIZES[sizeClass];
+            unsigned char *slab = static_cast<unsigned char *>(std::malloc(SLAB_SIZE));
+            if (!slab)
+                return 0;
+
+            // Slabs are never returned; blocks cycle through the free lists instead
+            uint32_t count = (uint32_t)(SLAB_SIZE / blockSize);
+            for (uint32_t i = 0; i < count; i++) {
+                FreeBlock *block = reinterpret_cast<FreeBlock *>(slab + i * blockSize);
+                block->next = list.head;
+                list.head = block;
+            }
+            list.count += count;
+            return count;
+        }
+
+        /**
+         * Moves up to \c count blocks from \c from to \c to
+         */
+        void MoveBlocks(FreeList &from, FreeList &to, uint32_t count) {
+            while (count-- > 0 && from.head) {
+                FreeBlock *block = from.head;
+                from.head = block->next;
+                from.count--;
+                block->next = to.head;
+                to.head = block;
+                to.count++;
+            }
+        }
+
+        struct ThreadCache {
+            FreeList lists[CLASS_COUNT];
+
+            ~ThreadCache();
+        };
+
+        enum CacheState : uint8_t {
+            CACHE_UNUSED,
+            CACHE_ALIVE,
+            CACHE_DESTROYED
+        };
+
+        thread_local ThreadCache t_cache;
+        thread_local CacheState t_cacheState = CACHE_UNUSED;
+        thread_local MemoryTag t_tag = MemoryTag::Count;
+
+        ThreadCache::~ThreadCache() {
+            // Hand every cached block back, then send this thread's later frees to the shared lists
+            std::lock_guard<std::mutex> lock(s_shared.mutex);
+            for (int i = 0; i < CLASS_COUNT; i++)
+                MoveBlocks(lists[i], s_shared.lists[i], lists[i].count);
+            t_cacheState = CACHE_DESTROYED;
+        }
+
+        ThreadCache *GetThreadCache() {
+            if (t_cacheState == CACHE_ALIVE)
+                return &t_cache;
+            if (t_cacheState == CACHE_DESTROYED)
+                return nullptr;
+
+            t_cacheState = CACHE_ALIVE;
+            return &t_cache;
+        }
+
+        FreeBlock *PopSmall(int sizeClass) {
+            ThreadCache *cache = GetThreadCache();
+            if (cache) {
+                FreeList &list = cache->lists[sizeClass];
+                if (!list.head) {
+                    std::lock_guard<std::mutex> lock(s_shared.mutex);
+                    if (!s_shared.lists[sizeClass].head)
+                        CarveSlab(s_shared.lists[sizeClass], sizeClass);
+                    MoveBlocks(s_shared.lists[sizeClass], list, BATCH_SIZE);
+                }
+
+                FreeBlock *block = list.head;
+                if (block) {
+                    list.head = block->next;
+                    list.count--;
+                }
+                return block;
+            }
+
+            std::lock_guard<std::mutex> lock(s_shared.mutex);
+            FreeList &list = s_shared.lists[sizeClass];
+            if (!list.head)
+                CarveSlab(list, sizeClass);
+
+            FreeBlock *block = list.head;
+            if (block) {
+                list.head = block->next;
+                list.count--;
+            }
+            return block;
+        }
+
+        void PushSmall(FreeBlock *block, int sizeClass) {
+            ThreadCache *cache = GetThreadCache();
+            if (cache) {
+                FreeList &list = cache->lists[sizeClass];
+                block->next = list.head;
+                list.head = block;
+                list.count++;
+
+                // Threads that free more than they allocate give the surplus back
+                if (list.count >= BATCH_SIZE * 2) {
+                    std::lock_guard<std::mutex> lock(s_shared.mutex);
+                    MoveBlocks(list, s_shared.lists[sizeClass], BATCH_SIZE);
+                }
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(s_shared.mutex);
+            FreeList &list = s_shared.lists[sizeClass];
+            block->next = list.head;
+            list.head = block;
+            list.count++;
+        }
+
+        void Track(MemoryTag tag, size_t size) {
+            TagCounters &counters = s_tags[(int)tag];
+            counters.liveBytes.fetch_add((int64_t)size, std::memory_order_relaxed);
+            counters.liveCount.fetch_add(1, std::memory_order_relaxed);
+            counters.allocations.fetch_add(1, std::memory_order_relaxed);
+            s_frameAllocations.fetch_add(1, std::memory_order_relaxed);
+            s_frameBytes.fetch_add(size, std::memory_order_relaxed);
+        }
+
+        void Untrack(MemoryTag tag, size_t size) {
+            TagCounters &counters = s_tags[(int)tag];
+            counters.liveBytes.fetch_sub((int64_t)size, std::memory_order_relaxed);
+            counters.liveCount.fetch_sub(1, std::memory_order_relaxed);
+            counters.frees.fetch_add(1, std::memory_order_relaxed);
+            s_frameFrees.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Every block reaching Free() or Reallocate() came from Allocate():
+         * operator new is replaced at link time and SDL gets its functions
+         * before it allocates anything. The magic only catches breaking that,
+         * or a double free, and is never used to guess who owns a block.
+         */
+        Header *GetHeader(void *pointer, const char *caller) {
+            Header *header = reinterpret_cast<Header *>(static_cast<unsigned char *>(pointer) - sizeof(Header));
+            if (header->magic != HEADER_MAGIC) {
+                printf("Memory::%s got %p, which is not a live block of this allocator\n", caller, pointer);
+                std::abort();
+            }
+            return header;
+        }
+
+        void *SDLCALL SDLMalloc(size_t size) {
+            return Memory::Allocate(size, Memory::GetThreadTag(MemoryTag::SDL));
+        }
+
+        void *SDLCALL SDLCalloc(size_t count, size_t size) {
+            return Memory::AllocateZeroed(count, size, Memory::GetThreadTag(MemoryTag::SDL));
+        }
+
+        void *SDLCALL SDLRealloc(void *pointer, size_t size) {
+            return Memory::Reallocate(pointer, size, Memory::GetThreadTag(MemoryTag::SDL));
+        }
+
+        void SDLCALL SDLFree(void *pointer) {
+            Memory::Free(pointer);
+        }
+    }
+
+    const char *GetMemoryTagName(MemoryTag tag) {
+        return tag < MemoryTag::Count ? TAG_NAMES[(int)tag] : "Unknown";
+    }
+
+    bool Memory::Install() {
+        return SDL_SetMemoryFunctions(SDLMalloc, SDLCalloc, SDLRealloc, SDLFree) == 0;
+    }
+
+    void *Memory::Allocate(size_t size, MemoryTag tag) {
+        // Like malloc(0), hand out a unique block
+        if (size == 0)
+            size = 1;
+
+        int sizeClass = GetSizeClass(size);
+        Header *header;
+        if (sizeClass >= 0) {
+            header = reinterpret_cast<Header *>(PopSmall(sizeClass));
+        } else {
+            if (size > SIZE_MAX - sizeof(Header))
+                return nullptr;
+            header = static_cast<Header *>(std::malloc(sizeof(Header) + size));
+        }
+
+        if (!header)
+            return nullptr;
+
+        header->size = size;
+        header->tag = (uint8_t)tag;
+        header->sizeClass = sizeClass >= 0 ? (uint8_t)sizeClass : LARGE_CLASS;
+        header->magic = HEADER_MAGIC;
+        header->site = AllocationSites::ShouldSample() ? AllocationSites::Record(size) : 0;
+        Track(tag, size);
+        return header + 1;
+    }
+
+    void *Memory::AllocateZeroed(size_t count, size_t size, MemoryTag tag) {
+        if (size != 0 && count > SIZE_MAX / size)
+            return nullptr;
+
+        void *pointer = Allocate(count * size, tag);
+        if (pointer)
+            std::memset(pointer, 0, count * size);
+        return pointer;
+    }
+
+    void *Memory::Reallocate(void *pointer, size_t size, MemoryTag tag) {
+        if (!pointer)
+            return Allocate(size, tag);
+
+        Header *header = GetHeader(pointer, "Reallocate");
+        if (size == 0)
+            size = 1;
+
+        MemoryTag blockTag = (MemoryTag)header->tag;
+        int sizeClass = GetSizeClass(size);
+
+        // Stay in place when the block's class still fits
+        if (header->sizeClass != LARGE_CLASS && sizeClass == header->sizeClass) {
+            if (header->site)
+                AllocationSites::Resize(header->site, header->size, size);
+            Untrack(blockTag, header->size);
+            header->size = size;
+            Track(blockTag, size);
+            return pointer;
+        }
+
+        if (header->sizeClass == LARGE_CLASS && sizeClass < 0) {
+            if (size > SIZE_MAX - sizeof(Header))
+                return nullptr;
+
+            size_t oldSize = header->size;
+            Header *resized = static_cast<Header *>(std::realloc(header, sizeof(Header) + size));
+            if (!resized)
+                return nullptr;
+
+            if (resized->site)
+                AllocationSites::Resize(resized->site, oldSize, size);
+            Untrack(blockTag, oldSize);
+            resized->size = size;
+            Track(blockTag, size);
+            return resized + 1;
+        }
+
+        void *moved = Allocate(size, blockTag);
+        if (!moved)
+            return nullptr;
+
+        std::memcpy(moved, pointer, header->size < size ? header->size : size);
+        Free(pointer);
+        return moved;
+    }
+
+    void Memory::Free(void *pointer) {
+        if (!pointer)
+            return;
+
+        Header *header = GetHeader(pointer, "Free");
+        Untrack((MemoryTag)header->tag, header->size);
+        if (header->site)
+            AllocationSites::Release(header->site, header->size);
+        header->magic = 0;
+
+        if (header->sizeClass == LARGE_CLASS)
+            std::free(header);
+        else
+            PushSmall(reinterpret_cast<FreeBlock *>(header), header->sizeClass);
+    }
+
+    MemoryTag Memory::GetThreadTag(MemoryTag fallback) {
+        return t_tag != MemoryTag::Count ? t_tag : fallback;
+    }
+
+    MemoryTag Memory::SetThreadTag(MemoryTag tag) {
+        MemoryTag previous = t_tag;
+        t_tag = tag;
+        return previous;
+    }
+
+    MemoryTagStats Memory::GetTagStats(MemoryTag tag) {
+        const TagCounters &counters = s_tags[(int)tag];
+        return {counters.liveBytes.load(std::memory_order_relaxed), counters.liveCount.load(std::memory_order_relaxed),
+                counters.allocations.load(std::memory_order_relaxed), counters.frees.load(std::memory_order_relaxed)};
+    }
+
+    void Memory::EndFrame() {
+        s_lastFrame.allocations = s_frameAllocations.exchange(0, std::memory_order_relaxed);
+        s_lastFrame.frees = s_frameFrees.exchange(0, std::memory_order_relaxed);
+        s_lastFrame.bytes = s_frameBytes.exchange(0, std::memory_order_relaxed);
+        s_frameCount++;
+    }
+
+    uint64_t Memory::GetFrameCount() {
+        return s_frameCount;
+    }
+
+    MemoryFrameStats Memory::GetLastFrameStats() {
+        return s_lastFrame;
+    }
+
+    void Memory::PrintSummary() {
+        printf("%-10s %14s %10s %12s %12s\n", "Tag", "Live bytes", "Live", "Allocations", "Frees");
+        for (int i = 0; i < (int)MemoryTag::Count; i++) {
+            MemoryTagStats stats = GetTagStats((MemoryTag)i);
+            if (stats.allocations == 0)
+                continue;
+
+            printf("%-10s %14lld %10lld %12llu %12llu\n", TAG_NAMES[i], (long long)stats.liveBytes,
+                   (long long)stats.liveCount, (unsigned long long)stats.allocations,
+                   (unsigned long long)stats.frees);
+        }
+    }
+
+}
+
+// Engine allocations made with new go through the same allocator
+
+void *operator new(size_t size) {
+    void *pointer = Engine::Memory::Allocate(size, Engine::Memory::GetThreadTag(Engine::MemoryTag::Engine));
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return Engine::Memory::Allocate(size, Engine::Memory::GetThreadTag(Engine::MemoryTag::Engine));
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return Engine::Memory::Allocate(size, Engine::Memory::GetThreadTag(Engine::MemoryTag::Engine));
+}
+
+void operator delete(void *pointer) noexcept {
+    Engine::Memory::Free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    Engine::Memory::Free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    Engine::Memory::Free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    Engine::Memory::Free(pointer);
+}
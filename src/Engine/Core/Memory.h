@@ -0,0 +1,121 @@
+//
+// Tracked, tagged allocator shared by SDL and the engine.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine {
+
+    /**
+     * Subsystem an allocation is charged to
+     */
+    enum class MemoryTag : uint8_t {
+        Engine,
+        SDL,
+        Video,
+        Events,
+        Audio,
+        Input,
+        Profiler,
+        Render,
+        ECS,
+        Count
+    };
+
+    const char *GetMemoryTagName(MemoryTag tag);
+
+    struct MemoryTagStats {
+        int64_t liveBytes;
+        int64_t liveCount;
+        uint64_t allocations;
+        uint64_t frees;
+    };
+
+    struct MemoryFrameStats {
+        uint64_t allocations;
+        uint64_t frees;
+        uint64_t bytes;
+    };
+
+    /**
+     * Small requests are served from size-class free lists cached per thread
+     * and refilled in batches from a shared pool; larger ones go straight to
+     * malloc. Every block carries a 16-byte header with its size and tag, so
+     * live bytes and counts are known per tag at all times.
+     *
+     * SDL_malloc and the global operator new both end up here. SDL's
+     * allocations are charged to MemoryTag::SDL and the engine's to
+     * MemoryTag::Engine unless a MemoryTagScope says otherwise.
+     */
+    class Memory {
+    public:
+        /**
+         * Routes SDL's allocations through this allocator. Must run before
+         * anything calls into SDL, since blocks can't change allocators.
+         * @return false if SDL refused the functions
+         */
+        static bool Install();
+
+        static void *Allocate(size_t size, MemoryTag tag);
+        static void *AllocateZeroed(size_t count, size_t size, MemoryTag tag);
+
+        /**
+         * Resizes a block, keeping its tag
+         */
+        static void *Reallocate(void *pointer, size_t size, MemoryTag tag);
+
+        static void Free(void *pointer);
+
+        /**
+         * Gets the tag new allocations on this thread are charged to
+         * @param fallback the tag to use when no MemoryTagScope is active
+         */
+        static MemoryTag GetThreadTag(MemoryTag fallback);
+
+        static MemoryTagStats GetTagStats(MemoryTag tag);
+
+        /**
+         * Closes the per-frame counters. Call once per frame from the main loop.
+         */
+        static void EndFrame();
+
+        /**
+         * Gets the counters of the frame closed by the last EndFrame()
+         */
+        static MemoryFrameStats GetLastFrameStats();
+
+        /**
+         * Gets the number of frames closed by EndFrame()
+         */
+        static uint64_t GetFrameCount();
+
+        /**
+         * Prints live bytes and counts for every tag
+         */
+        static void PrintSummary();
+
+    private:
+        friend class MemoryTagScope;
+
+        static MemoryTag SetThreadTag(MemoryTag tag);
+    };
+
+    /**
+     * Charges allocations made by the calling thread to a tag for the lifetime of the object
+     */
+    class MemoryTagScope {
+    public:
+        explicit MemoryTagScope(MemoryTag tag) : m_previous(Memory::SetThreadTag(tag)) {}
+        ~MemoryTagScope() { Memory::SetThreadTag(m_previous); }
+
+        MemoryTagScope(const MemoryTagScope &) = delete;
+        MemoryTagScope &operator=(const MemoryTagScope &) = delete;
+
+    private:
+        MemoryTag m_previous;
+    };
+
+}
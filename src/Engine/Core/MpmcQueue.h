@@ -0,0 +1,129 @@
+//
+// Bounded lock-free queue for any number of producer and consumer threads.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "Thread.h"
+
+namespace Engine {
+
+    /**
+     * Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence
+     * number saying whose turn it is: a producer may fill cell i when its
+     * sequence equals the enqueue position, and a consumer may empty it
+     * once the sequence is one past. Each side claims a position with one
+     * compare-and-swap, so producers only contend with producers and
+     * consumers with consumers, and the two positions sit on separate
+     * cache lines.
+     *
+     * A stalled thread between claiming a cell and publishing it holds up
+     * consumers of that one cell, but never corrupts the queue.
+     */
+    template <typename T>
+    class MpmcQueue {
+    public:
+        /**
+         * @param capacity rounded up to a power of two, at least 2
+         */
+        explicit MpmcQueue(uint32_t capacity) : m_enqueuePos(0), m_dequeuePos(0) {
+            m_capacity = 2;
+            while (m_capacity < capacity)
+                m_capacity <<= 1;
+            m_mask = m_capacity - 1;
+
+            m_cells = static_cast<Cell *>(::operator new(sizeof(Cell) * m_capacity, std::align_val_t(alignof(Cell))));
+            for (uint32_t i = 0; i < m_capacity; i++)
+                new (&m_cells[i].sequence) std::atomic<uint32_t>(i);
+        }
+
+        ~MpmcQueue() {
+            uint32_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            while (m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) == pos + 1) {
+                reinterpret_cast<T *>(m_cells[pos & m_mask].storage)->~T();
+                pos++;
+            }
+            ::operator delete(m_cells, std::align_val_t(alignof(Cell)));
+        }
+
+        MpmcQueue(const MpmcQueue &) = delete;
+        MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+        /**
+         * @return false if the queue is full
+         */
+        template <typename... Args>
+        bool TryEmplace(Args &&... args) {
+            uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            Cell *cell;
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+                int32_t diff = (int32_t)(sequence - pos);
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            new (cell->storage) T(std::forward<Args>(args)...);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPush(const T &item) { return TryEmplace(item); }
+        bool TryPush(T &&item) { return TryEmplace(std::move(item)); }
+
+        /**
+         * @return false if the queue is empty
+         */
+        bool TryPop(T &item) {
+            uint32_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            Cell *cell;
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+                int32_t diff = (int32_t)(sequence - (pos + 1));
+                if (diff == 0) {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            T *slot = reinterpret_cast<T *>(cell->storage);
+            item = std::move(*slot);
+            slot->~T();
+            cell->sequence.store(pos + m_capacity, std::memory_order_release);
+            return true;
+        }
+
+        uint32_t GetCapacity() const { return m_capacity; }
+
+    private:
+        struct Cell {
+            std::atomic<uint32_t> sequence;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_enqueuePos;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_dequeuePos;
+        alignas(CACHE_LINE_SIZE) Cell *m_cells;
+        uint32_t m_capacity;
+        uint32_t m_mask;
+    };
+
+}
@@ -0,0 +1,202 @@
+//
+// Fixed-capacity object pool addressed by generational handles.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace Engine {
+
+    /**
+     * 32-bit reference to an object in a Pool<T>. The low bits index a slot
+     * and the high bits hold the slot's generation, which changes every time
+     * the slot is freed, so handles to destroyed objects are detected instead
+     * of silently aliasing whatever reuses the slot. A zero handle is null.
+     */
+    template <typename T>
+    class PoolHandle {
+    public:
+        static const int INDEX_BITS = 20;
+        static const int GENERATION_BITS = 32 - INDEX_BITS;
+        static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+        static const uint32_t GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+
+        PoolHandle() : m_value(0) {}
+        PoolHandle(uint32_t index, uint32_t generation) : m_value((generation << INDEX_BITS) | index) {}
+
+        uint32_t GetIndex() const { return m_value & INDEX_MASK; }
+        uint32_t GetGeneration() const { return m_value >> INDEX_BITS; }
+        uint32_t GetValue() const { return m_value; }
+
+        bool IsNull() const { return m_value == 0; }
+
+        bool operator==(const PoolHandle &rhs) const { return m_value == rhs.m_value; }
+        bool operator!=(const PoolHandle &rhs) const { return m_value != rhs.m_value; }
+
+    private:
+        uint32_t m_value;
+    };
+
+    /**
+     * Stores up to a fixed number of objects contiguously, with O(1) create
+     * and destroy. Live objects are kept packed at the front of one array,
+     * so iterating with begin()/end() touches no holes; destroying an object
+     * moves the last one into its place. Because of that, pointers returned
+     * by Get() are only valid until the next Destroy(); keep handles instead.
+     */
+    template <typename T>
+    class Pool {
+    public:
+        typedef PoolHandle<T> Handle;
+
+        static const uint32_t MAX_CAPACITY = Handle::INDEX_MASK + 1;
+
+        /**
+         * @param capacity the most objects alive at once, up to MAX_CAPACITY
+         */
+        explicit Pool(uint32_t capacity) : m_size(0), m_freeHead(0) {
+            m_capacity = capacity < MAX_CAPACITY ? capacity : MAX_CAPACITY;
+            m_objects = static_cast<T *>(::operator new(sizeof(T) * m_capacity, std::align_val_t(alignof(T))));
+            m_denseToSlot = static_cast<uint32_t *>(std::malloc(sizeof(uint32_t) * m_capacity));
+            m_slots = static_cast<Slot *>(std::malloc(sizeof(Slot) * m_capacity));
+
+            // Every slot starts on the free list; generations start at 1 so no handle is ever zero
+            for (uint32_t i = 0; i < m_capacity; i++) {
+                m_slots[i].dense = i + 1;
+                m_slots[i].generation = 1;
+            }
+        }
+
+        ~Pool() {
+            Clear();
+            ::operator delete(m_objects, std::align_val_t(alignof(T)));
+            std::free(m_denseToSlot);
+            std::free(m_slots);
+        }
+
+        Pool(const Pool &) = delete;
+        Pool &operator=(const Pool &) = delete;
+
+        /**
+         * Constructs an object in the pool
+         * @return its handle, or a null handle if the pool is full
+         */
+        template <typename... Args>
+        Handle Create(Args &&... args) {
+            if (m_size == m_capacity)
+                return Handle();
+
+            uint32_t slot = m_freeHead;
+            m_freeHead = m_slots[slot].dense;
+
+            new (m_objects + m_size) T(std::forward<Args>(args)...);
+            m_slots[slot].dense = m_size;
+            m_denseToSlot[m_size] = slot;
+            m_size++;
+            return Handle(slot, m_slots[slot].generation);
+        }
+
+        /**
+         * Destroys an object, invalidating every handle to it
+         * @return false if the handle was null or stale
+         */
+        bool Destroy(Handle handle) {
+            if (!IsValid(handle))
+                return false;
+
+            uint32_t slot = handle.GetIndex();
+            uint32_t dense = m_slots[slot].dense;
+            uint32_t last = m_size - 1;
+
+            // Fill the hole with the last object to keep the array packed
+            if (dense != last) {
+                m_objects[dense] = std::move(m_objects[last]);
+                m_denseToSlot[dense] = m_denseToSlot[last];
+                m_slots[m_denseToSlot[dense]].dense = dense;
+            }
+            m_objects[last].~T();
+            m_size--;
+
+            Retire(slot);
+            return true;
+        }
+
+        /**
+         * Checks whether a handle refers to a live object
+         */
+        bool IsValid(Handle handle) const {
+            uint32_t slot = handle.GetIndex();
+            return !handle.IsNull() && slot < m_capacity && m_slots[slot].generation == handle.GetGeneration() &&
+                   m_slots[slot].dense < m_size && m_denseToSlot[m_slots[slot].dense] == slot;
+        }
+
+        /**
+         * Gets the object a handle refers to
+         * @return the object, or nullptr if the handle is null or stale
+         */
+        T *Get(Handle handle) { return IsValid(handle) ? m_objects + m_slots[handle.GetIndex()].dense : nullptr; }
+
+        const T *Get(Handle handle) const {
+            return IsValid(handle) ? m_objects + m_slots[handle.GetIndex()].dense : nullptr;
+        }
+
+        /**
+         * Gets the handle of the object at a position in iteration order
+         */
+        Handle GetHandle(uint32_t denseIndex) const {
+            uint32_t slot = m_denseToSlot[denseIndex];
+            return Handle(slot, m_slots[slot].generation);
+        }
+
+        /**
+         * Destroys every object
+         */
+        void Clear() {
+            while (m_size > 0) {
+                m_size--;
+                m_objects[m_size].~T();
+                Retire(m_denseToSlot[m_size]);
+            }
+        }
+
+        uint32_t Size() const { return m_size; }
+        uint32_t Capacity() const { return m_capacity; }
+        bool Empty() const { return m_size == 0; }
+        bool Full() const { return m_size == m_capacity; }
+
+        T *begin() { return m_objects; }
+        T *end() { return m_objects + m_size; }
+        const T *begin() const { return m_objects; }
+        const T *end() const { return m_objects + m_size; }
+
+        T &operator[](uint32_t denseIndex) { return m_objects[denseIndex]; }
+        const T &operator[](uint32_t denseIndex) const { return m_objects[denseIndex]; }
+
+    private:
+        struct Slot {
+            // Position in the object array while alive, next free slot otherwise
+            uint32_t dense;
+            uint32_t generation;
+        };
+
+        void Retire(uint32_t slot) {
+            uint32_t generation = (m_slots[slot].generation + 1) & Handle::GENERATION_MASK;
+            m_slots[slot].generation = generation ? generation : 1;
+            m_slots[slot].dense = m_freeHead;
+            m_freeHead = slot;
+        }
+
+        T *m_objects;
+        uint32_t *m_denseToSlot;
+        Slot *m_slots;
+        uint32_t m_size;
+        uint32_t m_capacity;
+        uint32_t m_freeHead;
+    };
+
+}
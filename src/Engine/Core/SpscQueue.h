@@ -0,0 +1,114 @@
+//
+// Bounded lock-free queue for one producer thread and one consumer thread.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "Thread.h"
+
+namespace Engine {
+
+    /**
+     * Ring buffer handing values from exactly one producer thread to
+     * exactly one consumer thread without locks. The write and read
+     * positions live on separate cache lines, and each side keeps a cached
+     * copy of the other's position so it only touches the shared line when
+     * the ring looks full or empty.
+     *
+     * Neither side ever waits; a full or empty ring fails the call and the
+     * caller decides whether to spin, yield or drop.
+     */
+    template <typename T>
+    class SpscQueue {
+    public:
+        /**
+         * @param capacity rounded up to a power of two
+         */
+        explicit SpscQueue(uint32_t capacity) : m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0) {
+            m_capacity = 1;
+            while (m_capacity < capacity)
+                m_capacity <<= 1;
+            m_mask = m_capacity - 1;
+            m_items = static_cast<T *>(::operator new(sizeof(T) * m_capacity, std::align_val_t(alignof(T))));
+        }
+
+        ~SpscQueue() {
+            uint32_t tail = m_tail.load(std::memory_order_acquire);
+            for (uint32_t head = m_head.load(std::memory_order_relaxed); head != tail; head++)
+                m_items[head & m_mask].~T();
+            ::operator delete(m_items, std::align_val_t(alignof(T)));
+        }
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        /**
+         * Producer only
+         * @return false if the queue is full
+         */
+        template <typename... Args>
+        bool TryEmplace(Args &&... args) {
+            uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cachedHead == m_capacity) {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail - m_cachedHead == m_capacity)
+                    return false;
+            }
+
+            new (m_items + (tail & m_mask)) T(std::forward<Args>(args)...);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPush(const T &item) { return TryEmplace(item); }
+        bool TryPush(T &&item) { return TryEmplace(std::move(item)); }
+
+        /**
+         * Consumer only
+         * @return false if the queue is empty
+         */
+        bool TryPop(T &item) {
+            uint32_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cachedTail) {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cachedTail)
+                    return false;
+            }
+
+            T *slot = m_items + (head & m_mask);
+            item = std::move(*slot);
+            slot->~T();
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Gets the number of queued items. Exact only on a quiet queue.
+         */
+        uint32_t GetSize() const {
+            return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        }
+
+        uint32_t GetCapacity() const { return m_capacity; }
+
+    private:
+        // Consumer side
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_head;
+        uint32_t m_cachedTail;
+
+        // Producer side
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_tail;
+        uint32_t m_cachedHead;
+
+        alignas(CACHE_LINE_SIZE) T *m_items;
+        uint32_t m_capacity;
+        uint32_t m_mask;
+    };
+
+}
@@ -0,0 +1,60 @@
+//
+// Platform helpers for naming, pinning and spinning threads.
+//
+
+#include "Thread.h"
+
+#include "Profiler.h"
+
+#include <cstring>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace Engine {
+
+    void SetCurrentThreadName(const char *name) {
+        PROFILE_THREAD_NAME(name);
+
+#if defined(__APPLE__)
+        pthread_setname_np(name);
+#elif defined(__linux__)
+        // The kernel keeps 15 characters and refuses longer names outright
+        char truncated[16];
+        std::strncpy(truncated, name, sizeof(truncated) - 1);
+        truncated[sizeof(truncated) - 1] = '\0';
+        pthread_setname_np(pthread_self(), truncated);
+#else
+        (void)name;
+#endif
+    }
+
+    bool PinCurrentThread(uint32_t cpu) {
+#if defined(_WIN32)
+        if (cpu >= sizeof(DWORD_PTR) * 8)
+            return false;
+        return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+        if (cpu >= CPU_SETSIZE)
+            return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        // macOS only takes affinity hints between threads
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    uint32_t GetHardwareThreadCount() {
+        unsigned int count = std::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+
+}
@@ -0,0 +1,51 @@
+//
+// Platform helpers for naming, pinning and spinning threads.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Engine {
+
+    /**
+     * Alignment that keeps data written by different threads off each
+     * other's cache lines. 64 bytes on every CPU the engine targets;
+     * CpuDispatch::GetCacheLineSize() reports the real value.
+     */
+    const size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * Names the calling thread for debuggers, system tools and profiler captures
+     * @param name at most 15 characters are kept on Linux
+     */
+    void SetCurrentThreadName(const char *name);
+
+    /**
+     * Restricts the calling thread to one logical CPU
+     * @return false where pinning is unsupported or the CPU doesn't exist
+     */
+    bool PinCurrentThread(uint32_t cpu);
+
+    /**
+     * Gets the number of logical CPUs, at least 1
+     */
+    uint32_t GetHardwareThreadCount();
+
+    /**
+     * Tells the CPU the caller is in a spin-wait loop
+     */
+    inline void CpuRelax() {
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+}
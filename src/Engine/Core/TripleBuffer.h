@@ -0,0 +1,80 @@
+//
+// Lock-free triple buffer handing the latest value from one thread to another.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Thread.h"
+
+namespace Engine {
+
+    /**
+     * Three copies of a value shared by one producer and one consumer. The
+     * producer fills the back copy and publishes it by swapping it with the
+     * middle one; the consumer takes the middle copy by swapping it with
+     * the front one. Neither side ever waits for the other, and the
+     * consumer always sees the most recently published value; values
+     * published faster than they are consumed are skipped.
+     */
+    template <typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() : m_middle(1), m_back(0), m_front(2) {}
+
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        /**
+         * Producer only: the copy to fill before Publish()
+         */
+        T &GetBack() { return m_buffers[m_back]; }
+
+        /**
+         * Producer only: hands the back copy to the consumer
+         */
+        void Publish() {
+            uint8_t previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+            m_back = previous & INDEX_MASK;
+        }
+
+        /**
+         * Checks whether a value was published since the consumer last took one
+         */
+        bool HasNew() const { return (m_middle.load(std::memory_order_acquire) & FRESH) != 0; }
+
+        /**
+         * Consumer only: takes the latest published value, if any
+         * @return false if nothing new was published
+         */
+        bool Acquire() {
+            if (!HasNew())
+                return false;
+
+            uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front = previous & INDEX_MASK;
+            return true;
+        }
+
+        /**
+         * Consumer only: the value taken by the last successful Acquire()
+         */
+        const T &GetFront() const { return m_buffers[m_front]; }
+
+    private:
+        static const uint8_t INDEX_MASK = 0x3;
+        static const uint8_t FRESH = 0x4;
+
+        T m_buffers[3];
+
+        // Index of the middle copy, plus FRESH when it holds an unread value
+        std::atomic<uint8_t> m_middle;
+
+        // Each side's own index, kept off the other side's cache line
+        alignas(CACHE_LINE_SIZE) uint8_t m_back;
+        alignas(CACHE_LINE_SIZE) uint8_t m_front;
+    };
+
+}
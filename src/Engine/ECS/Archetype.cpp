@@ -0,0 +1,166 @@
+//
+// Chunked structure-of-arrays storage for entities sharing a component set.
+//
+
+#include "Archetype.h"
+
+#include "Memory.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Engine {
+
+    namespace {
+
+        size_t AlignUp(size_t value, size_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        /**
+         * Places the columns of a chunk holding \c capacity rows
+         * @return the end of the last column
+         */
+        size_t LayOutColumns(const std::vector<size_t> &sizes, uint32_t capacity, std::vector<size_t> &offsets) {
+            size_t offset = AlignUp(sizeof(Entity) * capacity, Archetype::COLUMN_ALIGNMENT);
+            for (size_t i = 0; i < sizes.size(); i++) {
+                offsets[i] = offset;
+                offset = AlignUp(offset + sizes[i] * capacity, Archetype::COLUMN_ALIGNMENT);
+            }
+            return offset;
+        }
+
+        void MoveComponent(const ComponentInfo &info, void *target, void *source) {
+            if (info.trivial) {
+                std::memcpy(target, source, info.size);
+            } else {
+                info.moveConstruct(target, source);
+                info.destroy(source);
+            }
+        }
+    }
+
+    Archetype::Archetype(const ComponentMask &mask) : m_mask(mask), m_entityCount(0), m_spare(nullptr) {
+        for (uint32_t i = 0; i < MAX_COMPONENTS; i++) {
+            m_columnOf[i] = -1;
+            m_addEdges[i] = nullptr;
+            m_removeEdges[i] = nullptr;
+        }
+
+        size_t rowSize = sizeof(Entity);
+        for (ComponentId id = 0; id < MAX_COMPONENTS; id++) {
+            if (!mask.Has(id))
+                continue;
+            const ComponentInfo &info = ComponentRegistry::Get(id);
+            if (info.alignment > COLUMN_ALIGNMENT) {
+                printf("Component %s needs %zu-byte alignment, but chunk columns are only %zu-byte aligned\n",
+                       info.name, info.alignment, COLUMN_ALIGNMENT);
+                std::abort();
+            }
+
+            m_columnOf[id] = (int)m_components.size();
+            m_components.push_back(id);
+            m_sizes.push_back(info.size);
+            rowSize += info.size;
+        }
+
+        // Start from the capacity that ignores padding and back off until the aligned columns fit. The
+        // offsets left behind are the ones of the capacity picked.
+        m_offsets.resize(m_components.size());
+        for (m_chunkCapacity = (uint32_t)(CHUNK_SIZE / rowSize); m_chunkCapacity > 0; m_chunkCapacity--) {
+            if (LayOutColumns(m_sizes, m_chunkCapacity, m_offsets) <= CHUNK_SIZE)
+                break;
+        }
+
+        if (m_chunkCapacity == 0) {
+            printf("Entities with");
+            for (ComponentId id : m_components)
+                printf(" %s", ComponentRegistry::Get(id).name);
+            printf(" take %zu bytes each, more than a %zu-byte chunk holds\n", rowSize, CHUNK_SIZE);
+            std::abort();
+        }
+    }
+
+    Archetype::~Archetype() {
+        for (uint32_t chunk = 0; chunk < m_chunks.size(); chunk++) {
+            for (uint32_t row = 0; row < m_chunks[chunk]->count; row++)
+                DestroyRow(chunk, row);
+        }
+        for (Chunk *chunk : m_chunks)
+            FreeChunk(chunk);
+        if (m_spare)
+            FreeChunk(m_spare);
+    }
+
+    Chunk *Archetype::AllocateChunk() {
+        if (m_spare) {
+            Chunk *chunk = m_spare;
+            m_spare = nullptr;
+            return chunk;
+        }
+
+        // The allocator only guarantees 16 bytes, so over-allocate and align the columns by hand
+        unsigned char *block = static_cast<unsigned char *>(
+            Memory::Allocate(sizeof(Chunk) + CHUNK_SIZE + COLUMN_ALIGNMENT, MemoryTag::ECS));
+        Chunk *chunk = new (block) Chunk();
+        chunk->archetype = this;
+        chunk->data = reinterpret_cast<unsigned char *>(
+            AlignUp(reinterpret_cast<uintptr_t>(block + sizeof(Chunk)), COLUMN_ALIGNMENT));
+        chunk->count = 0;
+        return chunk;
+    }
+
+    void Archetype::FreeChunk(Chunk *chunk) {
+        Memory::Free(chunk);
+    }
+
+    void Archetype::AddRow(Entity entity, uint32_t &chunk, uint32_t &row) {
+        if (m_chunks.empty() || m_chunks.back()->count == m_chunkCapacity)
+            m_chunks.push_back(AllocateChunk());
+
+        Chunk *last = m_chunks.back();
+        chunk = (uint32_t)m_chunks.size() - 1;
+        row = last->count++;
+        last->GetEntities()[row] = entity;
+        m_entityCount++;
+    }
+
+    void Archetype::DestroyRow(uint32_t chunk, uint32_t row) {
+        for (size_t i = 0; i < m_components.size(); i++) {
+            const ComponentInfo &info = ComponentRegistry::Get(m_components[i]);
+            if (!info.trivial)
+                info.destroy(GetComponentData(*m_chunks[chunk], (int)i, row));
+        }
+    }
+
+    Entity Archetype::RemoveRow(uint32_t chunk, uint32_t row) {
+        Chunk *last = m_chunks.back();
+        uint32_t lastRow = last->count - 1;
+        Entity moved;
+
+        if (m_chunks[chunk] != last || row != lastRow) {
+            Chunk *hole = m_chunks[chunk];
+            for (size_t i = 0; i < m_components.size(); i++) {
+                MoveComponent(ComponentRegistry::Get(m_components[i]), GetComponentData(*hole, (int)i, row),
+                              GetComponentData(*last, (int)i, lastRow));
+            }
+            moved = last->GetEntities()[lastRow];
+            hole->GetEntities()[row] = moved;
+        }
+
+        last->count--;
+        m_entityCount--;
+
+        // Keep one empty chunk spare so an entity bouncing across a chunk boundary doesn't thrash the allocator
+        if (last->count == 0) {
+            m_chunks.pop_back();
+            if (m_spare)
+                FreeChunk(last);
+            else
+                m_spare = last;
+        }
+        return moved;
+    }
+
+}
@@ -0,0 +1,122 @@
+//
+// Chunked structure-of-arrays storage for entities sharing a component set.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Component.h"
+
+namespace Engine {
+
+    class Archetype;
+
+    /**
+     * A fixed-size block holding up to the archetype's chunk capacity of
+     * entities. Each component has its own cache-line aligned column, so
+     * iterating one component walks contiguous memory.
+     */
+    struct Chunk {
+        Archetype *archetype;
+        unsigned char *data;
+        uint32_t count;
+
+        Entity *GetEntities() const { return reinterpret_cast<Entity *>(data); }
+
+        /**
+         * Gets the column of a component, or nullptr if the archetype doesn't have it
+         */
+        template <typename T>
+        T *Get() const;
+    };
+
+    /**
+     * Every entity with exactly one set of components. Rows are kept packed:
+     * all chunks are full except the last, and removing a row moves the
+     * archetype's last row into the hole.
+     */
+    class Archetype {
+    public:
+        static const size_t CHUNK_SIZE = 16 * 1024;
+        static const size_t COLUMN_ALIGNMENT = 64;
+
+        explicit Archetype(const ComponentMask &mask);
+        ~Archetype();
+
+        Archetype(const Archetype &) = delete;
+        Archetype &operator=(const Archetype &) = delete;
+
+        const ComponentMask &GetMask() const { return m_mask; }
+
+        uint32_t GetComponentCount() const { return (uint32_t)m_components.size(); }
+        ComponentId GetComponent(uint32_t column) const { return m_components[column]; }
+
+        /**
+         * Gets where a component lives in each chunk
+         * @return the column index, or -1 if the archetype lacks the component
+         */
+        int GetColumn(ComponentId id) const { return m_columnOf[id]; }
+
+        uint32_t GetChunkCapacity() const { return m_chunkCapacity; }
+        uint32_t GetChunkCount() const { return (uint32_t)m_chunks.size(); }
+        Chunk *GetChunk(uint32_t index) const { return m_chunks[index]; }
+        uint32_t GetEntityCount() const { return m_entityCount; }
+
+        void *GetColumnData(const Chunk &chunk, int column) const { return chunk.data + m_offsets[column]; }
+
+        void *GetComponentData(const Chunk &chunk, int column, uint32_t row) const {
+            return chunk.data + m_offsets[column] + row * m_sizes[column];
+        }
+
+        /**
+         * Appends a row for \c entity with its components left unconstructed
+         * @param[out] chunk index of the chunk the row is in
+         * @param[out] row the row within that chunk
+         */
+        void AddRow(Entity entity, uint32_t &chunk, uint32_t &row);
+
+        /**
+         * Runs the destructors of every component in a row
+         */
+        void DestroyRow(uint32_t chunk, uint32_t row);
+
+        /**
+         * Removes a row whose components were already destroyed or moved
+         * out, filling the hole with the archetype's last row
+         * @return the entity moved into the hole, or a null entity if none was
+         */
+        Entity RemoveRow(uint32_t chunk, uint32_t row);
+
+        // Archetypes one component away, filled in by the World as they are needed
+        Archetype *GetAddEdge(ComponentId id) const { return m_addEdges[id]; }
+        Archetype *GetRemoveEdge(ComponentId id) const { return m_removeEdges[id]; }
+        void SetAddEdge(ComponentId id, Archetype *archetype) { m_addEdges[id] = archetype; }
+        void SetRemoveEdge(ComponentId id, Archetype *archetype) { m_removeEdges[id] = archetype; }
+
+    private:
+        ComponentMask m_mask;
+        std::vector<ComponentId> m_components;
+        std::vector<size_t> m_offsets;
+        std::vector<size_t> m_sizes;
+        int m_columnOf[MAX_COMPONENTS];
+        uint32_t m_chunkCapacity;
+        uint32_t m_entityCount;
+        std::vector<Chunk *> m_chunks;
+        Chunk *m_spare;
+        Archetype *m_addEdges[MAX_COMPONENTS];
+        Archetype *m_removeEdges[MAX_COMPONENTS];
+
+        Chunk *AllocateChunk();
+        void FreeChunk(Chunk *chunk);
+    };
+
+    template <typename T>
+    T *Chunk::Get() const {
+        int column = archetype->GetColumn(GetComponentId<T>());
+        return column >= 0 ? static_cast<T *>(archetype->GetColumnData(*this, column)) : nullptr;
+    }
+
+}
@@ -0,0 +1,140 @@
+//
+// Structural changes recorded now and applied to a World later.
+//
+
+#include "CommandBuffer.h"
+
+#include "Memory.h"
+#include "World.h"
+
+#include <cstring>
+
+namespace Engine {
+
+    namespace {
+
+        const uint32_t PENDING_GENERATION = Entity::MAX_GENERATION + 1;
+
+        bool IsPending(Entity entity) {
+            return entity.generation == PENDING_GENERATION;
+        }
+    }
+
+    CommandBuffer::CommandBuffer() : m_block(0), m_used(0), m_pendingCount(0) {}
+
+    CommandBuffer::~CommandBuffer() {
+        DestroyPayloads();
+        for (const Block &block : m_blocks)
+            Memory::Free(block.data);
+    }
+
+    Entity CommandBuffer::Create() {
+        Entity entity(m_pendingCount++, PENDING_GENERATION);
+        Record(CommandType::Create, entity, 0, nullptr);
+        return entity;
+    }
+
+    void CommandBuffer::Destroy(Entity entity) {
+        Record(CommandType::Destroy, entity, 0, nullptr);
+    }
+
+    void CommandBuffer::Record(CommandType type, Entity entity, ComponentId component, void *payload) {
+        MemoryTagScope tag(MemoryTag::ECS);
+        m_commands.push_back(Command{type, component, entity, payload});
+    }
+
+    void *CommandBuffer::AllocatePayload(size_t size, size_t alignment) {
+        for (;;) {
+            if (m_block == m_blocks.size()) {
+                // Blocks are kept after Playback(), so only the first frames ever allocate
+                MemoryTagScope tag(MemoryTag::ECS);
+                Block block;
+                block.size = size + alignment > BLOCK_SIZE ? size + alignment : BLOCK_SIZE;
+                block.data = static_cast<unsigned char *>(Memory::Allocate(block.size, MemoryTag::ECS));
+                m_blocks.push_back(block);
+            }
+
+            const Block &block = m_blocks[m_block];
+            uintptr_t start = reinterpret_cast<uintptr_t>(block.data);
+            size_t offset = ((start + m_used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - start;
+            if (offset + size <= block.size) {
+                m_used = offset + size;
+                return block.data + offset;
+            }
+            m_block++;
+            m_used = 0;
+        }
+    }
+
+    void CommandBuffer::Playback(World &world, std::vector<Entity> *created) {
+        MemoryTagScope tag(MemoryTag::ECS);
+        std::vector<Entity> local;
+        if (!created)
+            created = &local;
+        created->assign(m_pendingCount, Entity());
+
+        for (Command &command : m_commands) {
+            Entity entity = command.entity;
+            if (IsPending(entity))
+                entity = entity.index < created->size() ? (*created)[entity.index] : Entity();
+
+            switch (command.type) {
+            case CommandType::Create:
+                (*created)[command.entity.index] = world.Create();
+                break;
+
+            case CommandType::Destroy:
+                world.Destroy(entity);
+                break;
+
+            case CommandType::Add: {
+                const ComponentInfo &info = ComponentRegistry::Get(command.component);
+                void *target = world.GetRaw(entity, command.component);
+                if (target) {
+                    if (!info.trivial)
+                        info.destroy(target);
+                } else {
+                    target = world.AddRaw(entity, command.component);
+                }
+
+                if (target) {
+                    if (info.trivial)
+                        std::memcpy(target, command.payload, info.size);
+                    else
+                        info.moveConstruct(target, command.payload);
+                }
+                if (!info.trivial)
+                    info.destroy(command.payload);
+                command.payload = nullptr;
+                break;
+            }
+
+            case CommandType::Remove:
+                world.RemoveRaw(entity, command.component);
+                break;
+            }
+        }
+
+        Clear();
+    }
+
+    void CommandBuffer::Clear() {
+        DestroyPayloads();
+        m_commands.clear();
+        m_block = 0;
+        m_used = 0;
+        m_pendingCount = 0;
+    }
+
+    void CommandBuffer::DestroyPayloads() {
+        for (Command &command : m_commands) {
+            if (command.payload) {
+                const ComponentInfo &info = ComponentRegistry::Get(command.component);
+                if (!info.trivial)
+                    info.destroy(command.payload);
+                command.payload = nullptr;
+            }
+        }
+    }
+
+}
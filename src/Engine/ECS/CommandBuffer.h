@@ -0,0 +1,110 @@
+//
+// Structural changes recorded now and applied to a World later.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Component.h"
+
+namespace Engine {
+
+    class World;
+
+    /**
+     * Records entity creation, destruction and component adds and removes
+     * while a World is being iterated, then applies them in order with
+     * Playback() once iteration is over. Each thread records into its own
+     * buffer; a buffer itself is not thread safe.
+     */
+    class CommandBuffer {
+    public:
+        CommandBuffer();
+        ~CommandBuffer();
+
+        CommandBuffer(const CommandBuffer &) = delete;
+        CommandBuffer &operator=(const CommandBuffer &) = delete;
+
+        /**
+         * Reserves an entity that is created on playback. The handle only
+         * means something to this buffer until then; commands recorded
+         * against it here apply to the created entity.
+         */
+        Entity Create();
+
+        void Destroy(Entity entity);
+
+        /**
+         * Adds a component on playback, replacing its value if the entity
+         * already has it. The value is built now and moved into the World later.
+         */
+        template <typename T, typename... Args>
+        void Add(Entity entity, Args &&... args);
+
+        template <typename T>
+        void Remove(Entity entity);
+
+        /**
+         * Applies every command in the order it was recorded and empties the
+         * buffer. Commands against entities that died in the meantime are
+         * dropped.
+         * @param[out] created if set, receives the entities made for each
+         *             Create(), in the order they were recorded
+         */
+        void Playback(World &world, std::vector<Entity> *created = nullptr);
+
+        /**
+         * Drops every command without applying it
+         */
+        void Clear();
+
+        bool IsEmpty() const { return m_commands.empty(); }
+        size_t GetCommandCount() const { return m_commands.size(); }
+
+    private:
+        static const size_t BLOCK_SIZE = 16 * 1024;
+
+        enum class CommandType : uint8_t { Create, Destroy, Add, Remove };
+
+        struct Command {
+            CommandType type;
+            ComponentId component;
+            Entity entity;
+            void *payload;
+        };
+
+        // Payloads are bump-allocated from blocks that never move, so recorded pointers stay valid
+        struct Block {
+            unsigned char *data;
+            size_t size;
+        };
+
+        std::vector<Command> m_commands;
+        std::vector<Block> m_blocks;
+        size_t m_block;
+        size_t m_used;
+        uint32_t m_pendingCount;
+
+        void *AllocatePayload(size_t size, size_t alignment);
+        void Record(CommandType type, Entity entity, ComponentId component, void *payload);
+        void DestroyPayloads();
+    };
+
+    template <typename T, typename... Args>
+    void CommandBuffer::Add(Entity entity, Args &&... args) {
+        void *payload = AllocatePayload(sizeof(T), alignof(T));
+        new (payload) T(std::forward<Args>(args)...);
+        Record(CommandType::Add, entity, GetComponentId<T>(), payload);
+    }
+
+    template <typename T>
+    void CommandBuffer::Remove(Entity entity) {
+        Record(CommandType::Remove, entity, GetComponentId<T>(), nullptr);
+    }
+
+}
@@ -0,0 +1,40 @@
+//
+// Entity handles, component type ids and component sets.
+//
+
+#include "Component.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+namespace Engine {
+
+    namespace {
+
+        std::mutex s_mutex;
+        ComponentInfo s_components[MAX_COMPONENTS];
+        uint32_t s_count = 0;
+    }
+
+    ComponentId ComponentRegistry::Register(const ComponentInfo &info) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_count == MAX_COMPONENTS) {
+            printf("Too many component types registering %s, the limit is %u\n", info.name, MAX_COMPONENTS);
+            std::abort();
+        }
+
+        s_components[s_count] = info;
+        return s_count++;
+    }
+
+    const ComponentInfo &ComponentRegistry::Get(ComponentId id) {
+        return s_components[id];
+    }
+
+    uint32_t ComponentRegistry::GetCount() {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        return s_count;
+    }
+
+}
@@ -0,0 +1,183 @@
+//
+// Entity handles, component type ids and component sets.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Engine {
+
+    /**
+     * Reference to an entity in a World. The generation changes every time
+     * the index is reused, so handles to destroyed entities are detected.
+     * Generation 0 is never used by live entities; a default Entity is null.
+     */
+    struct Entity {
+        // The one generation above this marks entities a CommandBuffer has yet to create
+        static const uint32_t MAX_GENERATION = 0xFFFFFFFE;
+
+        uint32_t index;
+        uint32_t generation;
+
+        Entity() : index(0), generation(0) {}
+        Entity(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+        bool IsNull() const { return generation == 0; }
+
+        bool operator==(const Entity &rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(const Entity &rhs) const { return !(*this == rhs); }
+    };
+
+    typedef uint32_t ComponentId;
+
+    const uint32_t MAX_COMPONENTS = 64;
+
+    /**
+     * A set of component types, one bit per ComponentId
+     */
+    class ComponentMask {
+    public:
+        ComponentMask() : m_bits(0) {}
+        explicit ComponentMask(uint64_t bits) : m_bits(bits) {}
+
+        void Set(ComponentId id) { m_bits |= (uint64_t)1 << id; }
+        void Reset(ComponentId id) { m_bits &= ~((uint64_t)1 << id); }
+        bool Has(ComponentId id) const { return (m_bits >> id) & 1; }
+
+        /**
+         * Checks whether every component of \c other is also in this set
+         */
+        bool Contains(const ComponentMask &other) const { return (m_bits & other.m_bits) == other.m_bits; }
+        bool Intersects(const ComponentMask &other) const { return (m_bits & other.m_bits) != 0; }
+
+        bool IsEmpty() const { return m_bits == 0; }
+        uint64_t GetBits() const { return m_bits; }
+
+        bool operator==(const ComponentMask &rhs) const { return m_bits == rhs.m_bits; }
+        bool operator!=(const ComponentMask &rhs) const { return m_bits != rhs.m_bits; }
+
+    private:
+        uint64_t m_bits;
+    };
+
+    /**
+     * How to store and relocate one component type without knowing it
+     */
+    struct ComponentInfo {
+        const char *name;
+        size_t size;
+        size_t alignment;
+        void (*construct)(void *target);
+        void (*moveConstruct)(void *target, void *source);
+        void (*destroy)(void *target);
+
+        // Moved with memcpy and never destroyed
+        bool trivial;
+    };
+
+    /**
+     * Hands out ComponentIds in order of first use. Thread safe.
+     */
+    class ComponentRegistry {
+    public:
+        /**
+         * Running out of ids is a build-time decision gone wrong, so it
+         * prints the offending type and aborts
+         */
+        static ComponentId Register(const ComponentInfo &info);
+
+        static const ComponentInfo &Get(ComponentId id);
+
+        static uint32_t GetCount();
+    };
+
+    namespace ComponentDetail {
+
+        /**
+         * Cuts the type name out of the compiler's signature of this function
+         */
+        template <typename T>
+        const char *GetTypeName() {
+#if defined(_MSC_VER)
+            static const char *const signature = __FUNCSIG__;
+            static const char *const prefix = "GetTypeName<";
+            static const char suffix = '>';
+#else
+            static const char *const signature = __PRETTY_FUNCTION__;
+            static const char *const prefix = "T = ";
+            static const char suffix = ']';
+#endif
+            static char name[64];
+            if (!name[0]) {
+                const char *start = signature;
+                for (const char *p = signature; *p; p++) {
+                    const char *a = p;
+                    const char *b = prefix;
+                    while (*b && *a == *b) {
+                        a++;
+                        b++;
+                    }
+                    if (!*b) {
+                        start = a;
+                        break;
+                    }
+                }
+
+                size_t length = 0;
+                while (start[length] && start[length] != suffix && start[length] != ';' && length < sizeof(name) - 1)
+                    length++;
+                for (size_t i = 0; i < length; i++)
+                    name[i] = start[i];
+                name[length] = '\0';
+            }
+            return name;
+        }
+
+        template <typename T>
+        ComponentInfo MakeInfo() {
+            ComponentInfo info;
+            info.name = GetTypeName<T>();
+            info.size = sizeof(T);
+            info.alignment = alignof(T);
+            info.construct = [](void *target) { new (target) T(); };
+            info.moveConstruct = [](void *target, void *source) { new (target) T(std::move(*static_cast<T *>(source))); };
+            info.destroy = [](void *target) { static_cast<T *>(target)->~T(); };
+            info.trivial = std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value;
+            return info;
+        }
+
+        template <typename T>
+        struct TypeId {
+            static ComponentId Get() {
+                static_assert(std::is_default_constructible<T>::value, "Components need a default constructor");
+                static_assert(std::is_move_constructible<T>::value, "Components must be movable");
+                static const ComponentId id = ComponentRegistry::Register(MakeInfo<T>());
+                return id;
+            }
+        };
+    }
+
+    /**
+     * Gets the id of a component type, registering it on first use.
+     * Const and non-const T share an id.
+     */
+    template <typename T>
+    ComponentId GetComponentId() {
+        return ComponentDetail::TypeId<typename std::remove_cv<T>::type>::Get();
+    }
+
+    template <typename... Ts>
+    ComponentMask MakeComponentMask() {
+        ComponentMask mask;
+        ComponentId ids[] = {GetComponentId<Ts>()..., 0};
+        for (size_t i = 0; i < sizeof...(Ts); i++)
+            mask.Set(ids[i]);
+        return mask;
+    }
+
+}
@@ -0,0 +1,149 @@
+//
+// Runs systems on the job system, ordered by the components they touch.
+//
+
+#include "SystemScheduler.h"
+
+#include "Profiler.h"
+#include "World.h"
+
+#include <cstdio>
+
+namespace Engine {
+
+    namespace {
+
+        /**
+         * Prints the names of the components in a mask, comma separated
+         */
+        void PrintComponents(const ComponentMask &mask) {
+            const char *separator = "";
+            for (ComponentId id = 0; id < MAX_COMPONENTS; id++) {
+                if (mask.Has(id)) {
+                    printf("%s%s", separator, ComponentRegistry::Get(id).name);
+                    separator = ", ";
+                }
+            }
+        }
+    }
+
+    SystemScheduler::SystemScheduler() : m_frame(nullptr), m_lastRunNs(0) {}
+
+    SystemScheduler::~SystemScheduler() {}
+
+    uint32_t SystemScheduler::Register(const char *name, Function function, void *userData,
+                                       const ComponentMask &reads, const ComponentMask &writes) {
+        std::unique_ptr<System> system(new System());
+        system->name = name;
+        system->function = function;
+        system->userData = userData;
+        system->writes = writes;
+        system->reads = ComponentMask(reads.GetBits() & ~writes.GetBits());
+        system->waitingFor.store(0, std::memory_order_relaxed);
+        system->lastNs = 0;
+
+        uint32_t index = (uint32_t)m_systems.size();
+        ComponentMask touches(reads.GetBits() | writes.GetBits());
+        for (uint32_t i = 0; i < index; i++) {
+            System &earlier = *m_systems[i];
+            ComponentMask earlierTouches(earlier.reads.GetBits() | earlier.writes.GetBits());
+            if (writes.Intersects(earlierTouches) || touches.Intersects(earlier.writes)) {
+                system->dependencies.push_back(i);
+                earlier.dependents.push_back(index);
+            }
+        }
+
+        if (system->dependencies.empty())
+            m_roots.push_back(index);
+        m_systems.push_back(std::move(system));
+        return index;
+    }
+
+    void SystemScheduler::Run(World &world, JobSystem &jobs, float dt) {
+        PROFILE_FUNCTION();
+        uint64_t start = Profiler::Now();
+
+        Frame frame;
+        frame.world = &world;
+        frame.jobs = &jobs;
+        frame.dt = dt;
+        m_frame = &frame;
+
+        if (jobs.IsRunning()) {
+            for (const std::unique_ptr<System> &system : m_systems)
+                system->waitingFor.store((uint32_t)system->dependencies.size(), std::memory_order_relaxed);
+
+            // Every later submission comes from a job still counted by frame.done, so it can't hit zero early
+            for (uint32_t root : m_roots)
+                Submit(root);
+            jobs.Wait(frame.done);
+        } else {
+            for (uint32_t i = 0; i < m_systems.size(); i++)
+                Execute(i);
+        }
+
+        // Registration order, not finishing order, so the World ends up the same on every run
+        {
+            PROFILE_SCOPE("Playback");
+            for (const std::unique_ptr<System> &system : m_systems)
+                system->commands.Playback(world);
+        }
+
+        m_frame = nullptr;
+        m_lastRunNs = Profiler::Now() - start;
+    }
+
+    void SystemScheduler::Submit(uint32_t index) {
+        m_frame->jobs->Submit([this, index]() { Execute(index); }, &m_frame->done);
+    }
+
+    void SystemScheduler::Execute(uint32_t index) {
+        System &system = *m_systems[index];
+        uint64_t start = Profiler::Now();
+        {
+            PROFILE_SCOPE(system.name);
+            SystemContext context = {*m_frame->world, system.commands, *m_frame->jobs, m_frame->dt};
+            system.function(context, system.userData);
+        }
+        system.lastNs = Profiler::Now() - start;
+
+        if (!m_frame->jobs->IsRunning())
+            return;
+
+        // The last dependency to finish releases each dependent
+        for (uint32_t dependent : system.dependents) {
+            if (m_systems[dependent]->waitingFor.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                Submit(dependent);
+        }
+    }
+
+    void SystemScheduler::PrintSchedule() const {
+        for (uint32_t i = 0; i < m_systems.size(); i++) {
+            const System &system = *m_systems[i];
+            printf("%2u %s\n   reads: ", i, system.name);
+            PrintComponents(system.reads);
+            printf("\n   writes: ");
+            PrintComponents(system.writes);
+            printf("\n");
+
+            for (uint32_t dependency : system.dependencies) {
+                const System &earlier = *m_systems[dependency];
+                ComponentMask shared((system.writes.GetBits() & (earlier.reads.GetBits() | earlier.writes.GetBits())) |
+                                     (system.reads.GetBits() & earlier.writes.GetBits()));
+                printf("   after %s (", earlier.name);
+                PrintComponents(shared);
+                printf(")\n");
+            }
+        }
+    }
+
+    void SystemScheduler::PrintTimings() const {
+        uint64_t sum = 0;
+        for (const std::unique_ptr<System> &system : m_systems) {
+            printf("%-32s %8.3f ms\n", system->name, system->lastNs / 1e6);
+            sum += system->lastNs;
+        }
+        printf("%-32s %8.3f ms run, %8.3f ms summed over systems\n", "Total", m_lastRunNs / 1e6, sum / 1e6);
+    }
+
+}
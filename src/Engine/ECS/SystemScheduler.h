@@ -0,0 +1,132 @@
+//
+// Runs systems on the job system, ordered by the components they touch.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CommandBuffer.h"
+#include "Component.h"
+#include "JobSystem.h"
+
+namespace Engine {
+
+    class World;
+
+    /**
+     * What a system gets to work with while it runs
+     */
+    struct SystemContext {
+        World &world;
+
+        // Structural changes made by this system, applied after every system has run
+        CommandBuffer &commands;
+
+        // For systems that split their own work with ParallelFor
+        JobSystem &jobs;
+
+        float dt;
+    };
+
+    /**
+     * Runs a fixed list of systems once per Run(). Each system declares the
+     * components it reads and writes when it is registered; two systems
+     * conflict when one writes a component the other reads or writes, and
+     * conflicting systems run in registration order. Everything else runs
+     * concurrently on the job system, so no system needs locks as long as
+     * its declaration is honest.
+     *
+     * Systems must not change the World's structure directly. Their command
+     * buffers are played back in registration order once all of them have
+     * finished, which keeps the result independent of thread timing.
+     */
+    class SystemScheduler {
+    public:
+        typedef void (*Function)(SystemContext &context, void *userData);
+
+        SystemScheduler();
+        ~SystemScheduler();
+
+        SystemScheduler(const SystemScheduler &) = delete;
+        SystemScheduler &operator=(const SystemScheduler &) = delete;
+
+        /**
+         * Adds a system after every system registered so far. Must not be
+         * called while Run() is in progress.
+         * @param name shown in the profiler; must outlive the profiler
+         * @param reads components the system only reads
+         * @param writes components the system writes. A component in both
+         *        sets counts as written.
+         * @return the system's index
+         */
+        uint32_t Register(const char *name, Function function, void *userData, const ComponentMask &reads,
+                          const ComponentMask &writes);
+
+        /**
+         * Runs every system once and plays back their command buffers. Runs
+         * the systems in order on the calling thread when \c jobs isn't running.
+         */
+        void Run(World &world, JobSystem &jobs, float dt);
+
+        uint32_t GetSystemCount() const { return (uint32_t)m_systems.size(); }
+        const char *GetName(uint32_t system) const { return m_systems[system]->name; }
+
+        /**
+         * Gets the systems that must finish before \c system starts
+         */
+        const std::vector<uint32_t> &GetDependencies(uint32_t system) const { return m_systems[system]->dependencies; }
+
+        /**
+         * Gets how long a system took in the last Run(), in nanoseconds
+         */
+        uint64_t GetLastTime(uint32_t system) const { return m_systems[system]->lastNs; }
+
+        /**
+         * Prints every system with what it waits for and why
+         */
+        void PrintSchedule() const;
+
+        /**
+         * Prints the last Run()'s time per system and the total, so the
+         * critical path can be compared with the sum
+         */
+        void PrintTimings() const;
+
+    private:
+        struct System {
+            const char *name;
+            Function function;
+            void *userData;
+            ComponentMask reads;
+            ComponentMask writes;
+
+            // Earlier systems this one conflicts with, and later ones that conflict with it
+            std::vector<uint32_t> dependencies;
+            std::vector<uint32_t> dependents;
+
+            CommandBuffer commands;
+            std::atomic<uint32_t> waitingFor;
+            uint64_t lastNs;
+        };
+
+        struct Frame {
+            World *world;
+            JobSystem *jobs;
+            float dt;
+            JobCounter done;
+        };
+
+        std::vector<std::unique_ptr<System>> m_systems;
+        std::vector<uint32_t> m_roots;
+        Frame *m_frame;
+        uint64_t m_lastRunNs;
+
+        void Execute(uint32_t index);
+        void Submit(uint32_t index);
+    };
+
+}
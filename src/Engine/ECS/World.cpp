@@ -0,0 +1,219 @@
+//
+// Entities and their components, grouped into archetypes.
+//
+
+#include "World.h"
+
+#include "Memory.h"
+
+#include <cstring>
+#include <mutex>
+
+namespace Engine {
+
+    World::World() : m_entityCount(0) {
+        m_empty = GetArchetype(ComponentMask());
+    }
+
+    World::~World() {
+        // Archetypes run the destructors of whatever components are left
+        MemoryTagScope tag(MemoryTag::ECS);
+        m_archetypes.clear();
+    }
+
+    Entity World::Create() {
+        return Allocate(m_empty);
+    }
+
+    Entity World::Allocate(Archetype *archetype) {
+        MemoryTagScope tag(MemoryTag::ECS);
+
+        uint32_t index;
+        if (!m_freeIndices.empty()) {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        } else {
+            index = (uint32_t)m_records.size();
+            m_records.push_back(Record{nullptr, 0, 0, 1});
+        }
+
+        Record &record = m_records[index];
+        Entity entity(index, record.generation);
+        record.archetype = archetype;
+        archetype->AddRow(entity, record.chunk, record.row);
+        m_entityCount++;
+        return entity;
+    }
+
+    void World::Destroy(Entity entity) {
+        if (!IsAlive(entity))
+            return;
+
+        Record &record = m_records[entity.index];
+        record.archetype->DestroyRow(record.chunk, record.row);
+        RemoveRow(record.archetype, record.chunk, record.row);
+
+        // Skip generation 0 on wrap-around so a stale handle never looks null
+        record.archetype = nullptr;
+        record.generation = record.generation < Entity::MAX_GENERATION ? record.generation + 1 : 1;
+        m_freeIndices.push_back(entity.index);
+        m_entityCount--;
+    }
+
+    bool World::IsAlive(Entity entity) const {
+        return entity.index < m_records.size() && m_records[entity.index].generation == entity.generation &&
+               m_records[entity.index].archetype;
+    }
+
+    void *World::GetRaw(Entity entity, ComponentId id) {
+        if (!IsAlive(entity))
+            return nullptr;
+        return GetData(m_records[entity.index], id);
+    }
+
+    void *World::AddRaw(Entity entity, ComponentId id) {
+        if (!IsAlive(entity))
+            return nullptr;
+
+        Record &record = m_records[entity.index];
+        if (record.archetype->GetMask().Has(id))
+            return nullptr;
+
+        Move(entity, GetAddTarget(record.archetype, id));
+        return GetData(record, id);
+    }
+
+    void World::RemoveRaw(Entity entity, ComponentId id) {
+        if (!IsAlive(entity))
+            return;
+
+        Record &record = m_records[entity.index];
+        if (!record.archetype->GetMask().Has(id))
+            return;
+
+        Move(entity, GetRemoveTarget(record.archetype, id));
+    }
+
+    void World::Move(Entity entity, Archetype *target) {
+        MemoryTagScope tag(MemoryTag::ECS);
+
+        Record &record = m_records[entity.index];
+        Archetype *source = record.archetype;
+        Chunk &sourceChunk = *source->GetChunk(record.chunk);
+
+        uint32_t chunk, row;
+        target->AddRow(entity, chunk, row);
+        Chunk &targetChunk = *target->GetChunk(chunk);
+
+        for (uint32_t column = 0; column < source->GetComponentCount(); column++) {
+            ComponentId id = source->GetComponent(column);
+            const ComponentInfo &info = ComponentRegistry::Get(id);
+            void *from = source->GetComponentData(sourceChunk, (int)column, record.row);
+
+            int targetColumn = target->GetColumn(id);
+            if (targetColumn >= 0) {
+                void *to = target->GetComponentData(targetChunk, targetColumn, row);
+                if (info.trivial) {
+                    std::memcpy(to, from, info.size);
+                } else {
+                    info.moveConstruct(to, from);
+                    info.destroy(from);
+                }
+            } else if (!info.trivial) {
+                info.destroy(from);
+            }
+        }
+
+        RemoveRow(source, record.chunk, record.row);
+        record.archetype = target;
+        record.chunk = chunk;
+        record.row = row;
+    }
+
+    void World::RemoveRow(Archetype *archetype, uint32_t chunk, uint32_t row) {
+        Entity moved = archetype->RemoveRow(chunk, row);
+        if (!moved.IsNull()) {
+            m_records[moved.index].chunk = chunk;
+            m_records[moved.index].row = row;
+        }
+    }
+
+    void *World::GetData(const Record &record, ComponentId id) const {
+        int column = record.archetype->GetColumn(id);
+        if (column < 0)
+            return nullptr;
+        return record.archetype->GetComponentData(*record.archetype->GetChunk(record.chunk), column, record.row);
+    }
+
+    Archetype *World::GetArchetype(const ComponentMask &mask) {
+        auto found = m_archetypeByMask.find(mask.GetBits());
+        if (found != m_archetypeByMask.end())
+            return found->second;
+
+        MemoryTagScope tag(MemoryTag::ECS);
+        m_archetypes.emplace_back(new Archetype(mask));
+        Archetype *archetype = m_archetypes.back().get();
+        m_archetypeByMask[mask.GetBits()] = archetype;
+
+        // Keep the cached queries complete so they never need rebuilding
+        for (auto &query : m_queries) {
+            if (mask.Contains(ComponentMask(query.first)))
+                query.second.push_back(archetype);
+        }
+        return archetype;
+    }
+
+    Archetype *World::GetAddTarget(Archetype *archetype, ComponentId id) {
+        Archetype *target = archetype->GetAddEdge(id);
+        if (!target) {
+            ComponentMask mask = archetype->GetMask();
+            mask.Set(id);
+            target = GetArchetype(mask);
+            archetype->SetAddEdge(id, target);
+            target->SetRemoveEdge(id, archetype);
+        }
+        return target;
+    }
+
+    Archetype *World::GetRemoveTarget(Archetype *archetype, ComponentId id) {
+        Archetype *target = archetype->GetRemoveEdge(id);
+        if (!target) {
+            ComponentMask mask = archetype->GetMask();
+            mask.Reset(id);
+            target = GetArchetype(mask);
+            archetype->SetRemoveEdge(id, target);
+            target->SetAddEdge(id, archetype);
+        }
+        return target;
+    }
+
+    const std::vector<Archetype *> &World::GetMatches(const ComponentMask &mask) {
+        {
+            std::shared_lock<std::shared_mutex> lock(m_queryMutex);
+            auto found = m_queries.find(mask.GetBits());
+            if (found != m_queries.end())
+                return found->second;
+        }
+
+        // Rehashing leaves the vectors in place, so references handed out earlier stay valid
+        MemoryTagScope tag(MemoryTag::ECS);
+        std::unique_lock<std::shared_mutex> lock(m_queryMutex);
+        auto inserted = m_queries.emplace(mask.GetBits(), std::vector<Archetype *>());
+        std::vector<Archetype *> &matches = inserted.first->second;
+        if (inserted.second) {
+            for (const std::unique_ptr<Archetype> &archetype : m_archetypes) {
+                if (archetype->GetMask().Contains(mask))
+                    matches.push_back(archetype.get());
+            }
+        }
+        return matches;
+    }
+
+    void World::CollectChunks(const ComponentMask &mask, std::vector<Chunk *> &chunks) {
+        for (Archetype *archetype : GetMatches(mask)) {
+            for (uint32_t c = 0; c < archetype->GetChunkCount(); c++)
+                chunks.push_back(archetype->GetChunk(c));
+        }
+    }
+
+}
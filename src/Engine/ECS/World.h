@@ -0,0 +1,255 @@
+//
+// Entities and their components, grouped into archetypes.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Archetype.h"
+#include "Component.h"
+
+namespace Engine {
+
+    /**
+     * Owns every entity and component. Entities with the same set of
+     * components share an Archetype, so a query walks whole chunks of
+     * tightly packed columns instead of chasing one entity at a time.
+     * Adding or removing a component moves the entity to the neighbouring
+     * archetype, found through cached edges after the first time.
+     *
+     * Structural changes (creating and destroying entities, adding and
+     * removing components) are not thread safe and must not overlap
+     * queries; code running on jobs records them into a CommandBuffer
+     * instead. Queries may run on several threads at once, and component
+     * values may be written from several jobs as long as they touch
+     * different components or chunks.
+     */
+    class World {
+    public:
+        World();
+        ~World();
+
+        World(const World &) = delete;
+        World &operator=(const World &) = delete;
+
+        /**
+         * Creates an entity without components
+         */
+        Entity Create();
+
+        /**
+         * Creates an entity with the given component values, placed straight
+         * into its final archetype
+         */
+        template <typename... Ts>
+        Entity Create(Ts &&... values);
+
+        /**
+         * Destroys an entity and its components. Does nothing if it's already dead.
+         */
+        void Destroy(Entity entity);
+
+        bool IsAlive(Entity entity) const;
+
+        template <typename T>
+        bool Has(Entity entity) const;
+
+        /**
+         * Gets a component of a live entity
+         * @return nullptr if the entity is dead or lacks the component
+         */
+        template <typename T>
+        T *Get(Entity entity);
+
+        /**
+         * Adds a component, or replaces its value if the entity already has it
+         * @return the component, or nullptr if the entity is dead
+         */
+        template <typename T, typename... Args>
+        T *Add(Entity entity, Args &&... args);
+
+        template <typename T>
+        void Remove(Entity entity);
+
+        /**
+         * Gets a component by id
+         * @return nullptr if the entity is dead or lacks the component
+         */
+        void *GetRaw(Entity entity, ComponentId id);
+
+        /**
+         * Adds a component by id without constructing it
+         * @return the uninitialised component, or nullptr if the entity is
+         *         dead or already has it
+         */
+        void *AddRaw(Entity entity, ComponentId id);
+
+        /**
+         * Removes a component by id, destroying it
+         */
+        void RemoveRaw(Entity entity, ComponentId id);
+
+        /**
+         * Calls \c function(Ts &...) for every entity that has all of Ts
+         */
+        template <typename... Ts, typename Function>
+        void Each(Function &&function);
+
+        /**
+         * Calls \c function(count, entities, Ts *...) once per chunk of
+         * entities that have all of Ts, for loops that want the raw columns
+         */
+        template <typename... Ts, typename Function>
+        void EachChunk(Function &&function);
+
+        /**
+         * Appends every non-empty chunk whose archetype contains \c mask, so
+         * jobs can split them between threads
+         */
+        void CollectChunks(const ComponentMask &mask, std::vector<Chunk *> &chunks);
+
+        uint32_t GetEntityCount() const { return m_entityCount; }
+        uint32_t GetArchetypeCount() const { return (uint32_t)m_archetypes.size(); }
+
+    private:
+        struct Record {
+            Archetype *archetype;
+            uint32_t chunk;
+            uint32_t row;
+            uint32_t generation;
+        };
+
+        std::vector<Record> m_records;
+        std::vector<uint32_t> m_freeIndices;
+        uint32_t m_entityCount;
+
+        std::vector<std::unique_ptr<Archetype>> m_archetypes;
+        std::unordered_map<uint64_t, Archetype *> m_archetypeByMask;
+        Archetype *m_empty;
+
+        // Archetypes matching each mask queried so far; new archetypes are appended as they appear.
+        // Queries on different threads may add masks concurrently, hence the lock.
+        std::unordered_map<uint64_t, std::vector<Archetype *>> m_queries;
+        std::shared_mutex m_queryMutex;
+
+        Archetype *GetArchetype(const ComponentMask &mask);
+        Archetype *GetAddTarget(Archetype *archetype, ComponentId id);
+        Archetype *GetRemoveTarget(Archetype *archetype, ComponentId id);
+        const std::vector<Archetype *> &GetMatches(const ComponentMask &mask);
+
+        /**
+         * Takes a free index and places a new entity in \c archetype
+         */
+        Entity Allocate(Archetype *archetype);
+
+        /**
+         * Moves an entity to \c target, carrying over the components both share
+         * and destroying the ones \c target lacks
+         */
+        void Move(Entity entity, Archetype *target);
+
+        /**
+         * Takes a row out of its archetype and fixes the record of the entity moved into its place
+         */
+        void RemoveRow(Archetype *archetype, uint32_t chunk, uint32_t row);
+
+        void *GetData(const Record &record, ComponentId id) const;
+
+        template <typename... Ts, typename Function, size_t... Is>
+        void EachImpl(Function &function, std::index_sequence<Is...>);
+
+        template <typename... Ts, typename Function, size_t... Is>
+        void EachChunkImpl(Function &function, std::index_sequence<Is...>);
+    };
+
+    template <typename... Ts>
+    Entity World::Create(Ts &&... values) {
+        Archetype *archetype = GetArchetype(MakeComponentMask<typename std::decay<Ts>::type...>());
+        Entity entity = Allocate(archetype);
+
+        const Record &record = m_records[entity.index];
+        int dummy[] = {0, (new (GetData(record, GetComponentId<typename std::decay<Ts>::type>()))
+                               typename std::decay<Ts>::type(std::forward<Ts>(values)),
+                           0)...};
+        (void)dummy;
+        return entity;
+    }
+
+    template <typename T>
+    bool World::Has(Entity entity) const {
+        return IsAlive(entity) && m_records[entity.index].archetype->GetMask().Has(GetComponentId<T>());
+    }
+
+    template <typename T>
+    T *World::Get(Entity entity) {
+        return static_cast<T *>(GetRaw(entity, GetComponentId<T>()));
+    }
+
+    template <typename T, typename... Args>
+    T *World::Add(Entity entity, Args &&... args) {
+        if (!IsAlive(entity))
+            return nullptr;
+
+        ComponentId id = GetComponentId<T>();
+        if (T *existing = static_cast<T *>(GetData(m_records[entity.index], id))) {
+            *existing = T(std::forward<Args>(args)...);
+            return existing;
+        }
+        return new (AddRaw(entity, id)) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void World::Remove(Entity entity) {
+        RemoveRaw(entity, GetComponentId<T>());
+    }
+
+    template <typename... Ts, typename Function>
+    void World::Each(Function &&function) {
+        EachImpl<Ts...>(function, std::index_sequence_for<Ts...>());
+    }
+
+    template <typename... Ts, typename Function, size_t... Is>
+    void World::EachImpl(Function &function, std::index_sequence<Is...>) {
+        const ComponentId ids[] = {GetComponentId<Ts>()..., 0};
+        for (Archetype *archetype : GetMatches(MakeComponentMask<Ts...>())) {
+            // Resolve the columns once per archetype, not once per chunk
+            const int columns[] = {archetype->GetColumn(ids[Is])..., 0};
+            for (uint32_t c = 0; c < archetype->GetChunkCount(); c++) {
+                const Chunk &chunk = *archetype->GetChunk(c);
+                std::tuple<Ts *...> data(static_cast<Ts *>(archetype->GetColumnData(chunk, columns[Is]))...);
+                for (uint32_t i = 0; i < chunk.count; i++)
+                    function(std::get<Is>(data)[i]...);
+            }
+        }
+        (void)ids;
+    }
+
+    template <typename... Ts, typename Function>
+    void World::EachChunk(Function &&function) {
+        EachChunkImpl<Ts...>(function, std::index_sequence_for<Ts...>());
+    }
+
+    template <typename... Ts, typename Function, size_t... Is>
+    void World::EachChunkImpl(Function &function, std::index_sequence<Is...>) {
+        const ComponentId ids[] = {GetComponentId<Ts>()..., 0};
+        for (Archetype *archetype : GetMatches(MakeComponentMask<Ts...>())) {
+            const int columns[] = {archetype->GetColumn(ids[Is])..., 0};
+            for (uint32_t c = 0; c < archetype->GetChunkCount(); c++) {
+                const Chunk &chunk = *archetype->GetChunk(c);
+                if (chunk.count) {
+                    function(chunk.count, static_cast<const Entity *>(chunk.GetEntities()),
+                             static_cast<Ts *>(archetype->GetColumnData(chunk, columns[Is]))...);
+                }
+            }
+        }
+        (void)ids;
+    }
+
+}
@@ -0,0 +1,87 @@
+//
+// Drains SDL's event queue in batches and dispatches events by type.
+//
+
+#include "EventDispatcher.h"
+
+namespace Engine {
+
+    EventDispatcher::EventDispatcher() : m_globalCount(0) {
+        for (Category &category : m_categories)
+            category.count = 0;
+    }
+
+    int EventDispatcher::GetCategory(Uint32 type) {
+        int category = (int)(type >> 8);
+        return category < CATEGORY_COUNT ? category : CATEGORY_COUNT - 1;
+    }
+
+    bool EventDispatcher::Subscribe(Uint32 type, Handler handler, void *userData) {
+        Category &category = m_categories[GetCategory(type)];
+        if (category.count == MAX_HANDLERS_PER_CATEGORY)
+            return false;
+
+        category.handlers[category.count++] = {type, handler, userData};
+        return true;
+    }
+
+    bool EventDispatcher::SubscribeAll(Handler handler, void *userData) {
+        if (m_globalCount == MAX_GLOBAL_HANDLERS)
+            return false;
+
+        m_globalHandlers[m_globalCount++] = {0, handler, userData};
+        return true;
+    }
+
+    int EventDispatcher::Remove(Subscription *subscriptions, int count, Handler handler, void *userData) {
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (subscriptions[i].handler != handler || subscriptions[i].userData != userData)
+                subscriptions[kept++] = subscriptions[i];
+        }
+        return kept;
+    }
+
+    void EventDispatcher::Unsubscribe(Handler handler, void *userData) {
+        for (Category &category : m_categories)
+            category.count = Remove(category.handlers, category.count, handler, userData);
+
+        m_globalCount = Remove(m_globalHandlers, m_globalCount, handler, userData);
+    }
+
+    void EventDispatcher::Pump() {
+        SDL_PumpEvents();
+    }
+
+    int EventDispatcher::Dispatch() {
+        int total = 0;
+
+        for (;;) {
+            int count = SDL_PeepEvents(m_batch, BATCH_SIZE, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+            if (count <= 0)
+                break;
+
+            for (int i = 0; i < count; i++) {
+                const SDL_Event &event = m_batch[i];
+
+                for (int h = 0; h < m_globalCount; h++)
+                    m_globalHandlers[h].handler(event, m_globalHandlers[h].userData);
+
+                const Category &category = m_categories[GetCategory(event.type)];
+                for (int h = 0; h < category.count; h++) {
+                    const Subscription &subscription = category.handlers[h];
+                    if (subscription.type == event.type)
+                        subscription.handler(event, subscription.userData);
+                }
+            }
+
+            total += count;
+
+            // A partial batch means the queue is empty
+            if (count < BATCH_SIZE)
+                break;
+        }
+
+        return total;
+    }
+}
@@ -0,0 +1,82 @@
+//
+// Drains SDL's event queue in batches and dispatches events by type.
+//
+
+#pragma once
+
+#include "ThirdParty/SDL/include/SDL_events.h"
+
+namespace Engine {
+
+    /**
+     * Pumps SDL once per frame and pulls the queued events out in bulk
+     * with SDL_PeepEvents, taking SDL's queue lock once per batch instead
+     * of once per event. Each event is then handed to the plain function
+     * handlers subscribed to its type. All storage is fixed-size, so
+     * dispatching never allocates.
+     */
+    class EventDispatcher {
+    public:
+        typedef void (*Handler)(const SDL_Event &event, void *userData);
+
+        static const int BATCH_SIZE = 256;
+        static const int MAX_HANDLERS_PER_CATEGORY = 8;
+        static const int MAX_GLOBAL_HANDLERS = 4;
+
+        EventDispatcher();
+
+        /**
+         * Calls \c handler for every event of exactly \c type
+         * @return false if the type's category has no free handler slot
+         */
+        bool Subscribe(Uint32 type, Handler handler, void *userData);
+
+        /**
+         * Calls \c handler for every event, before the typed handlers
+         * @return false if there is no free slot
+         */
+        bool SubscribeAll(Handler handler, void *userData);
+
+        /**
+         * Removes every subscription of \c handler with \c userData
+         */
+        void Unsubscribe(Handler handler, void *userData);
+
+        /**
+         * Gathers pending OS events into SDL's queue
+         */
+        void Pump();
+
+        /**
+         * Removes every queued event, in batches, and dispatches it.
+         * Does not pump, so events can be injected between Pump() and Dispatch().
+         * @return the number of events dispatched
+         */
+        int Dispatch();
+
+    private:
+        // SDL groups related event types in blocks of 0x100, USEREVENT and
+        // above all land in the last category
+        static const int CATEGORY_COUNT = (SDL_USEREVENT >> 8) + 1;
+
+        struct Subscription {
+            Uint32 type;
+            Handler handler;
+            void *userData;
+        };
+
+        struct Category {
+            Subscription handlers[MAX_HANDLERS_PER_CATEGORY];
+            int count;
+        };
+
+        static int GetCategory(Uint32 type);
+        static int Remove(Subscription *subscriptions, int count, Handler handler, void *userData);
+
+        Category m_categories[CATEGORY_COUNT];
+        Subscription m_globalHandlers[MAX_GLOBAL_HANDLERS];
+        int m_globalCount;
+        SDL_Event m_batch[BATCH_SIZE];
+    };
+
+}
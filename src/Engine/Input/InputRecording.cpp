@@ -0,0 +1,215 @@
+//
+// Records SDL input to a file and replays it frame by frame.
+//
+
+#include "InputRecording.h"
+
+#include "ThirdParty/SDL/include/SDL_log.h"
+
+#include <cstring>
+
+namespace Engine {
+
+    namespace {
+
+        const char RECORDING_MAGIC[4] = {'O', 'G', 'T', 'R'};
+        // 2 widened the event count of a frame from 16 to 32 bits
+        const uint32_t RECORDING_VERSION = 2;
+
+        template <typename T>
+        void Write(std::FILE *file, const T &value) {
+            std::fwrite(&value, sizeof(T), 1, file);
+        }
+
+        template <typename T>
+        bool Read(std::FILE *file, T &value) {
+            return std::fread(&value, sizeof(T), 1, file) == 1;
+        }
+
+        bool IsReplayable(Uint32 type) {
+            switch (type) {
+                case SDL_SYSWMEVENT:
+                case SDL_DROPFILE:
+                case SDL_DROPTEXT:
+                case SDL_DROPBEGIN:
+                case SDL_DROPCOMPLETE:
+                    return false;
+                default:
+                    return type < SDL_USEREVENT;
+            }
+        }
+
+        /**
+         * Gets how many bytes of the SDL_Event union an event type uses
+         */
+        size_t GetEventSize(Uint32 type) {
+            switch (type) {
+                case SDL_WINDOWEVENT:
+                    return sizeof(SDL_WindowEvent);
+                case SDL_KEYDOWN:
+                case SDL_KEYUP:
+                    return sizeof(SDL_KeyboardEvent);
+                case SDL_TEXTEDITING:
+                    return sizeof(SDL_TextEditingEvent);
+                case SDL_TEXTINPUT:
+                    return sizeof(SDL_TextInputEvent);
+                case SDL_MOUSEMOTION:
+                    return sizeof(SDL_MouseMotionEvent);
+                case SDL_MOUSEBUTTONDOWN:
+                case SDL_MOUSEBUTTONUP:
+                    return sizeof(SDL_MouseButtonEvent);
+                case SDL_MOUSEWHEEL:
+                    return sizeof(SDL_MouseWheelEvent);
+                case SDL_JOYAXISMOTION:
+                    return sizeof(SDL_JoyAxisEvent);
+                case SDL_JOYBUTTONDOWN:
+                case SDL_JOYBUTTONUP:
+                    return sizeof(SDL_JoyButtonEvent);
+                case SDL_CONTROLLERAXISMOTION:
+                    return sizeof(SDL_ControllerAxisEvent);
+                case SDL_CONTROLLERBUTTONDOWN:
+                case SDL_CONTROLLERBUTTONUP:
+                    return sizeof(SDL_ControllerButtonEvent);
+                case SDL_FINGERDOWN:
+                case SDL_FINGERUP:
+                case SDL_FINGERMOTION:
+                    return sizeof(SDL_TouchFingerEvent);
+                case SDL_QUIT:
+                    return sizeof(SDL_QuitEvent);
+                default:
+                    return sizeof(SDL_Event);
+            }
+        }
+    }
+
+    InputRecorder::InputRecorder() : m_file(nullptr) {
+    }
+
+    InputRecorder::~InputRecorder() {
+        Close();
+    }
+
+    bool InputRecorder::Open(const char *path) {
+        Close();
+
+        m_file = std::fopen(path, "wb");
+        if (!m_file) {
+            SDL_Log("Unable to open input recording %s", path);
+            return false;
+        }
+
+        std::fwrite(RECORDING_MAGIC, sizeof(RECORDING_MAGIC), 1, m_file);
+        Write(m_file, RECORDING_VERSION);
+        Write(m_file, (uint32_t)sizeof(SDL_Event));
+        return true;
+    }
+
+    void InputRecorder::Close() {
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+        m_events.clear();
+    }
+
+    void InputRecorder::RecordEvent(const SDL_Event &event) {
+        if (m_file && IsReplayable(event.type))
+            m_events.push_back(event);
+    }
+
+    void InputRecorder::EndFrame(uint32_t frame, int steps, uint32_t checksum) {
+        if (!m_file)
+            return;
+
+        Write(m_file, frame);
+        Write(m_file, (uint8_t)steps);
+        Write(m_file, checksum);
+        Write(m_file, (uint32_t)m_events.size());
+
+        for (const SDL_Event &event : m_events) {
+            uint16_t size = (uint16_t)GetEventSize(event.type);
+            Write(m_file, size);
+            std::fwrite(&event, size, 1, m_file);
+        }
+
+        m_events.clear();
+    }
+
+    InputReplayer::InputReplayer()
+            : m_file(nullptr), m_frame(0), m_checksum(0), m_steps(0), m_divergentFrames(0) {
+    }
+
+    InputReplayer::~InputReplayer() {
+        Close();
+    }
+
+    bool InputReplayer::Open(const char *path) {
+        Close();
+
+        m_file = std::fopen(path, "rb");
+        if (!m_file) {
+            SDL_Log("Unable to open input recording %s", path);
+            return false;
+        }
+
+        char magic[sizeof(RECORDING_MAGIC)];
+        uint32_t version = 0;
+        uint32_t eventSize = 0;
+        if (std::fread(magic, sizeof(magic), 1, m_file) != 1 || std::memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0 ||
+            !Read(m_file, version) || version != RECORDING_VERSION ||
+            !Read(m_file, eventSize) || eventSize != sizeof(SDL_Event)) {
+            SDL_Log("%s is not an input recording made by this build", path);
+            Close();
+            return false;
+        }
+
+        m_divergentFrames = 0;
+        return true;
+    }
+
+    void InputReplayer::Close() {
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+    bool InputReplayer::BeginFrame(uint32_t frame) {
+        if (!m_file)
+            return false;
+
+        uint8_t steps = 0;
+        uint32_t count = 0;
+        if (!Read(m_file, m_frame) || !Read(m_file, steps) || !Read(m_file, m_checksum) || !Read(m_file, count))
+            return false;
+
+        if (m_frame != frame)
+            SDL_Log("Input replay expected frame %u but the recording holds frame %u", frame, m_frame);
+
+        m_steps = steps;
+        m_events.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            SDL_Event &event = m_events[i];
+            std::memset(&event, 0, sizeof(event));
+
+            uint16_t size = 0;
+            if (!Read(m_file, size) || size > sizeof(SDL_Event) || std::fread(&event, size, 1, m_file) != 1)
+                return false;
+        }
+
+        if (count > 0)
+            SDL_PeepEvents(m_events.data(), (int)count, SDL_ADDEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+        return true;
+    }
+
+    bool InputReplayer::CheckFrame(uint32_t checksum) {
+        if (checksum == m_checksum)
+            return true;
+
+        if (m_divergentFrames++ == 0)
+            SDL_Log("Input replay diverged at frame %u: state checksum %08x, recorded %08x",
+                    m_frame, checksum, m_checksum);
+        return false;
+    }
+}
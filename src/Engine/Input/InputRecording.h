@@ -0,0 +1,98 @@
+//
+// Records SDL input to a file and replays it frame by frame.
+//
+
+#pragma once
+
+#include "ThirdParty/SDL/include/SDL_events.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace Engine {
+
+    /**
+     * Writes every input event of a run, tagged with the frame it was
+     * handled in, along with the number of simulation steps and a
+     * checksum of the game state at the end of each frame.
+     *
+     * The file starts with a header followed by one record per frame:
+     *   uint32 frame, uint8 steps, uint32 checksum, uint32 event count,
+     *   then per event: uint16 size and the first \c size bytes of the SDL_Event.
+     * Only the part of the union used by each event type is stored.
+     * Values use the host byte order; recordings are meant to be replayed
+     * by the same build that made them.
+     */
+    class InputRecorder {
+    public:
+        InputRecorder();
+        ~InputRecorder();
+
+        bool Open(const char *path);
+        void Close();
+        bool IsOpen() const { return m_file != nullptr; }
+
+        /**
+         * Adds an event handled during the current frame. Events carrying
+         * pointers (drops, user and window manager events) cannot be
+         * replayed and are skipped.
+         */
+        void RecordEvent(const SDL_Event &event);
+
+        /**
+         * Writes the record of the frame that just ended
+         */
+        void EndFrame(uint32_t frame, int steps, uint32_t checksum);
+
+    private:
+        std::FILE *m_file;
+        std::vector<SDL_Event> m_events;
+    };
+
+    /**
+     * Plays a recording back by injecting its events into SDL's queue at
+     * the frame they were recorded in, and reports frames whose state
+     * checksum differs from the recording.
+     */
+    class InputReplayer {
+    public:
+        InputReplayer();
+        ~InputReplayer();
+
+        bool Open(const char *path);
+        void Close();
+        bool IsOpen() const { return m_file != nullptr; }
+
+        /**
+         * Reads the record of the next frame and queues its events with
+         * SDL_PeepEvents so they keep their original timestamps. Live
+         * input must be flushed by the caller beforehand.
+         * @return false once the recording is exhausted
+         */
+        bool BeginFrame(uint32_t frame);
+
+        /**
+         * Gets the number of simulation steps the current frame ran when recorded
+         */
+        int GetSteps() const { return m_steps; }
+
+        /**
+         * Compares the game state checksum at the end of the current frame
+         * with the recording. The first divergence is logged.
+         * @return true if the checksums match
+         */
+        bool CheckFrame(uint32_t checksum);
+
+        uint32_t GetDivergentFrames() const { return m_divergentFrames; }
+
+    private:
+        std::FILE *m_file;
+        std::vector<SDL_Event> m_events;
+        uint32_t m_frame;
+        uint32_t m_checksum;
+        int m_steps;
+        uint32_t m_divergentFrames;
+    };
+
+}
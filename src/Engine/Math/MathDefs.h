@@ -0,0 +1,38 @@
+//
+// Common math constants and helpers shared by the vector and matrix types.
+//
+
+#pragma once
+
+#include <cmath>
+
+namespace Engine {
+
+    constexpr float M_PI_F = 3.14159265358979323846f;
+    constexpr float M_EPSILON = 0.000001f;
+    constexpr float M_DEG_TO_RAD = M_PI_F / 180.0f;
+    constexpr float M_RAD_TO_DEG = 180.0f / M_PI_F;
+
+    /**
+     * Checks whether two floats are equal within an epsilon
+     */
+    constexpr bool Equals(float lhs, float rhs, float epsilon = M_EPSILON) {
+        return lhs + epsilon >= rhs && lhs - epsilon <= rhs;
+    }
+
+    /**
+     * Linear interpolation between two values
+     * @param t the blend factor, 0 returns \c lhs and 1 returns \c rhs
+     */
+    constexpr float Lerp(float lhs, float rhs, float t) {
+        return lhs + (rhs - lhs) * t;
+    }
+
+    /**
+     * Clamps a value to the range [min, max]
+     */
+    constexpr float Clamp(float value, float min, float max) {
+        return value < min ? min : (value > max ? max : value);
+    }
+
+}
@@ -0,0 +1,123 @@
+//
+// 3x3 matrix for rotations and scales, stored column-major.
+//
+
+#pragma once
+
+#include "MathDefs.h"
+#include "Vector3.h"
+
+namespace Engine {
+
+    /**
+     * Represents a linear transform in 3D space.
+     * Constructor arguments are given row by row; storage is column-major as OpenGL expects.
+     */
+    class Matrix3 {
+    private:
+        float m_data[9];
+
+    public:
+        constexpr Matrix3() : m_data{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f} {}
+
+        constexpr Matrix3(float m00, float m01, float m02,
+                          float m10, float m11, float m12,
+                          float m20, float m21, float m22)
+            : m_data{m00, m10, m20, m01, m11, m21, m02, m12, m22} {}
+
+        static const Matrix3 IDENTITY;
+        static const Matrix3 ZERO;
+
+        /**
+         * Gets the element at a row and column
+         */
+        constexpr float Get(int row, int column) const { return m_data[column * 3 + row]; }
+
+        void Set(int row, int column, float value) { m_data[column * 3 + row] = value; }
+
+        constexpr Vector3 GetColumn(int column) const {
+            return Vector3(m_data[column * 3], m_data[column * 3 + 1], m_data[column * 3 + 2]);
+        }
+
+        /**
+         * Gets the elements as a contiguous column-major array of nine floats
+         */
+        const float *Data() const { return m_data; }
+
+        constexpr Vector3 operator*(const Vector3 &rhs) const {
+            return GetColumn(0) * rhs.GetX() + GetColumn(1) * rhs.GetY() + GetColumn(2) * rhs.GetZ();
+        }
+
+        constexpr Matrix3 operator*(const Matrix3 &rhs) const {
+            return FromColumns(*this * rhs.GetColumn(0), *this * rhs.GetColumn(1), *this * rhs.GetColumn(2));
+        }
+
+        constexpr Matrix3 operator*(float rhs) const {
+            return Matrix3(Get(0, 0) * rhs, Get(0, 1) * rhs, Get(0, 2) * rhs,
+                           Get(1, 0) * rhs, Get(1, 1) * rhs, Get(1, 2) * rhs,
+                           Get(2, 0) * rhs, Get(2, 1) * rhs, Get(2, 2) * rhs);
+        }
+
+        constexpr bool operator==(const Matrix3 &rhs) const {
+            for (int i = 0; i < 9; i++)
+                if (m_data[i] != rhs.m_data[i])
+                    return false;
+            return true;
+        }
+        constexpr bool operator!=(const Matrix3 &rhs) const { return !(*this == rhs); }
+
+        constexpr Matrix3 Transposed() const {
+            return Matrix3(Get(0, 0), Get(1, 0), Get(2, 0),
+                           Get(0, 1), Get(1, 1), Get(2, 1),
+                           Get(0, 2), Get(1, 2), Get(2, 2));
+        }
+
+        constexpr float Determinant() const {
+            return GetColumn(0).Dot(GetColumn(1).Cross(GetColumn(2)));
+        }
+
+        /**
+         * Returns the inverse matrix, or a zero matrix if this one is singular
+         */
+        constexpr Matrix3 Inverse() const {
+            // The rows of the inverse are the cross products of the columns, over the determinant
+            Vector3 r0 = GetColumn(1).Cross(GetColumn(2));
+            Vector3 r1 = GetColumn(2).Cross(GetColumn(0));
+            Vector3 r2 = GetColumn(0).Cross(GetColumn(1));
+            float det = GetColumn(0).Dot(r0);
+            if (det == 0.0f)
+                return Matrix3(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+            float invDet = 1.0f / det;
+            return Matrix3(r0.GetX() * invDet, r0.GetY() * invDet, r0.GetZ() * invDet,
+                           r1.GetX() * invDet, r1.GetY() * invDet, r1.GetZ() * invDet,
+                           r2.GetX() * invDet, r2.GetY() * invDet, r2.GetZ() * invDet);
+        }
+
+        /**
+         * Checks equality with another matrix within an epsilon
+         */
+        constexpr bool Equals(const Matrix3 &rhs) const {
+            for (int i = 0; i < 9; i++)
+                if (!Engine::Equals(m_data[i], rhs.m_data[i]))
+                    return false;
+            return true;
+        }
+
+        static constexpr Matrix3 FromColumns(const Vector3 &c0, const Vector3 &c1, const Vector3 &c2) {
+            return Matrix3(c0.GetX(), c1.GetX(), c2.GetX(),
+                           c0.GetY(), c1.GetY(), c2.GetY(),
+                           c0.GetZ(), c1.GetZ(), c2.GetZ());
+        }
+
+        static constexpr Matrix3 Scale(const Vector3 &scale) {
+            return Matrix3(scale.GetX(), 0.0f, 0.0f,
+                           0.0f, scale.GetY(), 0.0f,
+                           0.0f, 0.0f, scale.GetZ());
+        }
+    };
+
+    inline constexpr Matrix3 Matrix3::IDENTITY;
+    inline constexpr Matrix3 Matrix3::ZERO(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+}
@@ -0,0 +1,249 @@
+//
+// 4x4 matrix for affine and projective transforms, stored column-major
+// with each column in one SIMD register's worth of floats.
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include "MathDefs.h"
+#include "Matrix3.h"
+#include "Quaternion.h"
+#include "Simd.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace Engine {
+
+    /**
+     * Represents a transform in homogeneous coordinates.
+     * Constructor arguments are given row by row; storage is column-major as OpenGL expects,
+     * so \c Data() can be passed to glUniformMatrix4fv without transposing.
+     */
+    class alignas(16) Matrix4 {
+    private:
+        float m_data[16];
+
+    public:
+        constexpr Matrix4()
+            : m_data{1.0f, 0.0f, 0.0f, 0.0f,
+                     0.0f, 1.0f, 0.0f, 0.0f,
+                     0.0f, 0.0f, 1.0f, 0.0f,
+                     0.0f, 0.0f, 0.0f, 1.0f} {}
+
+        constexpr Matrix4(float m00, float m01, float m02, float m03,
+                          float m10, float m11, float m12, float m13,
+                          float m20, float m21, float m22, float m23,
+                          float m30, float m31, float m32, float m33)
+            : m_data{m00, m10, m20, m30,
+                     m01, m11, m21, m31,
+                     m02, m12, m22, m32,
+                     m03, m13, m23, m33} {}
+
+        /**
+         * Expands a linear transform, with no translation
+         */
+        constexpr explicit Matrix4(const Matrix3 &m)
+            : Matrix4(m.Get(0, 0), m.Get(0, 1), m.Get(0, 2), 0.0f,
+                      m.Get(1, 0), m.Get(1, 1), m.Get(1, 2), 0.0f,
+                      m.Get(2, 0), m.Get(2, 1), m.Get(2, 2), 0.0f,
+                      0.0f, 0.0f, 0.0f, 1.0f) {}
+
+        static const Matrix4 IDENTITY;
+        static const Matrix4 ZERO;
+
+        /**
+         * Gets the element at a row and column
+         */
+        constexpr float Get(int row, int column) const { return m_data[column * 4 + row]; }
+
+        void Set(int row, int column, float value) { m_data[column * 4 + row] = value; }
+
+        constexpr Vector4 GetColumn(int column) const {
+            return Vector4(m_data[column * 4], m_data[column * 4 + 1], m_data[column * 4 + 2], m_data[column * 4 + 3]);
+        }
+
+        void SetColumn(int column, const Vector4 &value) { Simd::Store(m_data + column * 4, value.Load()); }
+
+        /**
+         * Gets the elements as a contiguous column-major array of sixteen floats
+         */
+        const float *Data() const { return m_data; }
+
+        Simd::Float4 LoadColumn(int column) const { return Simd::Load(m_data + column * 4); }
+
+        Vector4 operator*(const Vector4 &rhs) const {
+            return Vector4(Transform(LoadColumn(0), LoadColumn(1), LoadColumn(2), LoadColumn(3), rhs.Load()));
+        }
+
+        Matrix4 operator*(const Matrix4 &rhs) const {
+            Simd::Float4 c0 = LoadColumn(0), c1 = LoadColumn(1), c2 = LoadColumn(2), c3 = LoadColumn(3);
+
+            Matrix4 result;
+            for (int i = 0; i < 4; i++)
+                Simd::Store(result.m_data + i * 4, Transform(c0, c1, c2, c3, rhs.LoadColumn(i)));
+            return result;
+        }
+
+        Matrix4 &operator*=(const Matrix4 &rhs) { return *this = *this * rhs; }
+
+        constexpr bool operator==(const Matrix4 &rhs) const {
+            for (int i = 0; i < 16; i++)
+                if (m_data[i] != rhs.m_data[i])
+                    return false;
+            return true;
+        }
+        constexpr bool operator!=(const Matrix4 &rhs) const { return !(*this == rhs); }
+
+        /**
+         * Transforms a point, treating it as having w = 1 and ignoring any projection
+         */
+        Vector3 TransformPoint(const Vector3 &point) const { return (*this * Vector4(point, 1.0f)).ToVector3(); }
+
+        /**
+         * Transforms a direction, ignoring translation
+         */
+        Vector3 TransformDirection(const Vector3 &direction) const {
+            return (*this * Vector4(direction, 0.0f)).ToVector3();
+        }
+
+        /**
+         * Transforms an array of vectors, keeping the matrix columns in registers across the loop
+         * @param in the vectors to transform
+         * @param out where to write the results, may be the same array as \c in
+         * @param count the number of vectors in both arrays
+         */
+        void Transform(const Vector4 *in, Vector4 *out, size_t count) const {
+            Simd::Float4 c0 = LoadColumn(0), c1 = LoadColumn(1), c2 = LoadColumn(2), c3 = LoadColumn(3);
+            for (size_t i = 0; i < count; i++)
+                out[i] = Vector4(Transform(c0, c1, c2, c3, in[i].Load()));
+        }
+
+        constexpr Matrix4 Transposed() const {
+            return Matrix4(Get(0, 0), Get(1, 0), Get(2, 0), Get(3, 0),
+                           Get(0, 1), Get(1, 1), Get(2, 1), Get(3, 1),
+                           Get(0, 2), Get(1, 2), Get(2, 2), Get(3, 2),
+                           Get(0, 3), Get(1, 3), Get(2, 3), Get(3, 3));
+        }
+
+        /**
+         * Returns the inverse matrix, or a zero matrix if this one is singular
+         */
+        constexpr Matrix4 Inverse() const {
+            // Cofactor expansion over 2x2 sub-determinants of the top and bottom row pairs
+            float s0 = Get(0, 0) * Get(1, 1) - Get(1, 0) * Get(0, 1);
+            float s1 = Get(0, 0) * Get(1, 2) - Get(1, 0) * Get(0, 2);
+            float s2 = Get(0, 0) * Get(1, 3) - Get(1, 0) * Get(0, 3);
+            float s3 = Get(0, 1) * Get(1, 2) - Get(1, 1) * Get(0, 2);
+            float s4 = Get(0, 1) * Get(1, 3) - Get(1, 1) * Get(0, 3);
+            float s5 = Get(0, 2) * Get(1, 3) - Get(1, 2) * Get(0, 3);
+
+            float c5 = Get(2, 2) * Get(3, 3) - Get(3, 2) * Get(2, 3);
+            float c4 = Get(2, 1) * Get(3, 3) - Get(3, 1) * Get(2, 3);
+            float c3 = Get(2, 1) * Get(3, 2) - Get(3, 1) * Get(2, 2);
+            float c2 = Get(2, 0) * Get(3, 3) - Get(3, 0) * Get(2, 3);
+            float c1 = Get(2, 0) * Get(3, 2) - Get(3, 0) * Get(2, 2);
+            float c0 = Get(2, 0) * Get(3, 1) - Get(3, 0) * Get(2, 1);
+
+            float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+            if (det == 0.0f)
+                return Matrix4(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                               0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+            float invDet = 1.0f / det;
+            return Matrix4(
+                (Get(1, 1) * c5 - Get(1, 2) * c4 + Get(1, 3) * c3) * invDet,
+                (-Get(0, 1) * c5 + Get(0, 2) * c4 - Get(0, 3) * c3) * invDet,
+                (Get(3, 1) * s5 - Get(3, 2) * s4 + Get(3, 3) * s3) * invDet,
+                (-Get(2, 1) * s5 + Get(2, 2) * s4 - Get(2, 3) * s3) * invDet,
+
+                (-Get(1, 0) * c5 + Get(1, 2) * c2 - Get(1, 3) * c1) * invDet,
+                (Get(0, 0) * c5 - Get(0, 2) * c2 + Get(0, 3) * c1) * invDet,
+                (-Get(3, 0) * s5 + Get(3, 2) * s2 - Get(3, 3) * s1) * invDet,
+                (Get(2, 0) * s5 - Get(2, 2) * s2 + Get(2, 3) * s1) * invDet,
+
+                (Get(1, 0) * c4 - Get(1, 1) * c2 + Get(1, 3) * c0) * invDet,
+                (-Get(0, 0) * c4 + Get(0, 1) * c2 - Get(0, 3) * c0) * invDet,
+                (Get(3, 0) * s4 - Get(3, 1) * s2 + Get(3, 3) * s0) * invDet,
+                (-Get(2, 0) * s4 + Get(2, 1) * s2 - Get(2, 3) * s0) * invDet,
+
+                (-Get(1, 0) * c3 + Get(1, 1) * c1 - Get(1, 2) * c0) * invDet,
+                (Get(0, 0) * c3 - Get(0, 1) * c1 + Get(0, 2) * c0) * invDet,
+                (-Get(3, 0) * s3 + Get(3, 1) * s1 - Get(3, 2) * s0) * invDet,
+                (Get(2, 0) * s3 - Get(2, 1) * s1 + Get(2, 2) * s0) * invDet);
+        }
+
+        /**
+         * Checks equality with another matrix within an epsilon
+         */
+        constexpr bool Equals(const Matrix4 &rhs) const {
+            for (int i = 0; i < 16; i++)
+                if (!Engine::Equals(m_data[i], rhs.m_data[i]))
+                    return false;
+            return true;
+        }
+
+        static constexpr Matrix4 Translation(const Vector3 &offset) {
+            return Matrix4(1.0f, 0.0f, 0.0f, offset.GetX(),
+                           0.0f, 1.0f, 0.0f, offset.GetY(),
+                           0.0f, 0.0f, 1.0f, offset.GetZ(),
+                           0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+        static constexpr Matrix4 Scale(const Vector3 &scale) { return Matrix4(Matrix3::Scale(scale)); }
+
+        static constexpr Matrix4 Rotation(const Quaternion &rotation) { return Matrix4(rotation.RotationMatrix()); }
+
+        /**
+         * Composes translation, rotation and scale, applied to points in reverse order
+         */
+        static constexpr Matrix4 TRS(const Vector3 &translation, const Quaternion &rotation, const Vector3 &scale) {
+            return Matrix4(rotation.RotationMatrix() * Matrix3::Scale(scale)).WithTranslation(translation);
+        }
+
+        /**
+         * Right-handed perspective projection into OpenGL's [-1, 1] clip space
+         * @param fovY the vertical field of view, in radians
+         */
+        static Matrix4 Perspective(float fovY, float aspect, float zNear, float zFar) {
+            float f = 1.0f / std::tan(fovY * 0.5f);
+            float range = 1.0f / (zNear - zFar);
+            return Matrix4(f / aspect, 0.0f, 0.0f, 0.0f,
+                           0.0f, f, 0.0f, 0.0f,
+                           0.0f, 0.0f, (zFar + zNear) * range, 2.0f * zFar * zNear * range,
+                           0.0f, 0.0f, -1.0f, 0.0f);
+        }
+
+        /**
+         * Orthographic projection into OpenGL's [-1, 1] clip space
+         */
+        static constexpr Matrix4 Orthographic(float left, float right, float bottom, float top, float zNear, float zFar) {
+            return Matrix4(2.0f / (right - left), 0.0f, 0.0f, -(right + left) / (right - left),
+                           0.0f, 2.0f / (top - bottom), 0.0f, -(top + bottom) / (top - bottom),
+                           0.0f, 0.0f, -2.0f / (zFar - zNear), -(zFar + zNear) / (zFar - zNear),
+                           0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+    private:
+        constexpr Matrix4 WithTranslation(const Vector3 &offset) const {
+            return Matrix4(Get(0, 0), Get(0, 1), Get(0, 2), offset.GetX(),
+                           Get(1, 0), Get(1, 1), Get(1, 2), offset.GetY(),
+                           Get(2, 0), Get(2, 1), Get(2, 2), offset.GetZ(),
+                           Get(3, 0), Get(3, 1), Get(3, 2), Get(3, 3));
+        }
+
+        static Simd::Float4 Transform(Simd::Float4 c0, Simd::Float4 c1, Simd::Float4 c2, Simd::Float4 c3,
+                                      Simd::Float4 v) {
+            Simd::Float4 result = Simd::Mul(c0, Simd::SplatLane<0>(v));
+            result = Simd::MulAdd(c1, Simd::SplatLane<1>(v), result);
+            result = Simd::MulAdd(c2, Simd::SplatLane<2>(v), result);
+            return Simd::MulAdd(c3, Simd::SplatLane<3>(v), result);
+        }
+    };
+
+    inline constexpr Matrix4 Matrix4::IDENTITY;
+    inline constexpr Matrix4 Matrix4::ZERO(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                                           0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+}
@@ -0,0 +1,140 @@
+//
+// Rotation quaternion stored as (x, y, z, w) in one SIMD register's worth of floats.
+//
+
+#pragma once
+
+#include "MathDefs.h"
+#include "Matrix3.h"
+#include "Simd.h"
+#include "Vector3.h"
+
+namespace Engine {
+
+    /**
+     * Represents an orientation in 3D space.
+     */
+    class alignas(16) Quaternion {
+    private:
+        float m_data[4];
+
+    public:
+        constexpr Quaternion() : m_data{0.0f, 0.0f, 0.0f, 1.0f} {}
+        constexpr Quaternion(float x, float y, float z, float w) : m_data{x, y, z, w} {}
+
+        explicit Quaternion(Simd::Float4 v) { Simd::Store(m_data, v); }
+
+        static const Quaternion IDENTITY;
+
+        constexpr float GetX() const { return m_data[0]; }
+        constexpr float GetY() const { return m_data[1]; }
+        constexpr float GetZ() const { return m_data[2]; }
+        constexpr float GetW() const { return m_data[3]; }
+
+        Simd::Float4 Load() const { return Simd::Load(m_data); }
+
+        /**
+         * Combines two rotations, applying \c rhs first
+         */
+        Quaternion operator*(const Quaternion &rhs) const {
+            Simd::Float4 a = Load();
+            Simd::Float4 b = rhs.Load();
+
+            // Hamilton product, with the sign pattern of each term folded into a constant
+            Simd::Float4 result = Simd::Mul(Simd::SplatLane<3>(a), b);
+            result = Simd::MulAdd(Simd::SplatLane<0>(a),
+                                  Simd::Mul(Simd::Shuffle<3, 2, 1, 0>(b), Simd::Set(1.0f, -1.0f, 1.0f, -1.0f)), result);
+            result = Simd::MulAdd(Simd::SplatLane<1>(a),
+                                  Simd::Mul(Simd::Shuffle<2, 3, 0, 1>(b), Simd::Set(1.0f, 1.0f, -1.0f, -1.0f)), result);
+            result = Simd::MulAdd(Simd::SplatLane<2>(a),
+                                  Simd::Mul(Simd::Shuffle<1, 0, 3, 2>(b), Simd::Set(-1.0f, 1.0f, 1.0f, -1.0f)), result);
+            return Quaternion(result);
+        }
+
+        Quaternion &operator*=(const Quaternion &rhs) { return *this = *this * rhs; }
+
+        /**
+         * Rotates a vector
+         */
+        constexpr Vector3 operator*(const Vector3 &rhs) const {
+            Vector3 axis(m_data[0], m_data[1], m_data[2]);
+            Vector3 t = axis.Cross(rhs) * 2.0f;
+            return rhs + t * m_data[3] + axis.Cross(t);
+        }
+
+        constexpr bool operator==(const Quaternion &rhs) const {
+            return m_data[0] == rhs.m_data[0] && m_data[1] == rhs.m_data[1] &&
+                   m_data[2] == rhs.m_data[2] && m_data[3] == rhs.m_data[3];
+        }
+        constexpr bool operator!=(const Quaternion &rhs) const { return !(*this == rhs); }
+
+        float Dot(const Quaternion &rhs) const { return Simd::Dot(Load(), rhs.Load()); }
+
+        /**
+         * Returns the inverse rotation of a unit quaternion
+         */
+        constexpr Quaternion Conjugate() const { return Quaternion(-m_data[0], -m_data[1], -m_data[2], m_data[3]); }
+
+        Quaternion Normalized() const {
+            float length = Dot(*this);
+            return length > 0.0f ? Quaternion(Simd::Mul(Load(), Simd::Splat(1.0f / std::sqrt(length)))) : *this;
+        }
+
+        /**
+         * Normalized linear interpolation, taking the shortest path
+         */
+        Quaternion Nlerp(const Quaternion &rhs, float t) const {
+            Simd::Float4 to = Dot(rhs) < 0.0f ? Simd::Sub(Simd::Splat(0.0f), rhs.Load()) : rhs.Load();
+            return Quaternion(Simd::MulAdd(Simd::Sub(to, Load()), Simd::Splat(t), Load())).Normalized();
+        }
+
+        /**
+         * Spherical linear interpolation, taking the shortest path
+         */
+        Quaternion Slerp(const Quaternion &rhs, float t) const {
+            float cosAngle = Dot(rhs);
+            float sign = cosAngle < 0.0f ? -1.0f : 1.0f;
+            cosAngle *= sign;
+
+            // Nearly parallel rotations would divide by a tiny sine
+            if (cosAngle > 1.0f - M_EPSILON)
+                return Nlerp(rhs, t);
+
+            float angle = std::acos(cosAngle);
+            float invSin = 1.0f / std::sin(angle);
+            float from = std::sin((1.0f - t) * angle) * invSin;
+            float to = std::sin(t * angle) * invSin * sign;
+            return Quaternion(Simd::MulAdd(Load(), Simd::Splat(from), Simd::Mul(rhs.Load(), Simd::Splat(to))));
+        }
+
+        /**
+         * Gets the equivalent rotation matrix of a unit quaternion
+         */
+        constexpr Matrix3 RotationMatrix() const {
+            float x = m_data[0], y = m_data[1], z = m_data[2], w = m_data[3];
+            return Matrix3(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z), 2.0f * (x * z + w * y),
+                           2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x),
+                           2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y));
+        }
+
+        /**
+         * Checks equality with another quaternion within an epsilon
+         */
+        constexpr bool Equals(const Quaternion &rhs) const {
+            return Engine::Equals(m_data[0], rhs.m_data[0]) && Engine::Equals(m_data[1], rhs.m_data[1]) &&
+                   Engine::Equals(m_data[2], rhs.m_data[2]) && Engine::Equals(m_data[3], rhs.m_data[3]);
+        }
+
+        /**
+         * Creates a rotation around a unit axis
+         * @param radians the rotation angle, counter-clockwise looking down the axis
+         */
+        static Quaternion FromAxisAngle(const Vector3 &axis, float radians) {
+            float s = std::sin(radians * 0.5f);
+            return Quaternion(axis.GetX() * s, axis.GetY() * s, axis.GetZ() * s, std::cos(radians * 0.5f));
+        }
+    };
+
+    inline constexpr Quaternion Quaternion::IDENTITY;
+
+}
@@ -0,0 +1,271 @@
+//
+// Four-wide float operations on SSE2 or NEON, with a portable scalar fallback.
+// Define ENGINE_MATH_SCALAR to force the fallback.
+//
+
+#pragma once
+
+#if !defined(ENGINE_MATH_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ENGINE_MATH_SSE2 1
+#include <emmintrin.h>
+#elif !defined(ENGINE_MATH_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define ENGINE_MATH_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+namespace Engine {
+namespace Simd {
+
+#if defined(ENGINE_MATH_SSE2)
+
+    typedef __m128 Float4;
+
+    const char *const NAME = "SSE2";
+
+    /** Loads four floats from a 16-byte aligned address */
+    inline Float4 Load(const float *p) { return _mm_load_ps(p); }
+
+    /** Stores four floats to a 16-byte aligned address */
+    inline void Store(float *p, Float4 v) { _mm_store_ps(p, v); }
+
+    inline Float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+    inline Float4 Splat(float value) { return _mm_set1_ps(value); }
+    inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+
+    /** Comparisons give a mask: all bits set in the lanes where they hold, clear elsewhere */
+    inline Float4 Less(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+    inline Float4 LessEqual(Float4 a, Float4 b) { return _mm_cmple_ps(a, b); }
+    inline Float4 GreaterEqual(Float4 a, Float4 b) { return _mm_cmpge_ps(a, b); }
+    inline Float4 And(Float4 a, Float4 b) { return _mm_and_ps(a, b); }
+    inline Float4 Or(Float4 a, Float4 b) { return _mm_or_ps(a, b); }
+
+    /** Takes the lanes of \c a where \c mask is set and of \c b elsewhere */
+    inline Float4 Select(Float4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+    /** Packs a mask into one bit per lane, lane 0 lowest */
+    inline int MaskBits(Float4 mask) { return _mm_movemask_ps(mask); }
+
+    /** Rearranges lanes: the result is (v[X], v[Y], v[Z], v[W]) */
+    template <int X, int Y, int Z, int W>
+    inline Float4 Shuffle(Float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X)); }
+
+    /** Broadcasts one lane to all four */
+    template <int Lane>
+    inline Float4 SplatLane(Float4 v) { return Shuffle<Lane, Lane, Lane, Lane>(v); }
+
+    /** Adds the four lanes together */
+    inline float Sum(Float4 v) {
+        Float4 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, Shuffle<1, 1, 1, 1>(pairs)));
+    }
+
+#elif defined(ENGINE_MATH_NEON)
+
+    typedef float32x4_t Float4;
+
+    const char *const NAME = "NEON";
+
+    inline Float4 Load(const float *p) { return vld1q_f32(p); }
+    inline void Store(float *p, Float4 v) { vst1q_f32(p, v); }
+
+    inline Float4 Set(float x, float y, float z, float w) {
+        const float values[4] = {x, y, z, w};
+        return vld1q_f32(values);
+    }
+
+    inline Float4 Splat(float value) { return vdupq_n_f32(value); }
+    inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+
+    inline Float4 Less(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+    inline Float4 LessEqual(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcleq_f32(a, b)); }
+    inline Float4 GreaterEqual(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+
+    inline Float4 And(Float4 a, Float4 b) {
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+
+    inline Float4 Or(Float4 a, Float4 b) {
+        return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+
+    inline Float4 Select(Float4 mask, Float4 a, Float4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+
+    inline int MaskBits(Float4 mask) {
+        uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(mask), 31);
+        return (int)(vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) |
+                     (vgetq_lane_u32(bits, 3) << 3));
+    }
+
+    inline Float4 Div(Float4 a, Float4 b) {
+#if defined(__aarch64__)
+        return vdivq_f32(a, b);
+#else
+        // Two Newton-Raphson steps on the reciprocal estimate
+        Float4 r = vrecpeq_f32(b);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+#endif
+    }
+
+    template <int X, int Y, int Z, int W>
+    inline Float4 Shuffle(Float4 v) {
+#if defined(__clang__)
+        return __builtin_shufflevector(v, v, X, Y, Z, W);
+#else
+        return Set(vgetq_lane_f32(v, X), vgetq_lane_f32(v, Y), vgetq_lane_f32(v, Z), vgetq_lane_f32(v, W));
+#endif
+    }
+
+    template <int Lane>
+    inline Float4 SplatLane(Float4 v) {
+#if defined(__aarch64__)
+        return vdupq_laneq_f32(v, Lane);
+#else
+        return vdupq_n_f32(vgetq_lane_f32(v, Lane));
+#endif
+    }
+
+    inline float Sum(Float4 v) {
+#if defined(__aarch64__)
+        return vaddvq_f32(v);
+#else
+        float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+#endif
+    }
+
+#else
+
+    struct Float4 {
+        float v[4];
+    };
+
+    const char *const NAME = "scalar";
+
+    inline Float4 Load(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+
+    inline void Store(float *p, Float4 v) {
+        for (int i = 0; i < 4; i++)
+            p[i] = v.v[i];
+    }
+
+    inline Float4 Set(float x, float y, float z, float w) { return {{x, y, z, w}}; }
+    inline Float4 Splat(float value) { return {{value, value, value, value}}; }
+
+    inline Float4 Add(Float4 a, Float4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+    inline Float4 Sub(Float4 a, Float4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+    inline Float4 Mul(Float4 a, Float4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+    inline Float4 Div(Float4 a, Float4 b) { return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}}; }
+
+    inline Float4 Min(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+            r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return r;
+    }
+
+    inline Float4 Max(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+            r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return r;
+    }
+
+    /** Lane of a mask: a float with every bit set or clear */
+    inline float MaskLane(bool set) {
+        uint32_t bits = set ? 0xFFFFFFFFu : 0u;
+        float lane;
+        std::memcpy(&lane, &bits, sizeof(lane));
+        return lane;
+    }
+
+    inline uint32_t LaneBits(float lane) {
+        uint32_t bits;
+        std::memcpy(&bits, &lane, sizeof(bits));
+        return bits;
+    }
+
+    inline Float4 Less(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+            r.v[i] = MaskLane(a.v[i] < b.v[i]);
+        return r;
+    }
+
+    inline Float4 LessEqual(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+            r.v[i] = MaskLane(a.v[i] <= b.v[i]);
+        return r;
+    }
+
+    inline Float4 GreaterEqual(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+            r.v[i] = MaskLane(a.v[i] >= b.v[i]);
+        return r;
+    }
+
+    inline Float4 And(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++) {
+            uint32_t bits = LaneBits(a.v[i]) & LaneBits(b.v[i]);
+            std::memcpy(&r.v[i], &bits, sizeof(bits));
+        }
+        return r;
+    }
+
+    inline Float4 Or(Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++) {
+            uint32_t bits = LaneBits(a.v[i]) | LaneBits(b.v[i]);
+            std::memcpy(&r.v[i], &bits, sizeof(bits));
+        }
+        return r;
+    }
+
+    inline Float4 Select(Float4 mask, Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++)
+            r.v[i] = LaneBits(mask.v[i]) ? a.v[i] : b.v[i];
+        return r;
+    }
+
+    inline int MaskBits(Float4 mask) {
+        int bits = 0;
+        for (int i = 0; i < 4; i++)
+            bits |= (int)(LaneBits(mask.v[i]) >> 31) << i;
+        return bits;
+    }
+
+    template <int X, int Y, int Z, int W>
+    inline Float4 Shuffle(Float4 v) { return {{v.v[X], v.v[Y], v.v[Z], v.v[W]}}; }
+
+    template <int Lane>
+    inline Float4 SplatLane(Float4 v) { return Splat(v.v[Lane]); }
+
+    inline float Sum(Float4 v) { return (v.v[0] + v.v[1]) + (v.v[2] + v.v[3]); }
+
+#endif
+
+    /** Multiply-add: a * b + c */
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return Add(Mul(a, b), c); }
+
+    /** Four-wide dot product */
+    inline float Dot(Float4 a, Float4 b) { return Sum(Mul(a, b)); }
+
+}
+}
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "MathDefs.h"
+
 namespace Engine {
 
     /**
@@ -17,9 +19,9 @@ namespace Engine {
         float m_y;
 
     public:
-        Vector2();
-        Vector2(float x, float y);
-        Vector2(Vector2 *v);
+        constexpr Vector2() : m_x(0.0f), m_y(0.0f) {}
+        constexpr Vector2(float x, float y) : m_x(x), m_y(y) {}
+        constexpr Vector2(const Vector2 *v) : m_x(v->m_x), m_y(v->m_y) {}
 
         static const Vector2 LEFT;
         static const Vector2 RIGHT;
@@ -32,14 +34,69 @@ namespace Engine {
          * Gets the X component of the vector
          * @return the value of this vector's X
          */
-        inline float GetX();
+        constexpr float GetX() const { return m_x; }
 
         /**
          * Gets the Y component of the vector
          * @return the value of this vector's Y
          */
-        inline float GetY();
+        constexpr float GetY() const { return m_y; }
+
+        void SetX(float x) { m_x = x; }
+        void SetY(float y) { m_y = y; }
+
+        constexpr Vector2 operator+(const Vector2 &rhs) const { return Vector2(m_x + rhs.m_x, m_y + rhs.m_y); }
+        constexpr Vector2 operator-(const Vector2 &rhs) const { return Vector2(m_x - rhs.m_x, m_y - rhs.m_y); }
+        constexpr Vector2 operator-() const { return Vector2(-m_x, -m_y); }
+        constexpr Vector2 operator*(float rhs) const { return Vector2(m_x * rhs, m_y * rhs); }
+        constexpr Vector2 operator*(const Vector2 &rhs) const { return Vector2(m_x * rhs.m_x, m_y * rhs.m_y); }
+        constexpr Vector2 operator/(float rhs) const { return Vector2(m_x / rhs, m_y / rhs); }
+        constexpr Vector2 operator/(const Vector2 &rhs) const { return Vector2(m_x / rhs.m_x, m_y / rhs.m_y); }
+
+        constexpr Vector2 &operator+=(const Vector2 &rhs) { m_x += rhs.m_x; m_y += rhs.m_y; return *this; }
+        constexpr Vector2 &operator-=(const Vector2 &rhs) { m_x -= rhs.m_x; m_y -= rhs.m_y; return *this; }
+        constexpr Vector2 &operator*=(float rhs) { m_x *= rhs; m_y *= rhs; return *this; }
+        constexpr Vector2 &operator/=(float rhs) { m_x /= rhs; m_y /= rhs; return *this; }
+
+        constexpr bool operator==(const Vector2 &rhs) const { return m_x == rhs.m_x && m_y == rhs.m_y; }
+        constexpr bool operator!=(const Vector2 &rhs) const { return !(*this == rhs); }
+
+        /**
+         * Calculates the dot product with another vector
+         */
+        constexpr float Dot(const Vector2 &rhs) const { return m_x * rhs.m_x + m_y * rhs.m_y; }
 
+        constexpr float LengthSquared() const { return Dot(*this); }
+        float Length() const { return std::sqrt(LengthSquared()); }
+
+        /**
+         * Returns a unit vector in the same direction, or the vector itself if its length is zero
+         */
+        Vector2 Normalized() const {
+            float length = LengthSquared();
+            return length > 0.0f ? *this / std::sqrt(length) : *this;
+        }
+
+        /**
+         * Linear interpolation to another vector
+         */
+        constexpr Vector2 Lerp(const Vector2 &rhs, float t) const { return *this + (rhs - *this) * t; }
+
+        /**
+         * Checks equality with another vector within an epsilon
+         */
+        constexpr bool Equals(const Vector2 &rhs) const {
+            return Engine::Equals(m_x, rhs.m_x) && Engine::Equals(m_y, rhs.m_y);
+        }
     };
 
-}
\ No newline at end of file
+    constexpr Vector2 operator*(float lhs, const Vector2 &rhs) { return rhs * lhs; }
+
+    inline constexpr Vector2 Vector2::LEFT(-1.0f, 0.0f);
+    inline constexpr Vector2 Vector2::RIGHT(1.0f, 0.0f);
+    inline constexpr Vector2 Vector2::UP(0.0f, 1.0f);
+    inline constexpr Vector2 Vector2::DOWN(0.0f, -1.0f);
+    inline constexpr Vector2 Vector2::ONE(1.0f, 1.0f);
+    inline constexpr Vector2 Vector2::ZERO(0.0f, 0.0f);
+
+}
@@ -0,0 +1,202 @@
+//
+// Structure-of-arrays storage for large numbers of 2D vectors, with batch
+// kernels for AVX2, SSE2 or NEON picked at runtime.
+//
+
+#include "Vector2Array.h"
+
+#include "CpuDispatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace Engine {
+
+    namespace {
+
+        void Translate(float *xs, float *ys, size_t count, float dx, float dy) {
+            for (size_t i = 0; i < count; i++) {
+                xs[i] += dx;
+                ys[i] += dy;
+            }
+        }
+
+        void Scale(float *xs, float *ys, size_t count, float sx, float sy) {
+            for (size_t i = 0; i < count; i++) {
+                xs[i] *= sx;
+                ys[i] *= sy;
+            }
+        }
+
+        void Transform(float *xs, float *ys, size_t count, const float m[6]) {
+            for (size_t i = 0; i < count; i++) {
+                float x = xs[i], y = ys[i];
+                xs[i] = m[0] * x + m[1] * y + m[2];
+                ys[i] = m[3] * x + m[4] * y + m[5];
+            }
+        }
+
+        void Dot(const float *ax, const float *ay, const float *bx, const float *by, float *out, size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = ax[i] * bx[i] + ay[i] * by[i];
+        }
+
+        void Length(const float *xs, const float *ys, float *out, size_t count) {
+            for (size_t i = 0; i < count; i++)
+                out[i] = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+        }
+
+        void Normalize(float *xs, float *ys, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                float lengthSquared = xs[i] * xs[i] + ys[i] * ys[i];
+                if (lengthSquared > 0.0f) {
+                    float inverse = 1.0f / std::sqrt(lengthSquared);
+                    xs[i] *= inverse;
+                    ys[i] *= inverse;
+                }
+            }
+        }
+
+        const Vector2Kernels SCALAR_KERNELS = {"scalar", Translate, Scale, Transform, Dot, Length, Normalize};
+
+        // Round capacities to whole AVX registers so the Y array starts aligned too
+        size_t RoundCapacity(size_t capacity) {
+            const size_t lanes = Vector2Array::ALIGNMENT / sizeof(float);
+            return (capacity + lanes - 1) / lanes * lanes;
+        }
+
+        float *Allocate(size_t capacity) {
+            return static_cast<float *>(
+                ::operator new(capacity * 2 * sizeof(float), std::align_val_t(Vector2Array::ALIGNMENT)));
+        }
+
+        void Free(float *data) {
+            ::operator delete(data, std::align_val_t(Vector2Array::ALIGNMENT));
+        }
+    }
+
+    const Vector2Kernels *GetVector2KernelsScalar() {
+        return &SCALAR_KERNELS;
+    }
+
+    const Vector2Kernels &Vector2Array::GetKernels() {
+        static const KernelDispatch<Vector2Kernels> dispatch("Vector2Array", {
+            {Isa::AVX2, GetVector2KernelsAVX2()},
+            {Isa::SSE2, GetVector2KernelsSSE2()},
+            {Isa::NEON, GetVector2KernelsNEON()},
+            {Isa::Scalar, GetVector2KernelsScalar()},
+        });
+        return dispatch.Get();
+    }
+
+    Vector2Array::Vector2Array() : m_x(nullptr), m_y(nullptr), m_size(0), m_capacity(0) {
+    }
+
+    Vector2Array::Vector2Array(size_t size) : Vector2Array() {
+        Resize(size);
+    }
+
+    Vector2Array::Vector2Array(const Vector2Array &other) : Vector2Array() {
+        *this = other;
+    }
+
+    Vector2Array::Vector2Array(Vector2Array &&other) noexcept : Vector2Array() {
+        *this = std::move(other);
+    }
+
+    Vector2Array::~Vector2Array() {
+        if (m_x)
+            Free(m_x);
+    }
+
+    Vector2Array &Vector2Array::operator=(const Vector2Array &other) {
+        if (this != &other) {
+            m_size = 0;
+            Reserve(other.m_size);
+            if (other.m_size > 0) {
+                std::memcpy(m_x, other.m_x, other.m_size * sizeof(float));
+                std::memcpy(m_y, other.m_y, other.m_size * sizeof(float));
+            }
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    Vector2Array &Vector2Array::operator=(Vector2Array &&other) noexcept {
+        std::swap(m_x, other.m_x);
+        std::swap(m_y, other.m_y);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+        return *this;
+    }
+
+    void Vector2Array::Reserve(size_t capacity) {
+        if (capacity <= m_capacity)
+            return;
+
+        capacity = RoundCapacity(capacity);
+        float *data = Allocate(capacity);
+        if (m_x) {
+            std::memcpy(data, m_x, m_size * sizeof(float));
+            std::memcpy(data + capacity, m_y, m_size * sizeof(float));
+            Free(m_x);
+        }
+
+        m_x = data;
+        m_y = data + capacity;
+        m_capacity = capacity;
+    }
+
+    void Vector2Array::Resize(size_t size) {
+        Reserve(size);
+        if (size > m_size) {
+            std::fill(m_x + m_size, m_x + size, 0.0f);
+            std::fill(m_y + m_size, m_y + size, 0.0f);
+        }
+        m_size = size;
+    }
+
+    void Vector2Array::PushBack(const Vector2 &v) {
+        if (m_size == m_capacity)
+            Reserve(std::max<size_t>(m_capacity * 2, ALIGNMENT));
+        m_x[m_size] = v.GetX();
+        m_y[m_size] = v.GetY();
+        m_size++;
+    }
+
+    void Vector2Array::Translate(const Vector2 &offset) {
+        GetKernels().translate(m_x, m_y, m_size, offset.GetX(), offset.GetY());
+    }
+
+    void Vector2Array::Scale(const Vector2 &scale) {
+        GetKernels().scale(m_x, m_y, m_size, scale.GetX(), scale.GetY());
+    }
+
+    void Vector2Array::Rotate(float radians) {
+        float c = std::cos(radians), s = std::sin(radians);
+        const float m[6] = {c, -s, 0.0f, s, c, 0.0f};
+        GetKernels().transform(m_x, m_y, m_size, m);
+    }
+
+    void Vector2Array::Transform(const Matrix3 &affine) {
+        const float m[6] = {affine.Get(0, 0), affine.Get(0, 1), affine.Get(0, 2),
+                            affine.Get(1, 0), affine.Get(1, 1), affine.Get(1, 2)};
+        GetKernels().transform(m_x, m_y, m_size, m);
+    }
+
+    void Vector2Array::Dot(const Vector2Array &other, float *out) const {
+        GetKernels().dot(m_x, m_y, other.m_x, other.m_y, out, m_size);
+    }
+
+    void Vector2Array::Length(float *out) const {
+        GetKernels().length(m_x, m_y, out, m_size);
+    }
+
+    void Vector2Array::Normalize() {
+        GetKernels().normalize(m_x, m_y, m_size);
+    }
+
+}
@@ -0,0 +1,129 @@
+//
+// Structure-of-arrays storage for large numbers of 2D vectors, with batch
+// kernels for AVX2, SSE2 or NEON picked at runtime.
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include "Matrix3.h"
+#include "Vector2.h"
+
+namespace Engine {
+
+    /**
+     * One instruction set's implementation of the Vector2Array kernels.
+     * All kernels take unaligned spans and handle any count.
+     */
+    struct Vector2Kernels {
+        const char *name;
+
+        void (*translate)(float *xs, float *ys, size_t count, float dx, float dy);
+        void (*scale)(float *xs, float *ys, size_t count, float sx, float sy);
+
+        /**
+         * x' = m[0] * x + m[1] * y + m[2], y' = m[3] * x + m[4] * y + m[5]
+         */
+        void (*transform)(float *xs, float *ys, size_t count, const float m[6]);
+
+        void (*dot)(const float *ax, const float *ay, const float *bx, const float *by, float *out, size_t count);
+        void (*length)(const float *xs, const float *ys, float *out, size_t count);
+
+        /**
+         * Scales every vector to unit length, leaving zero vectors untouched
+         */
+        void (*normalize)(float *xs, float *ys, size_t count);
+    };
+
+    /**
+     * Kernel tables for each instruction set, or nullptr where this build can't provide one
+     */
+    const Vector2Kernels *GetVector2KernelsAVX2();
+    const Vector2Kernels *GetVector2KernelsSSE2();
+    const Vector2Kernels *GetVector2KernelsNEON();
+    const Vector2Kernels *GetVector2KernelsScalar();
+
+    /**
+     * A resizable array of 2D vectors stored as separate X and Y arrays,
+     * each aligned for the widest vector registers.
+     */
+    class Vector2Array {
+    public:
+        static const size_t ALIGNMENT = 32;
+
+        Vector2Array();
+        explicit Vector2Array(size_t size);
+        Vector2Array(const Vector2Array &other);
+        Vector2Array(Vector2Array &&other) noexcept;
+        ~Vector2Array();
+
+        Vector2Array &operator=(const Vector2Array &other);
+        Vector2Array &operator=(Vector2Array &&other) noexcept;
+
+        size_t Size() const { return m_size; }
+        size_t Capacity() const { return m_capacity; }
+        bool Empty() const { return m_size == 0; }
+
+        /**
+         * Changes the number of vectors, zero-filling any new ones
+         */
+        void Resize(size_t size);
+        void Reserve(size_t capacity);
+        void Clear() { m_size = 0; }
+
+        void PushBack(const Vector2 &v);
+
+        Vector2 Get(size_t index) const { return Vector2(m_x[index], m_y[index]); }
+
+        void Set(size_t index, const Vector2 &v) {
+            m_x[index] = v.GetX();
+            m_y[index] = v.GetY();
+        }
+
+        float *X() { return m_x; }
+        float *Y() { return m_y; }
+        const float *X() const { return m_x; }
+        const float *Y() const { return m_y; }
+
+        void Translate(const Vector2 &offset);
+        void Scale(const Vector2 &scale);
+
+        /**
+         * Rotates every vector counter-clockwise around the origin
+         */
+        void Rotate(float radians);
+
+        /**
+         * Applies a 2D affine transform held in the upper two rows of a 3x3 matrix
+         */
+        void Transform(const Matrix3 &affine);
+
+        /**
+         * Writes the dot product of each pair of vectors
+         * @param other an array of the same size
+         * @param out room for Size() floats
+         */
+        void Dot(const Vector2Array &other, float *out) const;
+
+        /**
+         * Writes the length of each vector
+         * @param out room for Size() floats
+         */
+        void Length(float *out) const;
+
+        void Normalize();
+
+        /**
+         * Gets the kernels for the best instruction set CpuDispatch allows
+         */
+        static const Vector2Kernels &GetKernels();
+
+    private:
+        float *m_x;
+        float *m_y;
+        size_t m_size;
+        size_t m_capacity;
+    };
+
+}
@@ -0,0 +1,107 @@
+//
+// AVX2 kernels for Vector2Array, eight vectors per iteration.
+//
+
+#include "Vector2Array.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+namespace Engine {
+
+    namespace {
+
+        const Vector2Kernels &Tail() {
+            return *GetVector2KernelsScalar();
+        }
+
+        void Translate(float *xs, float *ys, size_t count, float dx, float dy) {
+            const __m256 vdx = _mm256_set1_ps(dx), vdy = _mm256_set1_ps(dy);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(xs + i, _mm256_add_ps(_mm256_loadu_ps(xs + i), vdx));
+                _mm256_storeu_ps(ys + i, _mm256_add_ps(_mm256_loadu_ps(ys + i), vdy));
+            }
+            Tail().translate(xs + i, ys + i, count - i, dx, dy);
+        }
+
+        void Scale(float *xs, float *ys, size_t count, float sx, float sy) {
+            const __m256 vsx = _mm256_set1_ps(sx), vsy = _mm256_set1_ps(sy);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(xs + i, _mm256_mul_ps(_mm256_loadu_ps(xs + i), vsx));
+                _mm256_storeu_ps(ys + i, _mm256_mul_ps(_mm256_loadu_ps(ys + i), vsy));
+            }
+            Tail().scale(xs + i, ys + i, count - i, sx, sy);
+        }
+
+        void Transform(float *xs, float *ys, size_t count, const float m[6]) {
+            const __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+            const __m256 m3 = _mm256_set1_ps(m[3]), m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 x = _mm256_loadu_ps(xs + i), y = _mm256_loadu_ps(ys + i);
+                _mm256_storeu_ps(xs + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m1, y)), m2));
+                _mm256_storeu_ps(ys + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m3, x), _mm256_mul_ps(m4, y)), m5));
+            }
+            Tail().transform(xs + i, ys + i, count - i, m);
+        }
+
+        void Dot(const float *ax, const float *ay, const float *bx, const float *by, float *out, size_t count) {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 x = _mm256_mul_ps(_mm256_loadu_ps(ax + i), _mm256_loadu_ps(bx + i));
+                __m256 y = _mm256_mul_ps(_mm256_loadu_ps(ay + i), _mm256_loadu_ps(by + i));
+                _mm256_storeu_ps(out + i, _mm256_add_ps(x, y));
+            }
+            Tail().dot(ax + i, ay + i, bx + i, by + i, out + i, count - i);
+        }
+
+        void Length(const float *xs, const float *ys, float *out, size_t count) {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 x = _mm256_loadu_ps(xs + i), y = _mm256_loadu_ps(ys + i);
+                _mm256_storeu_ps(out + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y))));
+            }
+            Tail().length(xs + i, ys + i, out + i, count - i);
+        }
+
+        void Normalize(float *xs, float *ys, size_t count) {
+            const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 x = _mm256_loadu_ps(xs + i), y = _mm256_loadu_ps(ys + i);
+                __m256 lengthSquared = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+
+                // Zero vectors get a factor of one instead of infinity
+                __m256 nonZero = _mm256_cmp_ps(lengthSquared, zero, _CMP_GT_OQ);
+                __m256 inverse = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSquared));
+                inverse = _mm256_blendv_ps(one, inverse, nonZero);
+
+                _mm256_storeu_ps(xs + i, _mm256_mul_ps(x, inverse));
+                _mm256_storeu_ps(ys + i, _mm256_mul_ps(y, inverse));
+            }
+            Tail().normalize(xs + i, ys + i, count - i);
+        }
+
+        const Vector2Kernels KERNELS = {"AVX2", Translate, Scale, Transform, Dot, Length, Normalize};
+    }
+
+    const Vector2Kernels *GetVector2KernelsAVX2() {
+        return &KERNELS;
+    }
+
+}
+
+#else
+
+namespace Engine {
+
+    const Vector2Kernels *GetVector2KernelsAVX2() {
+        return nullptr;
+    }
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+//
+// NEON kernels for Vector2Array, four vectors per iteration.
+//
+
+#include "Vector2Array.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+
+namespace Engine {
+
+    namespace {
+
+        const Vector2Kernels &Tail() {
+            return *GetVector2KernelsScalar();
+        }
+
+        inline float32x4_t Reciprocal(float32x4_t v) {
+#if defined(__aarch64__)
+            return vdivq_f32(vdupq_n_f32(1.0f), v);
+#else
+            float32x4_t r = vrecpeq_f32(v);
+            r = vmulq_f32(vrecpsq_f32(v, r), r);
+            return vmulq_f32(vrecpsq_f32(v, r), r);
+#endif
+        }
+
+        inline float32x4_t Sqrt(float32x4_t v) {
+#if defined(__aarch64__)
+            return vsqrtq_f32(v);
+#else
+            // sqrt(v) = v / sqrt(v), refining the reciprocal square root estimate twice
+            float32x4_t r = vrsqrteq_f32(v);
+            r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+            r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+            return vbslq_f32(vcgtq_f32(v, vdupq_n_f32(0.0f)), vmulq_f32(v, r), vdupq_n_f32(0.0f));
+#endif
+        }
+
+        void Translate(float *xs, float *ys, size_t count, float dx, float dy) {
+            const float32x4_t vdx = vdupq_n_f32(dx), vdy = vdupq_n_f32(dy);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(xs + i, vaddq_f32(vld1q_f32(xs + i), vdx));
+                vst1q_f32(ys + i, vaddq_f32(vld1q_f32(ys + i), vdy));
+            }
+            Tail().translate(xs + i, ys + i, count - i, dx, dy);
+        }
+
+        void Scale(float *xs, float *ys, size_t count, float sx, float sy) {
+            const float32x4_t vsx = vdupq_n_f32(sx), vsy = vdupq_n_f32(sy);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(xs + i, vmulq_f32(vld1q_f32(xs + i), vsx));
+                vst1q_f32(ys + i, vmulq_f32(vld1q_f32(ys + i), vsy));
+            }
+            Tail().scale(xs + i, ys + i, count - i, sx, sy);
+        }
+
+        void Transform(float *xs, float *ys, size_t count, const float m[6]) {
+            const float32x4_t m0 = vdupq_n_f32(m[0]), m1 = vdupq_n_f32(m[1]), m2 = vdupq_n_f32(m[2]);
+            const float32x4_t m3 = vdupq_n_f32(m[3]), m4 = vdupq_n_f32(m[4]), m5 = vdupq_n_f32(m[5]);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                float32x4_t x = vld1q_f32(xs + i), y = vld1q_f32(ys + i);
+                vst1q_f32(xs + i, vmlaq_f32(vmlaq_f32(m2, m0, x), m1, y));
+                vst1q_f32(ys + i, vmlaq_f32(vmlaq_f32(m5, m3, x), m4, y));
+            }
+            Tail().transform(xs + i, ys + i, count - i, m);
+        }
+
+        void Dot(const float *ax, const float *ay, const float *bx, const float *by, float *out, size_t count) {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                float32x4_t x = vmulq_f32(vld1q_f32(ax + i), vld1q_f32(bx + i));
+                vst1q_f32(out + i, vmlaq_f32(x, vld1q_f32(ay + i), vld1q_f32(by + i)));
+            }
+            Tail().dot(ax + i, ay + i, bx + i, by + i, out + i, count - i);
+        }
+
+        void Length(const float *xs, const float *ys, float *out, size_t count) {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                float32x4_t x = vld1q_f32(xs + i), y = vld1q_f32(ys + i);
+                vst1q_f32(out + i, Sqrt(vmlaq_f32(vmulq_f32(x, x), y, y)));
+            }
+            Tail().length(xs + i, ys + i, out + i, count - i);
+        }
+
+        void Normalize(float *xs, float *ys, size_t count) {
+            const float32x4_t zero = vdupq_n_f32(0.0f), one = vdupq_n_f32(1.0f);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                float32x4_t x = vld1q_f32(xs + i), y = vld1q_f32(ys + i);
+                float32x4_t lengthSquared = vmlaq_f32(vmulq_f32(x, x), y, y);
+
+                // Zero vectors get a factor of one instead of infinity
+                uint32x4_t nonZero = vcgtq_f32(lengthSquared, zero);
+                float32x4_t inverse = vbslq_f32(nonZero, Reciprocal(Sqrt(lengthSquared)), one);
+
+                vst1q_f32(xs + i, vmulq_f32(x, inverse));
+                vst1q_f32(ys + i, vmulq_f32(y, inverse));
+            }
+            Tail().normalize(xs + i, ys + i, count - i);
+        }
+
+        const Vector2Kernels KERNELS = {"NEON", Translate, Scale, Transform, Dot, Length, Normalize};
+    }
+
+    const Vector2Kernels *GetVector2KernelsNEON() {
+        return &KERNELS;
+    }
+
+}
+
+#else
+
+namespace Engine {
+
+    const Vector2Kernels *GetVector2KernelsNEON() {
+        return nullptr;
+    }
+
+}
+
+#endif
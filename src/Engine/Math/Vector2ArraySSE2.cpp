@@ -0,0 +1,107 @@
+//
+// SSE2 kernels for Vector2Array, four vectors per iteration.
+//
+
+#include "Vector2Array.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <emmintrin.h>
+
+namespace Engine {
+
+    namespace {
+
+        const Vector2Kernels &Tail() {
+            return *GetVector2KernelsScalar();
+        }
+
+        void Translate(float *xs, float *ys, size_t count, float dx, float dy) {
+            const __m128 vdx = _mm_set1_ps(dx), vdy = _mm_set1_ps(dy);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_ps(xs + i, _mm_add_ps(_mm_loadu_ps(xs + i), vdx));
+                _mm_storeu_ps(ys + i, _mm_add_ps(_mm_loadu_ps(ys + i), vdy));
+            }
+            Tail().translate(xs + i, ys + i, count - i, dx, dy);
+        }
+
+        void Scale(float *xs, float *ys, size_t count, float sx, float sy) {
+            const __m128 vsx = _mm_set1_ps(sx), vsy = _mm_set1_ps(sy);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_ps(xs + i, _mm_mul_ps(_mm_loadu_ps(xs + i), vsx));
+                _mm_storeu_ps(ys + i, _mm_mul_ps(_mm_loadu_ps(ys + i), vsy));
+            }
+            Tail().scale(xs + i, ys + i, count - i, sx, sy);
+        }
+
+        void Transform(float *xs, float *ys, size_t count, const float m[6]) {
+            const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+            const __m128 m3 = _mm_set1_ps(m[3]), m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_loadu_ps(xs + i), y = _mm_loadu_ps(ys + i);
+                _mm_storeu_ps(xs + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)), m2));
+                _mm_storeu_ps(ys + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, x), _mm_mul_ps(m4, y)), m5));
+            }
+            Tail().transform(xs + i, ys + i, count - i, m);
+        }
+
+        void Dot(const float *ax, const float *ay, const float *bx, const float *by, float *out, size_t count) {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_mul_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i));
+                __m128 y = _mm_mul_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i));
+                _mm_storeu_ps(out + i, _mm_add_ps(x, y));
+            }
+            Tail().dot(ax + i, ay + i, bx + i, by + i, out + i, count - i);
+        }
+
+        void Length(const float *xs, const float *ys, float *out, size_t count) {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_loadu_ps(xs + i), y = _mm_loadu_ps(ys + i);
+                _mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))));
+            }
+            Tail().length(xs + i, ys + i, out + i, count - i);
+        }
+
+        void Normalize(float *xs, float *ys, size_t count) {
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_loadu_ps(xs + i), y = _mm_loadu_ps(ys + i);
+                __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+
+                // Zero vectors get a factor of one instead of infinity
+                __m128 nonZero = _mm_cmpgt_ps(lengthSquared, zero);
+                __m128 inverse = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+                inverse = _mm_or_ps(_mm_and_ps(nonZero, inverse), _mm_andnot_ps(nonZero, one));
+
+                _mm_storeu_ps(xs + i, _mm_mul_ps(x, inverse));
+                _mm_storeu_ps(ys + i, _mm_mul_ps(y, inverse));
+            }
+            Tail().normalize(xs + i, ys + i, count - i);
+        }
+
+        const Vector2Kernels KERNELS = {"SSE2", Translate, Scale, Transform, Dot, Length, Normalize};
+    }
+
+    const Vector2Kernels *GetVector2KernelsSSE2() {
+        return &KERNELS;
+    }
+
+}
+
+#else
+
+namespace Engine {
+
+    const Vector2Kernels *GetVector2KernelsSSE2() {
+        return nullptr;
+    }
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+//
+// Three-component vector, kept scalar so it packs tightly in arrays;
+// widen to Vector4 for bulk SIMD work.
+//
+
+#pragma once
+
+#include "MathDefs.h"
+#include "Vector2.h"
+
+namespace Engine {
+
+    /**
+     * Represents a 3D point or a vector in space.
+     */
+    class Vector3 {
+    private:
+        float m_x;
+        float m_y;
+        float m_z;
+
+    public:
+        constexpr Vector3() : m_x(0.0f), m_y(0.0f), m_z(0.0f) {}
+        constexpr Vector3(float x, float y, float z) : m_x(x), m_y(y), m_z(z) {}
+        constexpr Vector3(const Vector2 &v, float z) : m_x(v.GetX()), m_y(v.GetY()), m_z(z) {}
+
+        static const Vector3 LEFT;
+        static const Vector3 RIGHT;
+        static const Vector3 UP;
+        static const Vector3 DOWN;
+        static const Vector3 FORWARD;
+        static const Vector3 BACK;
+        static const Vector3 ONE;
+        static const Vector3 ZERO;
+
+        constexpr float GetX() const { return m_x; }
+        constexpr float GetY() const { return m_y; }
+        constexpr float GetZ() const { return m_z; }
+
+        void SetX(float x) { m_x = x; }
+        void SetY(float y) { m_y = y; }
+        void SetZ(float z) { m_z = z; }
+
+        constexpr Vector3 operator+(const Vector3 &rhs) const { return Vector3(m_x + rhs.m_x, m_y + rhs.m_y, m_z + rhs.m_z); }
+        constexpr Vector3 operator-(const Vector3 &rhs) const { return Vector3(m_x - rhs.m_x, m_y - rhs.m_y, m_z - rhs.m_z); }
+        constexpr Vector3 operator-() const { return Vector3(-m_x, -m_y, -m_z); }
+        constexpr Vector3 operator*(float rhs) const { return Vector3(m_x * rhs, m_y * rhs, m_z * rhs); }
+        constexpr Vector3 operator*(const Vector3 &rhs) const { return Vector3(m_x * rhs.m_x, m_y * rhs.m_y, m_z * rhs.m_z); }
+        constexpr Vector3 operator/(float rhs) const { return Vector3(m_x / rhs, m_y / rhs, m_z / rhs); }
+        constexpr Vector3 operator/(const Vector3 &rhs) const { return Vector3(m_x / rhs.m_x, m_y / rhs.m_y, m_z / rhs.m_z); }
+
+        constexpr Vector3 &operator+=(const Vector3 &rhs) { m_x += rhs.m_x; m_y += rhs.m_y; m_z += rhs.m_z; return *this; }
+        constexpr Vector3 &operator-=(const Vector3 &rhs) { m_x -= rhs.m_x; m_y -= rhs.m_y; m_z -= rhs.m_z; return *this; }
+        constexpr Vector3 &operator*=(float rhs) { m_x *= rhs; m_y *= rhs; m_z *= rhs; return *this; }
+        constexpr Vector3 &operator/=(float rhs) { m_x /= rhs; m_y /= rhs; m_z /= rhs; return *this; }
+
+        constexpr bool operator==(const Vector3 &rhs) const { return m_x == rhs.m_x && m_y == rhs.m_y && m_z == rhs.m_z; }
+        constexpr bool operator!=(const Vector3 &rhs) const { return !(*this == rhs); }
+
+        /**
+         * Calculates the dot product with another vector
+         */
+        constexpr float Dot(const Vector3 &rhs) const { return m_x * rhs.m_x + m_y * rhs.m_y + m_z * rhs.m_z; }
+
+        /**
+         * Calculates the cross product with another vector
+         */
+        constexpr Vector3 Cross(const Vector3 &rhs) const {
+            return Vector3(m_y * rhs.m_z - m_z * rhs.m_y, m_z * rhs.m_x - m_x * rhs.m_z, m_x * rhs.m_y - m_y * rhs.m_x);
+        }
+
+        constexpr float LengthSquared() const { return Dot(*this); }
+        float Length() const { return std::sqrt(LengthSquared()); }
+
+        /**
+         * Returns a unit vector in the same direction, or the vector itself if its length is zero
+         */
+        Vector3 Normalized() const {
+            float length = LengthSquared();
+            return length > 0.0f ? *this / std::sqrt(length) : *this;
+        }
+
+        /**
+         * Linear interpolation to another vector
+         */
+        constexpr Vector3 Lerp(const Vector3 &rhs, float t) const { return *this + (rhs - *this) * t; }
+
+        /**
+         * Checks equality with another vector within an epsilon
+         */
+        constexpr bool Equals(const Vector3 &rhs) const {
+            return Engine::Equals(m_x, rhs.m_x) && Engine::Equals(m_y, rhs.m_y) && Engine::Equals(m_z, rhs.m_z);
+        }
+
+        constexpr Vector2 ToVector2() const { return Vector2(m_x, m_y); }
+    };
+
+    constexpr Vector3 operator*(float lhs, const Vector3 &rhs) { return rhs * lhs; }
+
+    inline constexpr Vector3 Vector3::LEFT(-1.0f, 0.0f, 0.0f);
+    inline constexpr Vector3 Vector3::RIGHT(1.0f, 0.0f, 0.0f);
+    inline constexpr Vector3 Vector3::UP(0.0f, 1.0f, 0.0f);
+    inline constexpr Vector3 Vector3::DOWN(0.0f, -1.0f, 0.0f);
+    inline constexpr Vector3 Vector3::FORWARD(0.0f, 0.0f, 1.0f);
+    inline constexpr Vector3 Vector3::BACK(0.0f, 0.0f, -1.0f);
+    inline constexpr Vector3 Vector3::ONE(1.0f, 1.0f, 1.0f);
+    inline constexpr Vector3 Vector3::ZERO(0.0f, 0.0f, 0.0f);
+
+}
@@ -0,0 +1,109 @@
+//
+// Four-component vector stored in one 16-byte aligned SIMD register's worth of floats.
+//
+
+#pragma once
+
+#include "MathDefs.h"
+#include "Simd.h"
+#include "Vector3.h"
+
+namespace Engine {
+
+    /**
+     * Represents a homogeneous point, a direction or any four packed floats.
+     * Construction is constexpr; arithmetic goes through SSE2 or NEON where available.
+     */
+    class alignas(16) Vector4 {
+    private:
+        float m_data[4];
+
+    public:
+        constexpr Vector4() : m_data{0.0f, 0.0f, 0.0f, 0.0f} {}
+        constexpr Vector4(float x, float y, float z, float w) : m_data{x, y, z, w} {}
+        constexpr Vector4(const Vector3 &v, float w) : m_data{v.GetX(), v.GetY(), v.GetZ(), w} {}
+
+        explicit Vector4(Simd::Float4 v) { Simd::Store(m_data, v); }
+
+        static const Vector4 ONE;
+        static const Vector4 ZERO;
+
+        constexpr float GetX() const { return m_data[0]; }
+        constexpr float GetY() const { return m_data[1]; }
+        constexpr float GetZ() const { return m_data[2]; }
+        constexpr float GetW() const { return m_data[3]; }
+
+        void SetX(float x) { m_data[0] = x; }
+        void SetY(float y) { m_data[1] = y; }
+        void SetZ(float z) { m_data[2] = z; }
+        void SetW(float w) { m_data[3] = w; }
+
+        /**
+         * Gets the components as a contiguous array of four floats
+         */
+        const float *Data() const { return m_data; }
+
+        /**
+         * Loads the vector into a SIMD register
+         */
+        Simd::Float4 Load() const { return Simd::Load(m_data); }
+
+        Vector4 operator+(const Vector4 &rhs) const { return Vector4(Simd::Add(Load(), rhs.Load())); }
+        Vector4 operator-(const Vector4 &rhs) const { return Vector4(Simd::Sub(Load(), rhs.Load())); }
+        Vector4 operator-() const { return Vector4(Simd::Sub(Simd::Splat(0.0f), Load())); }
+        Vector4 operator*(float rhs) const { return Vector4(Simd::Mul(Load(), Simd::Splat(rhs))); }
+        Vector4 operator*(const Vector4 &rhs) const { return Vector4(Simd::Mul(Load(), rhs.Load())); }
+        Vector4 operator/(float rhs) const { return Vector4(Simd::Div(Load(), Simd::Splat(rhs))); }
+        Vector4 operator/(const Vector4 &rhs) const { return Vector4(Simd::Div(Load(), rhs.Load())); }
+
+        Vector4 &operator+=(const Vector4 &rhs) { return *this = *this + rhs; }
+        Vector4 &operator-=(const Vector4 &rhs) { return *this = *this - rhs; }
+        Vector4 &operator*=(float rhs) { return *this = *this * rhs; }
+        Vector4 &operator/=(float rhs) { return *this = *this / rhs; }
+
+        constexpr bool operator==(const Vector4 &rhs) const {
+            return m_data[0] == rhs.m_data[0] && m_data[1] == rhs.m_data[1] &&
+                   m_data[2] == rhs.m_data[2] && m_data[3] == rhs.m_data[3];
+        }
+        constexpr bool operator!=(const Vector4 &rhs) const { return !(*this == rhs); }
+
+        /**
+         * Calculates the dot product with another vector
+         */
+        float Dot(const Vector4 &rhs) const { return Simd::Dot(Load(), rhs.Load()); }
+
+        float LengthSquared() const { return Dot(*this); }
+        float Length() const { return std::sqrt(LengthSquared()); }
+
+        /**
+         * Returns a unit vector in the same direction, or the vector itself if its length is zero
+         */
+        Vector4 Normalized() const {
+            float length = LengthSquared();
+            return length > 0.0f ? *this / std::sqrt(length) : *this;
+        }
+
+        /**
+         * Linear interpolation to another vector
+         */
+        Vector4 Lerp(const Vector4 &rhs, float t) const {
+            return Vector4(Simd::MulAdd(Simd::Sub(rhs.Load(), Load()), Simd::Splat(t), Load()));
+        }
+
+        /**
+         * Checks equality with another vector within an epsilon
+         */
+        constexpr bool Equals(const Vector4 &rhs) const {
+            return Engine::Equals(m_data[0], rhs.m_data[0]) && Engine::Equals(m_data[1], rhs.m_data[1]) &&
+                   Engine::Equals(m_data[2], rhs.m_data[2]) && Engine::Equals(m_data[3], rhs.m_data[3]);
+        }
+
+        constexpr Vector3 ToVector3() const { return Vector3(m_data[0], m_data[1], m_data[2]); }
+    };
+
+    inline Vector4 operator*(float lhs, const Vector4 &rhs) { return rhs * lhs; }
+
+    inline constexpr Vector4 Vector4::ONE(1.0f, 1.0f, 1.0f, 1.0f);
+    inline constexpr Vector4 Vector4::ZERO(0.0f, 0.0f, 0.0f, 0.0f);
+
+}
@@ -0,0 +1,278 @@
+//
+// Hierarchical scoped profiler with per-thread lock-free event buffers.
+//
+
+#include "Profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace Engine {
+
+    namespace {
+
+        struct OpenZone {
+            const char *name;
+            uint64_t start;
+            int node;
+        };
+
+        /**
+         * Collector-side state of one thread, only touched by EndFrame()
+         */
+        struct ThreadCollector {
+            std::vector<OpenZone> stack;
+        };
+
+        const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+        std::atomic<ProfileThreadBuffer *> s_threads[Profiler::MAX_THREADS];
+        std::atomic<uint32_t> s_threadCount(0);
+        ThreadCollector s_collectors[Profiler::MAX_THREADS];
+        ProfileFrame s_lastFrame;
+
+        ProfileCaptureListener *s_captureListener = nullptr;
+        std::vector<ProfileEvent> s_captureEvents;
+
+        // Counters as set during the current frame, copied into s_lastFrame by EndFrame()
+        std::vector<ProfileCounter> s_counters;
+
+        thread_local ProfileThreadBuffer *t_buffer = nullptr;
+        thread_local bool t_registered = false;
+
+        ProfileThreadBuffer *GetThreadBuffer() {
+            if (t_registered)
+                return t_buffer;
+
+            t_registered = true;
+            uint32_t index = s_threadCount.fetch_add(1, std::memory_order_relaxed);
+            if (index >= Profiler::MAX_THREADS)
+                return nullptr;
+
+            // Buffers are never freed so the collector cannot race a thread exiting
+            t_buffer = new ProfileThreadBuffer(index);
+            s_threads[index].store(t_buffer, std::memory_order_release);
+            return t_buffer;
+        }
+
+        bool SameName(const char *a, const char *b) {
+            return a == b || std::strcmp(a, b) == 0;
+        }
+
+        int FindOrAddChild(ProfileThreadTree &tree, int parent, const char *name) {
+            std::vector<ProfileNode> &nodes = tree.nodes;
+
+            int last = -1;
+            int child = parent >= 0 ? nodes[parent].firstChild : (nodes.empty() ? -1 : 0);
+            for (; child >= 0; child = nodes[child].nextSibling) {
+                if (SameName(nodes[child].name, name))
+                    return child;
+                last = child;
+            }
+
+            ProfileNode node;
+            node.name = name;
+            node.inclusiveNs = 0;
+            node.calls = 0;
+            node.parent = parent;
+            node.firstChild = -1;
+            node.nextSibling = -1;
+            node.depth = parent >= 0 ? nodes[parent].depth + 1 : 0;
+
+            int index = (int)nodes.size();
+            nodes.push_back(node);
+
+            if (last >= 0)
+                nodes[last].nextSibling = index;
+            else if (parent >= 0)
+                nodes[parent].firstChild = index;
+
+            return index;
+        }
+
+        /**
+         * Creates the nodes for the open zone at \c depth and all its parents
+         * in the current frame's tree
+         */
+        int Materialize(ProfileThreadTree &tree, std::vector<OpenZone> &stack, size_t depth) {
+            OpenZone &zone = stack[depth];
+            if (zone.node < 0) {
+                int parent = depth > 0 ? Materialize(tree, stack, depth - 1) : -1;
+                zone.node = FindOrAddChild(tree, parent, zone.name);
+            }
+            return zone.node;
+        }
+
+        void PrintNode(const std::vector<ProfileNode> &nodes, int index) {
+            for (; index >= 0; index = nodes[index].nextSibling) {
+                const ProfileNode &node = nodes[index];
+                printf("%*s%-32s %9.3f ms  x%u\n", node.depth * 2, "", node.name,
+                       (double)node.inclusiveNs / 1000000.0, node.calls);
+                PrintNode(nodes, node.firstChild);
+            }
+        }
+    }
+
+    std::atomic<bool> Profiler::s_enabled(true);
+
+    ProfileThreadBuffer::ProfileThreadBuffer(uint32_t threadId)
+            : m_head(0), m_tail(0), m_dropped(0), m_openZones(0), m_threadId(threadId) {
+        snprintf(m_name, sizeof(m_name), "Thread %u", threadId);
+    }
+
+    bool ProfileThreadBuffer::PushBegin(const char *name, uint64_t time) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+
+        // Keep room for the end of this zone and of every zone already open,
+        // so a full ring can never leave a zone without its end
+        if (CAPACITY - (head - tail) < m_openZones + 2) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        ProfileEvent &event = m_events[head & (CAPACITY - 1)];
+        event.time = time;
+        event.name = name;
+        event.type = ProfileEventType::Begin;
+        m_head.store(head + 1, std::memory_order_release);
+
+        m_openZones++;
+        return true;
+    }
+
+    void ProfileThreadBuffer::PushEnd(const char *name, uint64_t time) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+
+        ProfileEvent &event = m_events[head & (CAPACITY - 1)];
+        event.time = time;
+        event.name = name;
+        event.type = ProfileEventType::End;
+        m_head.store(head + 1, std::memory_order_release);
+
+        m_openZones--;
+    }
+
+    void ProfileThreadBuffer::SetName(const char *name) {
+        snprintf(m_name, sizeof(m_name), "%s", name);
+    }
+
+    void Profiler::SetEnabled(bool enabled) {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    uint64_t Profiler::Now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - s_epoch).count();
+    }
+
+    void Profiler::SetThreadName(const char *name) {
+        ProfileThreadBuffer *buffer = GetThreadBuffer();
+        if (buffer)
+            buffer->SetName(name);
+    }
+
+    bool Profiler::BeginZone(const char *name) {
+        ProfileThreadBuffer *buffer = GetThreadBuffer();
+        return buffer && buffer->PushBegin(name, Now());
+    }
+
+    void Profiler::EndZone(const char *name) {
+        t_buffer->PushEnd(name, Now());
+    }
+
+    void Profiler::SetCounter(const char *name, int64_t value) {
+        for (ProfileCounter &counter : s_counters) {
+            if (SameName(counter.name, name)) {
+                counter.value = value;
+                return;
+            }
+        }
+        s_counters.push_back({name, value});
+    }
+
+    void Profiler::EndFrame() {
+        uint64_t now = Now();
+        s_lastFrame.index++;
+        s_lastFrame.startNs = s_lastFrame.endNs;
+        s_lastFrame.endNs = now;
+
+        uint32_t count = s_threadCount.load(std::memory_order_relaxed);
+        if (count > MAX_THREADS)
+            count = MAX_THREADS;
+
+        // Thread trees are reused frame to frame so collection does not allocate once warm
+        if (s_lastFrame.threads.size() < count)
+            s_lastFrame.threads.resize(count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            ProfileThreadTree &tree = s_lastFrame.threads[i];
+            std::vector<OpenZone> &stack = s_collectors[i].stack;
+
+            tree.nodes.clear();
+            for (OpenZone &zone : stack)
+                zone.node = -1;
+
+            ProfileThreadBuffer *buffer = s_threads[i].load(std::memory_order_acquire);
+            if (!buffer) {
+                tree.threadId = i;
+                tree.threadName = "";
+                continue;
+            }
+
+            tree.threadId = buffer->GetThreadId();
+            tree.threadName = buffer->GetName();
+
+            s_captureEvents.clear();
+            buffer->Drain([&tree, &stack](const ProfileEvent &event) {
+                if (s_captureListener)
+                    s_captureEvents.push_back(event);
+
+                if (event.type == ProfileEventType::Begin) {
+                    stack.push_back({event.name, event.time, -1});
+                    Materialize(tree, stack, stack.size() - 1);
+                } else if (!stack.empty()) {
+                    // Zones still open at the end of a frame are credited in
+                    // full to the frame in which they close
+                    int node = Materialize(tree, stack, stack.size() - 1);
+                    tree.nodes[node].inclusiveNs += event.time - stack.back().start;
+                    tree.nodes[node].calls++;
+                    stack.pop_back();
+                }
+            });
+
+            if (s_captureListener && !s_captureEvents.empty())
+                s_captureListener->OnThreadEvents(*buffer, s_captureEvents.data(), (uint32_t)s_captureEvents.size());
+        }
+
+        s_lastFrame.counters.assign(s_counters.begin(), s_counters.end());
+
+        if (s_captureListener)
+            s_captureListener->OnFrameEnd(s_lastFrame);
+    }
+
+    void Profiler::SetCaptureListener(ProfileCaptureListener *listener) {
+        s_captureListener = listener;
+    }
+
+    const ProfileFrame &Profiler::GetLastFrame() {
+        return s_lastFrame;
+    }
+
+    void Profiler::PrintLastFrame() {
+        printf("Frame %llu: %.3f ms\n", (unsigned long long)s_lastFrame.index,
+               (double)(s_lastFrame.endNs - s_lastFrame.startNs) / 1000000.0);
+
+        for (const ProfileThreadTree &tree : s_lastFrame.threads) {
+            if (tree.nodes.empty())
+                continue;
+
+            printf("[%s]\n", tree.threadName);
+            PrintNode(tree.nodes, 0);
+        }
+
+        for (const ProfileCounter &counter : s_lastFrame.counters)
+            printf("%-40s %lld\n", counter.name, (long long)counter.value);
+    }
+}
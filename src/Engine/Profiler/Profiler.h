@@ -0,0 +1,236 @@
+//
+// Hierarchical scoped profiler with per-thread lock-free event buffers.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    enum class ProfileEventType : uint8_t {
+        Begin,
+        End
+    };
+
+    /**
+     * A single zone boundary as recorded by the owning thread
+     */
+    struct ProfileEvent {
+        uint64_t time;
+        const char *name;
+        ProfileEventType type;
+    };
+
+    /**
+     * Single-producer single-consumer ring of profile events. The owning
+     * thread is the only writer; the frame collector is the only reader.
+     */
+    class ProfileThreadBuffer {
+    public:
+        static const uint32_t CAPACITY = 1 << 14;
+
+        ProfileThreadBuffer(uint32_t threadId);
+
+        /**
+         * Records the start of a zone. Fails, without recording anything,
+         * when the ring could not also hold the end of every open zone.
+         */
+        bool PushBegin(const char *name, uint64_t time);
+
+        /**
+         * Records the end of a zone whose begin was accepted
+         */
+        void PushEnd(const char *name, uint64_t time);
+
+        /**
+         * Pops every event written so far, oldest first
+         * @return the number of events handed to the callback
+         */
+        template <typename Fn>
+        uint32_t Drain(Fn &&fn);
+
+        uint32_t GetThreadId() const { return m_threadId; }
+        const char *GetName() const { return m_name; }
+        void SetName(const char *name);
+        uint64_t GetDroppedZones() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        ProfileEvent m_events[CAPACITY];
+        std::atomic<uint32_t> m_head;
+        std::atomic<uint32_t> m_tail;
+        std::atomic<uint64_t> m_dropped;
+        uint32_t m_openZones;
+        uint32_t m_threadId;
+        char m_name[32];
+    };
+
+    /**
+     * One zone in a frame's call tree. Zones with the same name under the
+     * same parent are merged.
+     */
+    struct ProfileNode {
+        const char *name;
+        uint64_t inclusiveNs;
+        uint32_t calls;
+        int parent;
+        int firstChild;
+        int nextSibling;
+        int depth;
+    };
+
+    /**
+     * Call tree of one thread for one frame. Roots are linked through
+     * nextSibling starting at node 0.
+     */
+    struct ProfileThreadTree {
+        uint32_t threadId;
+        const char *threadName;
+        std::vector<ProfileNode> nodes;
+    };
+
+    /**
+     * A named value sampled once per frame, such as an allocation count
+     */
+    struct ProfileCounter {
+        const char *name;
+        int64_t value;
+    };
+
+    struct ProfileFrame {
+        uint64_t index;
+        uint64_t startNs;
+        uint64_t endNs;
+        std::vector<ProfileThreadTree> threads;
+        std::vector<ProfileCounter> counters;
+    };
+
+    /**
+     * Receives the raw events of every frame while a capture is running.
+     * Called from the main thread inside Profiler::EndFrame().
+     */
+    class ProfileCaptureListener {
+    public:
+        virtual ~ProfileCaptureListener() {}
+
+        virtual void OnThreadEvents(const ProfileThreadBuffer &thread,
+                                    const ProfileEvent *events, uint32_t count) = 0;
+
+        virtual void OnFrameEnd(const ProfileFrame &frame) = 0;
+    };
+
+    class Profiler {
+    public:
+        static const uint32_t MAX_THREADS = 64;
+
+        /**
+         * Turns event recording on or off at runtime. Zones opened while
+         * enabled are still closed after it is turned off.
+         */
+        static void SetEnabled(bool enabled);
+
+        static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * Gets the profiler clock
+         * @return nanoseconds since the profiler epoch
+         */
+        static uint64_t Now();
+
+        /**
+         * Names the calling thread in captures
+         */
+        static void SetThreadName(const char *name);
+
+        static bool BeginZone(const char *name);
+        static void EndZone(const char *name);
+
+        /**
+         * Sets the value of a counter for the current frame. Counters keep
+         * their last value until set again. Main thread only; the name must
+         * outlive the profiler.
+         */
+        static void SetCounter(const char *name, int64_t value);
+
+        /**
+         * Collects the events of every thread and aggregates them into the
+         * call tree of the frame that just ended. Must be called from the
+         * main thread once per frame.
+         */
+        static void EndFrame();
+
+        /**
+         * Gets the call trees built by the last call to EndFrame()
+         */
+        static const ProfileFrame &GetLastFrame();
+
+        /**
+         * Prints the last frame's call trees to stdout
+         */
+        static void PrintLastFrame();
+
+        /**
+         * Forwards the raw events of every following frame to \c listener,
+         * or stops forwarding when null. Main thread only.
+         */
+        static void SetCaptureListener(ProfileCaptureListener *listener);
+
+    private:
+        static std::atomic<bool> s_enabled;
+    };
+
+    /**
+     * Opens a zone for the lifetime of the object
+     */
+    class ProfileScope {
+    private:
+        const char *m_name;
+        bool m_active;
+
+    public:
+        explicit ProfileScope(const char *name) : m_name(name) {
+            m_active = Profiler::IsEnabled() && Profiler::BeginZone(name);
+        }
+
+        ~ProfileScope() {
+            if (m_active)
+                Profiler::EndZone(m_name);
+        }
+
+        ProfileScope(const ProfileScope &) = delete;
+        ProfileScope &operator=(const ProfileScope &) = delete;
+    };
+
+    template <typename Fn>
+    uint32_t ProfileThreadBuffer::Drain(Fn &&fn) {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        uint32_t count = head - tail;
+
+        for (; tail != head; tail++)
+            fn(m_events[tail & (CAPACITY - 1)]);
+
+        m_tail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENGINE_PROFILER
+    #define PROFILE_SCOPE(name) Engine::ProfileScope PROFILE_CONCAT(__profileScope, __LINE__)(name)
+    #define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+    #define PROFILE_THREAD_NAME(name) Engine::Profiler::SetThreadName(name)
+    #define PROFILE_END_FRAME() Engine::Profiler::EndFrame()
+    #define PROFILE_COUNTER(name, value) Engine::Profiler::SetCounter(name, (int64_t)(value))
+#else
+    #define PROFILE_SCOPE(name)
+    #define PROFILE_FUNCTION()
+    #define PROFILE_THREAD_NAME(name)
+    #define PROFILE_END_FRAME()
+    #define PROFILE_COUNTER(name, value)
+#endif
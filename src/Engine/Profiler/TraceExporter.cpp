@@ -0,0 +1,224 @@
+//
+// Streams profiler captures to disk in the Chrome Trace Event format.
+//
+
+#include "TraceExporter.h"
+
+#include "Memory.h"
+
+#include "ThirdParty/rapidjson/filewritestream.h"
+#include "ThirdParty/rapidjson/writer.h"
+
+#include <vector>
+
+namespace Engine {
+
+    namespace {
+
+        typedef rapidjson::Writer<rapidjson::FileWriteStream> TraceWriter;
+
+        void WriteCommon(TraceWriter &writer, const char *phase, uint64_t timeNs, uint32_t threadId) {
+            writer.Key("ph");
+            writer.String(phase);
+            writer.Key("ts");
+            writer.Double((double)timeNs / 1000.0);
+            writer.Key("pid");
+            writer.Int(1);
+            writer.Key("tid");
+            writer.Uint(threadId);
+        }
+
+        void WriteThreadName(TraceWriter &writer, uint32_t threadId, const std::string &name) {
+            writer.StartObject();
+            writer.Key("name");
+            writer.String("thread_name");
+            WriteCommon(writer, "M", 0, threadId);
+            writer.Key("args");
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(name.c_str(), (rapidjson::SizeType)name.size());
+            writer.EndObject();
+            writer.EndObject();
+        }
+    }
+
+    TraceExporter::TraceExporter() : m_file(nullptr), m_framesLeft(0), m_capturing(false) {
+    }
+
+    TraceExporter::~TraceExporter() {
+        Stop();
+    }
+
+    bool TraceExporter::Start(const std::string &path, uint32_t frames) {
+        if (m_capturing || frames == 0)
+            return false;
+
+        // A previous capture may still be flushing
+        if (m_writer.joinable())
+            m_writer.join();
+
+        m_file = std::fopen(path.c_str(), "wb");
+        if (!m_file) {
+            printf("Unable to open trace file %s\n", path.c_str());
+            return false;
+        }
+
+        m_path = path;
+        m_framesLeft = frames;
+        m_capturing = true;
+        m_writer = std::thread(&TraceExporter::WriterMain, this);
+
+        Profiler::SetCaptureListener(this);
+        return true;
+    }
+
+    void TraceExporter::Stop() {
+        if (m_capturing)
+            Finish();
+
+        if (m_writer.joinable())
+            m_writer.join();
+    }
+
+    void TraceExporter::OnThreadEvents(const ProfileThreadBuffer &thread,
+                                       const ProfileEvent *events, uint32_t count) {
+        std::unique_ptr<Chunk> chunk = AcquireChunk(ChunkType::Events);
+        chunk->threadId = thread.GetThreadId();
+        chunk->threadName = thread.GetName();
+        chunk->events.assign(events, events + count);
+        Submit(std::move(chunk));
+    }
+
+    void TraceExporter::OnFrameEnd(const ProfileFrame &frame) {
+        std::unique_ptr<Chunk> chunk = AcquireChunk(ChunkType::Frame);
+        chunk->frameIndex = frame.index;
+        chunk->frameTime = frame.endNs;
+        chunk->counters.assign(frame.counters.begin(), frame.counters.end());
+        Submit(std::move(chunk));
+
+        if (--m_framesLeft == 0)
+            Finish();
+    }
+
+    std::unique_ptr<TraceExporter::Chunk> TraceExporter::AcquireChunk(ChunkType type) {
+        std::unique_ptr<Chunk> chunk;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_free.empty()) {
+                chunk = std::move(m_free.back());
+                m_free.pop_back();
+            }
+        }
+
+        if (!chunk)
+            chunk.reset(new Chunk());
+
+        chunk->type = type;
+        return chunk;
+    }
+
+    void TraceExporter::Submit(std::unique_ptr<Chunk> chunk) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_pendingSpace.wait(lock, [this] { return m_pending.size() < MAX_PENDING_CHUNKS; });
+        m_pending.push_back(std::move(chunk));
+        m_pendingReady.notify_one();
+    }
+
+    void TraceExporter::Finish() {
+        Profiler::SetCaptureListener(nullptr);
+        m_capturing = false;
+        Submit(AcquireChunk(ChunkType::Finish));
+    }
+
+    void TraceExporter::WriterMain() {
+        MemoryTagScope memoryTag(MemoryTag::Profiler);
+
+        char buffer[64 * 1024];
+        rapidjson::FileWriteStream stream(m_file, buffer, sizeof(buffer));
+        TraceWriter writer(stream);
+
+        // Name of each thread as last written, so metadata is only emitted on change
+        std::vector<std::string> threadNames;
+
+        writer.StartObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ns");
+        writer.Key("traceEvents");
+        writer.StartArray();
+
+        bool done = false;
+        while (!done) {
+            std::unique_ptr<Chunk> chunk;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_pendingReady.wait(lock, [this] { return !m_pending.empty(); });
+                chunk = std::move(m_pending.front());
+                m_pending.pop_front();
+                m_pendingSpace.notify_one();
+            }
+
+            switch (chunk->type) {
+                case ChunkType::Events:
+                    if (threadNames.size() <= chunk->threadId)
+                        threadNames.resize(chunk->threadId + 1);
+
+                    if (threadNames[chunk->threadId] != chunk->threadName) {
+                        threadNames[chunk->threadId] = chunk->threadName;
+                        WriteThreadName(writer, chunk->threadId, chunk->threadName);
+                    }
+
+                    for (const ProfileEvent &event : chunk->events) {
+                        writer.StartObject();
+                        writer.Key("name");
+                        writer.String(event.name);
+                        WriteCommon(writer, event.type == ProfileEventType::Begin ? "B" : "E",
+                                    event.time, chunk->threadId);
+                        writer.EndObject();
+                    }
+                    break;
+
+                case ChunkType::Frame: {
+                    char name[32];
+                    int length = snprintf(name, sizeof(name), "Frame %llu", (unsigned long long)chunk->frameIndex);
+
+                    writer.StartObject();
+                    writer.Key("name");
+                    writer.String(name, (rapidjson::SizeType)length);
+                    WriteCommon(writer, "i", chunk->frameTime, 0);
+                    writer.Key("s");
+                    writer.String("g");
+                    writer.EndObject();
+
+                    for (const ProfileCounter &counter : chunk->counters) {
+                        writer.StartObject();
+                        writer.Key("name");
+                        writer.String(counter.name);
+                        WriteCommon(writer, "C", chunk->frameTime, 0);
+                        writer.Key("args");
+                        writer.StartObject();
+                        writer.Key("value");
+                        writer.Int64(counter.value);
+                        writer.EndObject();
+                        writer.EndObject();
+                    }
+                    break;
+                }
+
+                case ChunkType::Finish:
+                    done = true;
+                    break;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free.push_back(std::move(chunk));
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+        stream.Flush();
+
+        std::fclose(m_file);
+        m_file = nullptr;
+        printf("Trace written to %s\n", m_path.c_str());
+    }
+}
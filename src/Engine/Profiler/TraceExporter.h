@@ -0,0 +1,93 @@
+//
+// Streams profiler captures to disk in the Chrome Trace Event format.
+//
+
+#pragma once
+
+#include "Profiler.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Engine {
+
+    /**
+     * Captures a number of frames of profiler events and writes them as
+     * Chrome Trace Event JSON, loadable in chrome://tracing or Perfetto.
+     *
+     * Events are handed per frame to a background thread which streams
+     * them straight into the file with rapidjson's Writer, so memory use
+     * is bounded by the handoff queue rather than by the capture length.
+     */
+    class TraceExporter : public ProfileCaptureListener {
+    public:
+        /**
+         * Maximum number of event chunks waiting for the writer thread.
+         * EndFrame() blocks when the writer falls this far behind.
+         */
+        static const size_t MAX_PENDING_CHUNKS = 64;
+
+        TraceExporter();
+        ~TraceExporter() override;
+
+        /**
+         * Starts capturing the next \c frames frames into \c path.
+         * Waits for any previous capture to finish writing first.
+         * @return false if a capture is running or the file could not be opened
+         */
+        bool Start(const std::string &path, uint32_t frames);
+
+        /**
+         * Ends the capture early, if one is running, and waits for the
+         * file to be completely written
+         */
+        void Stop();
+
+        bool IsCapturing() const { return m_capturing; }
+
+        void OnThreadEvents(const ProfileThreadBuffer &thread,
+                            const ProfileEvent *events, uint32_t count) override;
+
+        void OnFrameEnd(const ProfileFrame &frame) override;
+
+    private:
+        enum class ChunkType {
+            Events,
+            Frame,
+            Finish
+        };
+
+        struct Chunk {
+            ChunkType type;
+            uint32_t threadId;
+            std::string threadName;
+            uint64_t frameIndex;
+            uint64_t frameTime;
+            std::vector<ProfileEvent> events;
+            std::vector<ProfileCounter> counters;
+        };
+
+        std::unique_ptr<Chunk> AcquireChunk(ChunkType type);
+        void Submit(std::unique_ptr<Chunk> chunk);
+        void Finish();
+        void WriterMain();
+
+        std::mutex m_mutex;
+        std::condition_variable m_pendingReady;
+        std::condition_variable m_pendingSpace;
+        std::deque<std::unique_ptr<Chunk>> m_pending;
+        std::vector<std::unique_ptr<Chunk>> m_free;
+
+        std::thread m_writer;
+        std::FILE *m_file;
+        std::string m_path;
+        uint32_t m_framesLeft;
+        bool m_capturing;
+    };
+
+}
@@ -0,0 +1,32 @@
+//
+// Table of the OpenGL entry points that go through the engine's state cache.
+//
+
+#include "GLFunctions.h"
+
+namespace Engine {
+
+    GLFunctions LoadGLFunctions() {
+        GLFunctions functions;
+
+        // OpenGL 1.1 functions are exported by the system library, the rest are GLEW's pointers
+        functions.Enable = glEnable;
+        functions.Disable = glDisable;
+        functions.IsEnabled = glIsEnabled;
+        functions.BlendFunc = glBlendFunc;
+        functions.DepthFunc = glDepthFunc;
+        functions.DepthMask = glDepthMask;
+        functions.UseProgram = glUseProgram;
+        functions.ActiveTexture = glActiveTexture;
+        functions.BindTexture = glBindTexture;
+        functions.BindBuffer = glBindBuffer;
+        functions.BindVertexArray = glBindVertexArray;
+        functions.ClearColor = glClearColor;
+        functions.Clear = glClear;
+        functions.Viewport = glViewport;
+        functions.GetIntegerv = glGetIntegerv;
+        functions.GetFloatv = glGetFloatv;
+        return functions;
+    }
+
+}
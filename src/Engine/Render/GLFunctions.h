@@ -0,0 +1,40 @@
+//
+// Table of the OpenGL entry points that go through the engine's state cache.
+//
+
+#pragma once
+
+#include "ThirdParty/GLEW/include/glew.h"
+
+namespace Engine {
+
+    /**
+     * The GL functions GLStateCache calls, gathered in one place so the
+     * cache can run against a mock driver. Members drop the gl prefix,
+     * since GLEW defines most gl names as macros.
+     */
+    struct GLFunctions {
+        void(GLAPIENTRY *Enable)(GLenum cap);
+        void(GLAPIENTRY *Disable)(GLenum cap);
+        GLboolean(GLAPIENTRY *IsEnabled)(GLenum cap);
+        void(GLAPIENTRY *BlendFunc)(GLenum source, GLenum destination);
+        void(GLAPIENTRY *DepthFunc)(GLenum function);
+        void(GLAPIENTRY *DepthMask)(GLboolean flag);
+        void(GLAPIENTRY *UseProgram)(GLuint program);
+        void(GLAPIENTRY *ActiveTexture)(GLenum unit);
+        void(GLAPIENTRY *BindTexture)(GLenum target, GLuint texture);
+        void(GLAPIENTRY *BindBuffer)(GLenum target, GLuint buffer);
+        void(GLAPIENTRY *BindVertexArray)(GLuint array);
+        void(GLAPIENTRY *ClearColor)(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+        void(GLAPIENTRY *Clear)(GLbitfield mask);
+        void(GLAPIENTRY *Viewport)(GLint x, GLint y, GLsizei width, GLsizei height);
+        void(GLAPIENTRY *GetIntegerv)(GLenum name, GLint *values);
+        void(GLAPIENTRY *GetFloatv)(GLenum name, GLfloat *values);
+    };
+
+    /**
+     * Gets the driver's entry points for the current context. Call after glewInit().
+     */
+    GLFunctions LoadGLFunctions();
+
+}
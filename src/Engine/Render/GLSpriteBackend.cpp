@@ -0,0 +1,108 @@
+//
+// Sprite backend drawing through OpenGL from a streaming vertex ring.
+//
+
+#include "GLSpriteBackend.h"
+
+#include "GLStateCache.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Engine {
+
+    GLSpriteBackend::GLSpriteBackend(GLStateCache &state)
+        : m_state(state), m_ring(state), m_vertexArray(0), m_indexBuffer(0), m_baseVertex(0) {}
+
+    void GLSpriteBackend::Create(uint32_t maxQuadsPerFrame, bool allowPersistent) {
+        Destroy();
+        m_ring.Create(maxQuadsPerFrame * 4 * (uint32_t)sizeof(RenderVertex), allowPersistent);
+
+        // Every draw starts at index 0 and moves through the ring with its base vertex instead
+        std::vector<uint16_t> indices(MAX_QUADS_PER_DRAW * 6);
+        for (uint32_t quad = 0; quad < MAX_QUADS_PER_DRAW; quad++) {
+            uint16_t corner = (uint16_t)(quad * 4);
+            uint16_t *triangles = &indices[quad * 6];
+            triangles[0] = corner;
+            triangles[1] = corner + 1;
+            triangles[2] = corner + 2;
+            triangles[3] = corner;
+            triangles[4] = corner + 2;
+            triangles[5] = corner + 3;
+        }
+
+        glGenVertexArrays(1, &m_vertexArray);
+        m_state.BindVertexArray(m_vertexArray);
+
+        // The element array binding is part of the vertex array
+        glGenBuffers(1, &m_indexBuffer);
+        m_state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+
+        m_state.BindBuffer(GL_ARRAY_BUFFER, m_ring.GetBuffer());
+        GLsizei stride = sizeof(RenderVertex);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (const void *)offsetof(RenderVertex, x));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (const void *)offsetof(RenderVertex, u));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (const void *)offsetof(RenderVertex, color));
+    }
+
+    void GLSpriteBackend::Destroy() {
+        m_ring.Destroy();
+        if (m_indexBuffer) {
+            glDeleteBuffers(1, &m_indexBuffer);
+            m_state.OnBufferDeleted(m_indexBuffer);
+            m_indexBuffer = 0;
+        }
+        if (m_vertexArray) {
+            glDeleteVertexArrays(1, &m_vertexArray);
+            m_state.OnVertexArrayDeleted(m_vertexArray);
+            m_vertexArray = 0;
+        }
+    }
+
+    RenderVertex *GLSpriteBackend::MapQuads(uint32_t quadCount) {
+        uint32_t offset;
+        void *memory = m_ring.Map(quadCount * 4 * (uint32_t)sizeof(RenderVertex), offset);
+        if (!memory)
+            return nullptr;
+        m_baseVertex = (GLint)(offset / sizeof(RenderVertex));
+        return (RenderVertex *)memory;
+    }
+
+    void GLSpriteBackend::UnmapQuads() {
+        m_ring.Unmap();
+    }
+
+    void GLSpriteBackend::DrawQuads(uint32_t shader, uint32_t texture, BlendMode blend, uint32_t firstQuad,
+                                    uint32_t quadCount) {
+        m_state.UseProgram(shader);
+        m_state.ActiveTexture(GL_TEXTURE0);
+        m_state.BindTexture(GL_TEXTURE_2D, texture);
+        switch (blend) {
+        case BlendMode::Opaque:
+            m_state.Disable(GL_BLEND);
+            break;
+        case BlendMode::Alpha:
+            m_state.Enable(GL_BLEND);
+            m_state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case BlendMode::Additive:
+            m_state.Enable(GL_BLEND);
+            m_state.BlendFunc(GL_SRC_ALPHA, GL_ONE);
+            break;
+        }
+        m_state.BindVertexArray(m_vertexArray);
+
+        while (quadCount > 0) {
+            uint32_t count = quadCount < MAX_QUADS_PER_DRAW ? quadCount : MAX_QUADS_PER_DRAW;
+            glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(count * 6), GL_UNSIGNED_SHORT, nullptr,
+                                     m_baseVertex + (GLint)(firstQuad * 4));
+            firstQuad += count;
+            quadCount -= count;
+        }
+    }
+
+}
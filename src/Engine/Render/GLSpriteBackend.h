@@ -0,0 +1,67 @@
+//
+// Sprite backend drawing through OpenGL from a streaming vertex ring.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "GLVertexRing.h"
+#include "SpriteBackend.h"
+
+namespace Engine {
+
+    class GLStateCache;
+
+    /**
+     * Streams quads into a GLVertexRing and draws them with one shared
+     * index buffer and glDrawElementsBaseVertex, so a mapping costs 4
+     * vertices per quad and no index uploads. State goes through the
+     * GLStateCache, so runs that share a program or texture bind it once.
+     *
+     * Shaders are GL program names whose vertex inputs are the position
+     * at location 0, texture coordinates at 1 and the normalized color at
+     * 2; their uniforms are left to the caller. Textures are GL texture
+     * names and are bound to unit 0.
+     */
+    class GLSpriteBackend : public SpriteBackend {
+    public:
+        // 16-bit indices reach 65536 vertices past the base vertex
+        static const uint32_t MAX_QUADS_PER_DRAW = 16384;
+
+        explicit GLSpriteBackend(GLStateCache &state);
+
+        GLSpriteBackend(const GLSpriteBackend &) = delete;
+        GLSpriteBackend &operator=(const GLSpriteBackend &) = delete;
+
+        /**
+         * Creates the vertex ring, index buffer and vertex array. Call after glewInit().
+         * @param maxQuadsPerFrame the most quads all mappings of one frame may add up to
+         */
+        void Create(uint32_t maxQuadsPerFrame, bool allowPersistent = true);
+
+        void Destroy();
+
+        RenderVertex *MapQuads(uint32_t quadCount) override;
+        void UnmapQuads() override;
+        void DrawQuads(uint32_t shader, uint32_t texture, BlendMode blend, uint32_t firstQuad,
+                       uint32_t quadCount) override;
+
+        /**
+         * Fences the frame's vertices. Call once per frame, after the last DrawQuads().
+         */
+        void EndFrame() { m_ring.EndFrame(); }
+
+        const GLVertexRing &GetRing() const { return m_ring; }
+
+    private:
+        GLStateCache &m_state;
+        GLVertexRing m_ring;
+        GLuint m_vertexArray;
+        GLuint m_indexBuffer;
+
+        // First vertex of the last mapping in the ring buffer
+        GLint m_baseVertex;
+    };
+
+}
@@ -0,0 +1,354 @@
+//
+// Shadow of the OpenGL state that drops calls which would change nothing.
+//
+
+#include "GLStateCache.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Engine {
+
+    const GLenum GLStateCache::CAPS[CAP_COUNT] = {GL_BLEND,        GL_DEPTH_TEST,          GL_CULL_FACE,
+                                                  GL_SCISSOR_TEST, GL_STENCIL_TEST,        GL_POLYGON_OFFSET_FILL,
+                                                  GL_FRAMEBUFFER_SRGB};
+
+    GLStateCache::GLStateCache() : m_validating(false), m_frame(), m_lastIssued(0), m_lastFiltered(0) {
+        std::memset(&m_gl, 0, sizeof(m_gl));
+        Invalidate();
+    }
+
+    void GLStateCache::SetFunctions(const GLFunctions &functions) {
+        m_gl = functions;
+        Invalidate();
+    }
+
+    void GLStateCache::Invalidate() {
+        for (int i = 0; i < CAP_COUNT; i++)
+            m_caps[i] = -1;
+        m_blendSource = UNKNOWN;
+        m_blendDestination = UNKNOWN;
+        m_depthFunction = UNKNOWN;
+        m_depthWrite = -1;
+        m_program = UNKNOWN;
+        m_activeUnit = UNKNOWN;
+        for (uint32_t i = 0; i < MAX_TEXTURE_UNITS; i++)
+            m_textures[i] = UNKNOWN;
+        m_arrayBuffer = UNKNOWN;
+        m_elementBuffer = UNKNOWN;
+        m_vertexArray = UNKNOWN;
+        m_clearColorKnown = false;
+        m_viewportKnown = false;
+    }
+
+    int GLStateCache::FindCap(GLenum cap) {
+        for (int i = 0; i < CAP_COUNT; i++) {
+            if (CAPS[i] == cap)
+                return i;
+        }
+        return -1;
+    }
+
+    void GLStateCache::SetCap(GLenum cap, bool enabled) {
+        int index = FindCap(cap);
+        if (index >= 0) {
+            if (m_validating)
+                CheckCap(index);
+            if (!Changes(m_caps[index] != (int8_t)enabled))
+                return;
+            m_caps[index] = (int8_t)enabled;
+        } else {
+            m_frame.issued++;
+        }
+
+        if (enabled)
+            m_gl.Enable(cap);
+        else
+            m_gl.Disable(cap);
+    }
+
+    void GLStateCache::Enable(GLenum cap) {
+        SetCap(cap, true);
+    }
+
+    void GLStateCache::Disable(GLenum cap) {
+        SetCap(cap, false);
+    }
+
+    void GLStateCache::BlendFunc(GLenum source, GLenum destination) {
+        if (m_validating) {
+            CheckInteger(GL_BLEND_SRC_RGB, "GL_BLEND_SRC_RGB", m_blendSource);
+            CheckInteger(GL_BLEND_DST_RGB, "GL_BLEND_DST_RGB", m_blendDestination);
+        }
+        if (!Changes(m_blendSource != source || m_blendDestination != destination))
+            return;
+
+        m_blendSource = source;
+        m_blendDestination = destination;
+        m_gl.BlendFunc(source, destination);
+    }
+
+    void GLStateCache::DepthFunc(GLenum function) {
+        if (m_validating)
+            CheckInteger(GL_DEPTH_FUNC, "GL_DEPTH_FUNC", m_depthFunction);
+        if (!Changes(m_depthFunction != function))
+            return;
+
+        m_depthFunction = function;
+        m_gl.DepthFunc(function);
+    }
+
+    void GLStateCache::DepthMask(bool write) {
+        if (m_validating)
+            CheckInteger(GL_DEPTH_WRITEMASK, "GL_DEPTH_WRITEMASK", m_depthWrite < 0 ? UNKNOWN : m_depthWrite);
+        if (!Changes(m_depthWrite != (int8_t)write))
+            return;
+
+        m_depthWrite = (int8_t)write;
+        m_gl.DepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void GLStateCache::UseProgram(GLuint program) {
+        if (m_validating)
+            CheckInteger(GL_CURRENT_PROGRAM, "GL_CURRENT_PROGRAM", m_program);
+        if (!Changes(m_program != program))
+            return;
+
+        m_program = program;
+        m_gl.UseProgram(program);
+    }
+
+    void GLStateCache::ActiveTexture(GLenum unit) {
+        if (m_validating)
+            CheckInteger(GL_ACTIVE_TEXTURE, "GL_ACTIVE_TEXTURE", m_activeUnit);
+        if (!Changes(m_activeUnit != unit))
+            return;
+
+        m_activeUnit = unit;
+        m_gl.ActiveTexture(unit);
+    }
+
+    void GLStateCache::BindTexture(GLenum target, GLuint texture) {
+        // Binds to an unknown unit could never be filtered, so ask once which unit is active
+        if (m_activeUnit == UNKNOWN) {
+            GLint active = GL_TEXTURE0;
+            m_gl.GetIntegerv(GL_ACTIVE_TEXTURE, &active);
+            m_activeUnit = (GLenum)active;
+        }
+
+        uint32_t unit = m_activeUnit - GL_TEXTURE0;
+        if (target != GL_TEXTURE_2D || unit >= MAX_TEXTURE_UNITS) {
+            m_frame.issued++;
+            m_gl.BindTexture(target, texture);
+            return;
+        }
+
+        if (m_validating)
+            CheckInteger(GL_TEXTURE_BINDING_2D, "GL_TEXTURE_BINDING_2D", m_textures[unit]);
+        if (!Changes(m_textures[unit] != texture))
+            return;
+
+        m_textures[unit] = texture;
+        m_gl.BindTexture(target, texture);
+    }
+
+    void GLStateCache::BindBuffer(GLenum target, GLuint buffer) {
+        uint32_t *shadow = nullptr;
+        if (target == GL_ARRAY_BUFFER) {
+            shadow = &m_arrayBuffer;
+            if (m_validating)
+                CheckInteger(GL_ARRAY_BUFFER_BINDING, "GL_ARRAY_BUFFER_BINDING", m_arrayBuffer);
+        } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+            shadow = &m_elementBuffer;
+            if (m_validating)
+                CheckInteger(GL_ELEMENT_ARRAY_BUFFER_BINDING, "GL_ELEMENT_ARRAY_BUFFER_BINDING", m_elementBuffer);
+        }
+
+        if (shadow) {
+            if (!Changes(*shadow != buffer))
+                return;
+            *shadow = buffer;
+        } else {
+            m_frame.issued++;
+        }
+        m_gl.BindBuffer(target, buffer);
+    }
+
+    void GLStateCache::BindVertexArray(GLuint array) {
+        if (m_validating)
+            CheckInteger(GL_VERTEX_ARRAY_BINDING, "GL_VERTEX_ARRAY_BINDING", m_vertexArray);
+        if (!Changes(m_vertexArray != array))
+            return;
+
+        m_vertexArray = array;
+        m_elementBuffer = UNKNOWN;
+        m_gl.BindVertexArray(array);
+    }
+
+    void GLStateCache::ClearColor(float red, float green, float blue, float alpha) {
+        if (m_validating)
+            CheckClearColor();
+
+        bool same = m_clearColorKnown && m_clearColor[0] == red && m_clearColor[1] == green &&
+                    m_clearColor[2] == blue && m_clearColor[3] == alpha;
+        if (!Changes(!same))
+            return;
+
+        m_clearColorKnown = true;
+        m_clearColor[0] = red;
+        m_clearColor[1] = green;
+        m_clearColor[2] = blue;
+        m_clearColor[3] = alpha;
+        m_gl.ClearColor(red, green, blue, alpha);
+    }
+
+    void GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        if (m_validating)
+            CheckViewport();
+
+        bool same = m_viewportKnown && m_viewport[0] == x && m_viewport[1] == y && m_viewport[2] == width &&
+                    m_viewport[3] == height;
+        if (!Changes(!same))
+            return;
+
+        m_viewportKnown = true;
+        m_viewport[0] = x;
+        m_viewport[1] = y;
+        m_viewport[2] = width;
+        m_viewport[3] = height;
+        m_gl.Viewport(x, y, width, height);
+    }
+
+    void GLStateCache::Clear(GLbitfield mask) {
+        m_frame.issued++;
+        m_gl.Clear(mask);
+    }
+
+    void GLStateCache::OnTextureDeleted(GLuint texture) {
+        for (uint32_t i = 0; i < MAX_TEXTURE_UNITS; i++) {
+            if (m_textures[i] == texture)
+                m_textures[i] = 0;
+        }
+    }
+
+    void GLStateCache::OnBufferDeleted(GLuint buffer) {
+        if (m_arrayBuffer == buffer)
+            m_arrayBuffer = 0;
+        if (m_elementBuffer == buffer)
+            m_elementBuffer = 0;
+    }
+
+    void GLStateCache::OnVertexArrayDeleted(GLuint array) {
+        if (m_vertexArray == array) {
+            m_vertexArray = 0;
+            m_elementBuffer = UNKNOWN;
+        }
+    }
+
+    uint32_t GLStateCache::CheckInteger(GLenum name, const char *label, uint32_t shadow) {
+        if (shadow == UNKNOWN)
+            return 0;
+
+        GLint value = 0;
+        m_gl.GetIntegerv(name, &value);
+        if ((uint32_t)value == shadow)
+            return 0;
+
+        printf("GL state cache: %s is 0x%x but the cache holds 0x%x\n", label, (unsigned)value, (unsigned)shadow);
+        return 1;
+    }
+
+    uint32_t GLStateCache::CheckCap(int index) {
+        if (m_caps[index] < 0)
+            return 0;
+
+        bool enabled = m_gl.IsEnabled(CAPS[index]) == GL_TRUE;
+        if (enabled == (m_caps[index] == 1))
+            return 0;
+
+        printf("GL state cache: cap 0x%x is %s but the cache holds it %s\n", (unsigned)CAPS[index],
+               enabled ? "enabled" : "disabled", enabled ? "disabled" : "enabled");
+        return 1;
+    }
+
+    uint32_t GLStateCache::CheckTextures() {
+        if (m_activeUnit == UNKNOWN)
+            return 0;
+
+        // Visiting the other units goes around the cache, then puts the active unit back
+        uint32_t mismatches = 0;
+        for (uint32_t i = 0; i < MAX_TEXTURE_UNITS; i++) {
+            if (m_textures[i] == UNKNOWN)
+                continue;
+            m_gl.ActiveTexture(GL_TEXTURE0 + i);
+            mismatches += CheckInteger(GL_TEXTURE_BINDING_2D, "GL_TEXTURE_BINDING_2D", m_textures[i]);
+        }
+        m_gl.ActiveTexture(m_activeUnit);
+        return mismatches;
+    }
+
+    uint32_t GLStateCache::CheckClearColor() {
+        if (!m_clearColorKnown)
+            return 0;
+
+        GLfloat value[4] = {};
+        m_gl.GetFloatv(GL_COLOR_CLEAR_VALUE, value);
+        if (std::memcmp(value, m_clearColor, sizeof(value)) == 0)
+            return 0;
+
+        printf("GL state cache: GL_COLOR_CLEAR_VALUE is (%g, %g, %g, %g) but the cache holds (%g, %g, %g, %g)\n",
+               value[0], value[1], value[2], value[3], m_clearColor[0], m_clearColor[1], m_clearColor[2],
+               m_clearColor[3]);
+        return 1;
+    }
+
+    uint32_t GLStateCache::CheckViewport() {
+        if (!m_viewportKnown)
+            return 0;
+
+        GLint value[4] = {};
+        m_gl.GetIntegerv(GL_VIEWPORT, value);
+        if (std::memcmp(value, m_viewport, sizeof(value)) == 0)
+            return 0;
+
+        printf("GL state cache: GL_VIEWPORT is (%d, %d, %d, %d) but the cache holds (%d, %d, %d, %d)\n", value[0],
+               value[1], value[2], value[3], m_viewport[0], m_viewport[1], m_viewport[2], m_viewport[3]);
+        return 1;
+    }
+
+    uint32_t GLStateCache::Validate() {
+        uint32_t mismatches = 0;
+        for (int i = 0; i < CAP_COUNT; i++)
+            mismatches += CheckCap(i);
+        mismatches += CheckInteger(GL_BLEND_SRC_RGB, "GL_BLEND_SRC_RGB", m_blendSource);
+        mismatches += CheckInteger(GL_BLEND_DST_RGB, "GL_BLEND_DST_RGB", m_blendDestination);
+        mismatches += CheckInteger(GL_DEPTH_FUNC, "GL_DEPTH_FUNC", m_depthFunction);
+        mismatches += CheckInteger(GL_DEPTH_WRITEMASK, "GL_DEPTH_WRITEMASK", m_depthWrite < 0 ? UNKNOWN : m_depthWrite);
+        mismatches += CheckInteger(GL_CURRENT_PROGRAM, "GL_CURRENT_PROGRAM", m_program);
+        mismatches += CheckInteger(GL_ACTIVE_TEXTURE, "GL_ACTIVE_TEXTURE", m_activeUnit);
+        mismatches += CheckTextures();
+        mismatches += CheckInteger(GL_ARRAY_BUFFER_BINDING, "GL_ARRAY_BUFFER_BINDING", m_arrayBuffer);
+        mismatches += CheckInteger(GL_ELEMENT_ARRAY_BUFFER_BINDING, "GL_ELEMENT_ARRAY_BUFFER_BINDING", m_elementBuffer);
+        mismatches += CheckInteger(GL_VERTEX_ARRAY_BINDING, "GL_VERTEX_ARRAY_BINDING", m_vertexArray);
+        mismatches += CheckClearColor();
+        mismatches += CheckViewport();
+        return mismatches;
+    }
+
+    void GLStateCache::EndFrame() {
+        if (m_validating)
+            Validate();
+
+        m_lastIssued.store(m_frame.issued, std::memory_order_relaxed);
+        m_lastFiltered.store(m_frame.filtered, std::memory_order_relaxed);
+        m_frame = GLStateStats();
+    }
+
+    GLStateStats GLStateCache::GetLastFrameStats() const {
+        GLStateStats stats;
+        stats.issued = m_lastIssued.load(std::memory_order_relaxed);
+        stats.filtered = m_lastFiltered.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+}
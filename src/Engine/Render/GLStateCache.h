@@ -0,0 +1,167 @@
+//
+// Shadow of the OpenGL state that drops calls which would change nothing.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "GLFunctions.h"
+
+namespace Engine {
+
+    struct GLStateStats {
+        // Calls passed on to the driver, and calls dropped because the state already matched
+        uint32_t issued;
+        uint32_t filtered;
+    };
+
+    /**
+     * Keeps a copy of the GL state the engine sets and only calls the driver
+     * when a setter would change it. State starts out unknown, so the first
+     * call of each setter always goes through. The one exception is the
+     * active texture unit: BindTexture() reads it back from the driver
+     * once, so binds are filtered even if ActiveTexture() is never called.
+     *
+     * The cache belongs to one context and is used by whichever thread has
+     * that context current. GL code that bypasses the cache must call
+     * Invalidate() afterwards. Deleting a bound texture, buffer or vertex
+     * array unbinds it, so the matching OnDeleted call must follow. A
+     * deleted program stays in use until replaced and needs nothing.
+     *
+     * With validation on, every setter first reads the state back with
+     * glGet* and reports shadow values the driver disagrees with, and
+     * EndFrame() checks the whole shadow. This costs a driver round trip
+     * per call and is meant for debugging only.
+     */
+    class GLStateCache {
+    public:
+        static const uint32_t MAX_TEXTURE_UNITS = 16;
+
+        GLStateCache();
+
+        GLStateCache(const GLStateCache &) = delete;
+        GLStateCache &operator=(const GLStateCache &) = delete;
+
+        /**
+         * Starts calling through \c functions, forgetting every shadowed value
+         */
+        void SetFunctions(const GLFunctions &functions);
+
+        /**
+         * Forgets every shadowed value, so each setter calls the driver next time
+         */
+        void Invalidate();
+
+        void SetValidation(bool enabled) { m_validating = enabled; }
+        bool IsValidating() const { return m_validating; }
+
+        /**
+         * Caps other than blending, depth test, face culling, scissor and
+         * stencil test, polygon offset and sRGB framebuffers pass straight through
+         */
+        void Enable(GLenum cap);
+        void Disable(GLenum cap);
+
+        void BlendFunc(GLenum source, GLenum destination);
+        void DepthFunc(GLenum function);
+        void DepthMask(bool write);
+        void UseProgram(GLuint program);
+        void ActiveTexture(GLenum unit);
+
+        /**
+         * Only GL_TEXTURE_2D is shadowed, per texture unit
+         */
+        void BindTexture(GLenum target, GLuint texture);
+
+        /**
+         * Only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are shadowed. The
+         * element array binding belongs to the vertex array object and is
+         * forgotten whenever that changes.
+         */
+        void BindBuffer(GLenum target, GLuint buffer);
+
+        void BindVertexArray(GLuint array);
+        void ClearColor(float red, float green, float blue, float alpha);
+        void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+        /**
+         * Not state, so never filtered; counted as issued
+         */
+        void Clear(GLbitfield mask);
+
+        void OnTextureDeleted(GLuint texture);
+        void OnBufferDeleted(GLuint buffer);
+        void OnVertexArrayDeleted(GLuint array);
+
+        /**
+         * Compares every known shadowed value with what glGet* reports and
+         * prints the differences
+         * @return the number of differences
+         */
+        uint32_t Validate();
+
+        /**
+         * Closes the per-frame counters, validating first when validation is on
+         */
+        void EndFrame();
+
+        /**
+         * Gets the counters of the frame closed by the last EndFrame(). Any thread.
+         */
+        GLStateStats GetLastFrameStats() const;
+
+    private:
+        static const uint32_t UNKNOWN = 0xFFFFFFFF;
+        static const int CAP_COUNT = 7;
+        static const GLenum CAPS[CAP_COUNT];
+
+        GLFunctions m_gl;
+        bool m_validating;
+
+        // 1 enabled, 0 disabled, -1 unknown
+        int8_t m_caps[CAP_COUNT];
+        uint32_t m_blendSource;
+        uint32_t m_blendDestination;
+        uint32_t m_depthFunction;
+        int8_t m_depthWrite;
+        uint32_t m_program;
+        uint32_t m_activeUnit;
+        uint32_t m_textures[MAX_TEXTURE_UNITS];
+        uint32_t m_arrayBuffer;
+        uint32_t m_elementBuffer;
+        uint32_t m_vertexArray;
+        bool m_clearColorKnown;
+        float m_clearColor[4];
+        bool m_viewportKnown;
+        GLint m_viewport[4];
+
+        GLStateStats m_frame;
+        std::atomic<uint32_t> m_lastIssued;
+        std::atomic<uint32_t> m_lastFiltered;
+
+        static int FindCap(GLenum cap);
+        void SetCap(GLenum cap, bool enabled);
+
+        /**
+         * Counts a setter call
+         * @return true if it has to reach the driver
+         */
+        bool Changes(bool differs) {
+            if (differs)
+                m_frame.issued++;
+            else
+                m_frame.filtered++;
+            return differs;
+        }
+
+        // Validation: reports when the driver's value isn't the known shadow value
+        uint32_t CheckInteger(GLenum name, const char *label, uint32_t shadow);
+        uint32_t CheckCap(int index);
+        uint32_t CheckTextures();
+        uint32_t CheckClearColor();
+        uint32_t CheckViewport();
+    };
+
+}
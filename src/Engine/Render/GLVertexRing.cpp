@@ -0,0 +1,154 @@
+//
+// Streaming vertex memory for geometry rebuilt every frame.
+//
+
+#include "GLVertexRing.h"
+
+#include "GLStateCache.h"
+
+#include <cstdio>
+
+namespace Engine {
+
+    namespace {
+
+        // How long one glClientWaitSync blocks before checking again, in nanoseconds
+        const GLuint64 WAIT_TIMEOUT = 1000000;
+
+        const GLbitfield PERSISTENT_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    }
+
+    GLVertexRing::GLVertexRing(GLStateCache &state)
+        : m_state(state), m_buffer(0), m_bytesPerFrame(0), m_persistent(false), m_mapped(false), m_memory(nullptr),
+          m_fences(), m_region(0), m_used(0), m_cursor(0), m_stats() {}
+
+    void GLVertexRing::Create(uint32_t bytesPerFrame, bool allowPersistent) {
+        Destroy();
+        m_bytesPerFrame = bytesPerFrame;
+        GLsizeiptr size = (GLsizeiptr)bytesPerFrame * FRAME_COUNT;
+
+        bool storage = (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) && glBufferStorage;
+        if (allowPersistent && storage && CreatePersistent(size))
+            return;
+
+        glGenBuffers(1, &m_buffer);
+        m_state.BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        printf("Vertex ring: %u x %u KB, orphaning\n", FRAME_COUNT, bytesPerFrame / 1024);
+    }
+
+    bool GLVertexRing::CreatePersistent(GLsizeiptr size) {
+        glGenBuffers(1, &m_buffer);
+        m_state.BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, PERSISTENT_FLAGS);
+        m_memory = (uint8_t *)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, PERSISTENT_FLAGS);
+        if (!m_memory) {
+            // Storage is immutable, so falling back needs a new buffer
+            printf("Vertex ring: persistent mapping failed, falling back to orphaning\n");
+            glDeleteBuffers(1, &m_buffer);
+            m_state.OnBufferDeleted(m_buffer);
+            m_buffer = 0;
+            return false;
+        }
+
+        m_persistent = true;
+        printf("Vertex ring: %u x %u KB, persistently mapped\n", FRAME_COUNT, m_bytesPerFrame / 1024);
+        return true;
+    }
+
+    void GLVertexRing::Destroy() {
+        if (!m_buffer)
+            return;
+
+        if (m_persistent || m_mapped) {
+            m_state.BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        for (uint32_t i = 0; i < FRAME_COUNT; i++) {
+            if (m_fences[i]) {
+                glDeleteSync(m_fences[i]);
+                m_fences[i] = nullptr;
+            }
+        }
+        glDeleteBuffers(1, &m_buffer);
+        m_state.OnBufferDeleted(m_buffer);
+
+        m_buffer = 0;
+        m_persistent = false;
+        m_mapped = false;
+        m_memory = nullptr;
+        m_region = 0;
+        m_used = 0;
+        m_cursor = 0;
+    }
+
+    void *GLVertexRing::Map(uint32_t bytes, uint32_t &offset) {
+        if (!m_buffer || m_mapped || bytes > m_bytesPerFrame - m_used)
+            return nullptr;
+
+        if (m_persistent) {
+            if (m_fences[m_region])
+                WaitForRegion();
+            offset = m_region * m_bytesPerFrame + m_used;
+            m_used += bytes;
+            return m_memory + offset;
+        }
+
+        m_state.BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        if (bytes > m_bytesPerFrame * FRAME_COUNT - m_cursor) {
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_bytesPerFrame * FRAME_COUNT, nullptr, GL_STREAM_DRAW);
+            m_cursor = 0;
+            m_stats.orphans++;
+        }
+
+        // Nothing drawn since the last orphan reads past the cursor, so there's nothing to synchronize with
+        void *memory = glMapBufferRange(GL_ARRAY_BUFFER, m_cursor, bytes,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!memory)
+            return nullptr;
+
+        offset = m_cursor;
+        m_cursor += bytes;
+        m_used += bytes;
+        m_mapped = true;
+        return memory;
+    }
+
+    void GLVertexRing::Unmap() {
+        // Coherent persistent memory needs neither unmapping nor flushing
+        if (!m_mapped)
+            return;
+
+        m_state.BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        if (!glUnmapBuffer(GL_ARRAY_BUFFER))
+            printf("Vertex ring: buffer contents lost while mapped\n");
+        m_mapped = false;
+    }
+
+    void GLVertexRing::EndFrame() {
+        if (m_persistent && m_used > 0) {
+            m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            m_region = (m_region + 1) % FRAME_COUNT;
+        }
+        m_used = 0;
+    }
+
+    void GLVertexRing::WaitForRegion() {
+        GLsync fence = m_fences[m_region];
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            m_stats.fenceWaits++;
+
+            // Flushing makes sure the fence actually reaches the GPU, or the wait could never end
+            do
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT);
+            while (result == GL_TIMEOUT_EXPIRED);
+        }
+        if (result == GL_WAIT_FAILED)
+            printf("Vertex ring: waiting for the GPU failed\n");
+
+        glDeleteSync(fence);
+        m_fences[m_region] = nullptr;
+    }
+
+}
@@ -0,0 +1,104 @@
+//
+// Streaming vertex memory for geometry rebuilt every frame.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "ThirdParty/GLEW/include/glew.h"
+
+namespace Engine {
+
+    class GLStateCache;
+
+    struct GLVertexRingStats {
+        // Mappings that had to wait for the GPU to finish with their region
+        uint64_t fenceWaits;
+
+        // Times the whole buffer was orphaned; orphaning mode only
+        uint64_t orphans;
+    };
+
+    /**
+     * One GL buffer holding FRAME_COUNT frames of vertices, so the CPU can
+     * fill a frame while the GPU still reads the two before it.
+     *
+     * Where GL_ARB_buffer_storage is available the buffer is mapped once,
+     * persistently and coherently, and each frame writes its own region. A
+     * fence placed by EndFrame() guards the region, and a mapping waits for
+     * it only when the GPU is a whole ring behind.
+     *
+     * Otherwise every mapping appends with an unsynchronized glMapBufferRange
+     * and the buffer is orphaned once the ring is full, which leaves keeping
+     * the old contents alive to the driver.
+     *
+     * Needs the context current for every call, and Destroy() before the
+     * context goes away.
+     */
+    class GLVertexRing {
+    public:
+        static const uint32_t FRAME_COUNT = 3;
+
+        explicit GLVertexRing(GLStateCache &state);
+
+        GLVertexRing(const GLVertexRing &) = delete;
+        GLVertexRing &operator=(const GLVertexRing &) = delete;
+
+        /**
+         * Creates the buffer, replacing any previous one. Call after glewInit().
+         * @param allowPersistent false forces orphaning even where persistent mapping works
+         */
+        void Create(uint32_t bytesPerFrame, bool allowPersistent = true);
+
+        void Destroy();
+
+        GLuint GetBuffer() const { return m_buffer; }
+        bool IsPersistent() const { return m_persistent; }
+        uint32_t GetBytesPerFrame() const { return m_bytesPerFrame; }
+
+        /**
+         * Gets write-only room for \c bytes of this frame's vertices. The
+         * offsets of one frame follow each other, so mappings that are whole
+         * vertices keep every offset a whole vertex.
+         * @param[out] offset where the memory starts in the buffer, in bytes
+         * @return null once the frame would exceed bytesPerFrame
+         */
+        void *Map(uint32_t bytes, uint32_t &offset);
+
+        /**
+         * Finishes the last Map(). Must come before drawing from it.
+         */
+        void Unmap();
+
+        /**
+         * Fences the frame's region and moves on to the next one. Call once
+         * per frame, after the last draw reading the ring.
+         */
+        void EndFrame();
+
+        const GLVertexRingStats &GetStats() const { return m_stats; }
+
+    private:
+        GLStateCache &m_state;
+        GLuint m_buffer;
+        uint32_t m_bytesPerFrame;
+        bool m_persistent;
+        bool m_mapped;
+
+        // Persistent mapping of the whole buffer
+        uint8_t *m_memory;
+        GLsync m_fences[FRAME_COUNT];
+        uint32_t m_region;
+
+        // Bytes handed out this frame, and the append position when orphaning
+        uint32_t m_used;
+        uint32_t m_cursor;
+
+        GLVertexRingStats m_stats;
+
+        bool CreatePersistent(GLsizeiptr size);
+        void WaitForRegion();
+    };
+
+}
@@ -0,0 +1,50 @@
+//
+// Backend that draws nothing and counts what it was asked to do.
+//
+
+#include "NullRenderBackend.h"
+
+namespace Engine {
+
+    NullRenderBackend::NullRenderBackend() : m_stats(), m_meshCount(0), m_textureCount(0) {}
+
+    uint32_t NullRenderBackend::CreateMesh(const RenderVertex *vertices, uint32_t count) {
+        return ++m_meshCount;
+    }
+
+    uint32_t NullRenderBackend::CreateTexture(uint32_t width, uint32_t height, const uint32_t *pixels) {
+        return ++m_textureCount;
+    }
+
+    void NullRenderBackend::BeginFrame(const Vector4 &clearColor) {}
+
+    void NullRenderBackend::SetShader(uint32_t shader) {
+        m_stats.shaderChanges++;
+    }
+
+    void NullRenderBackend::SetMaterial(uint32_t material) {
+        m_stats.materialChanges++;
+    }
+
+    void NullRenderBackend::SetBlend(BlendMode blend) {
+        m_stats.blendChanges++;
+    }
+
+    void NullRenderBackend::SetDepth(bool test, bool write) {
+        m_stats.depthChanges++;
+    }
+
+    void NullRenderBackend::SetMesh(uint32_t mesh) {
+        m_stats.meshChanges++;
+    }
+
+    void NullRenderBackend::Draw(const Matrix4 &transform, uint32_t firstVertex, uint32_t vertexCount) {
+        m_stats.draws++;
+        m_stats.vertices += vertexCount;
+    }
+
+    void NullRenderBackend::EndFrame() {
+        m_stats.frames++;
+    }
+
+}
@@ -0,0 +1,60 @@
+//
+// Backend that draws nothing and counts what it was asked to do.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "RenderBackend.h"
+
+namespace Engine {
+
+    struct NullRenderStats {
+        uint64_t frames;
+        uint64_t shaderChanges;
+        uint64_t materialChanges;
+        uint64_t blendChanges;
+        uint64_t depthChanges;
+        uint64_t meshChanges;
+        uint64_t draws;
+        uint64_t vertices;
+
+        uint64_t GetStateChanges() const {
+            return shaderChanges + materialChanges + blendChanges + depthChanges + meshChanges;
+        }
+    };
+
+    /**
+     * Stands in for a GPU, so sorting and submission can be benchmarked and
+     * checked on machines without one. Resources are only numbered.
+     */
+    class NullRenderBackend : public RenderBackend {
+    public:
+        NullRenderBackend();
+
+        uint32_t CreateMesh(const RenderVertex *vertices, uint32_t count) override;
+        uint32_t CreateTexture(uint32_t width, uint32_t height, const uint32_t *pixels) override;
+
+        void BeginFrame(const Vector4 &clearColor) override;
+
+        void SetShader(uint32_t shader) override;
+        void SetMaterial(uint32_t material) override;
+        void SetBlend(BlendMode blend) override;
+        void SetDepth(bool test, bool write) override;
+        void SetMesh(uint32_t mesh) override;
+
+        void Draw(const Matrix4 &transform, uint32_t firstVertex, uint32_t vertexCount) override;
+
+        void EndFrame() override;
+
+        const NullRenderStats &GetStats() const { return m_stats; }
+        void ResetStats() { m_stats = NullRenderStats(); }
+
+    private:
+        NullRenderStats m_stats;
+        uint32_t m_meshCount;
+        uint32_t m_textureCount;
+    };
+
+}
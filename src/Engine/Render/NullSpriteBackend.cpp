@@ -0,0 +1,26 @@
+//
+// Sprite backend that draws nothing and counts what it was asked to do.
+//
+
+#include "NullSpriteBackend.h"
+
+namespace Engine {
+
+    NullSpriteBackend::NullSpriteBackend(uint32_t maxQuads) : m_vertices((size_t)maxQuads * 4), m_stats() {}
+
+    RenderVertex *NullSpriteBackend::MapQuads(uint32_t quadCount) {
+        if ((size_t)quadCount * 4 > m_vertices.size())
+            return nullptr;
+        m_stats.maps++;
+        return m_vertices.data();
+    }
+
+    void NullSpriteBackend::UnmapQuads() {}
+
+    void NullSpriteBackend::DrawQuads(uint32_t shader, uint32_t texture, BlendMode blend, uint32_t firstQuad,
+                                      uint32_t quadCount) {
+        m_stats.draws++;
+        m_stats.quads += quadCount;
+    }
+
+}
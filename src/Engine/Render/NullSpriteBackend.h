@@ -0,0 +1,50 @@
+//
+// Sprite backend that draws nothing and counts what it was asked to do.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SpriteBackend.h"
+
+namespace Engine {
+
+    struct NullSpriteStats {
+        uint64_t maps;
+        uint64_t draws;
+        uint64_t quads;
+    };
+
+    /**
+     * Stands in for a GPU, so batching can be benchmarked and checked on
+     * machines without one. Vertices land in plain memory that is kept
+     * until the next mapping.
+     */
+    class NullSpriteBackend : public SpriteBackend {
+    public:
+        /**
+         * @param maxQuads the most quads one mapping may ask for
+         */
+        explicit NullSpriteBackend(uint32_t maxQuads);
+
+        RenderVertex *MapQuads(uint32_t quadCount) override;
+        void UnmapQuads() override;
+        void DrawQuads(uint32_t shader, uint32_t texture, BlendMode blend, uint32_t firstQuad,
+                       uint32_t quadCount) override;
+
+        /**
+         * Gets the vertices of the last mapping
+         */
+        const RenderVertex *GetVertices() const { return m_vertices.data(); }
+
+        const NullSpriteStats &GetStats() const { return m_stats; }
+        void ResetStats() { m_stats = NullSpriteStats(); }
+
+    private:
+        std::vector<RenderVertex> m_vertices;
+        NullSpriteStats m_stats;
+    };
+
+}
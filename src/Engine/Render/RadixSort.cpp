@@ -0,0 +1,137 @@
+//
+// Parallel LSD radix sort of 64-bit keys with a payload.
+//
+
+#include "RadixSort.h"
+
+#include "JobSystem.h"
+
+#include <cstring>
+#include <vector>
+
+namespace Engine {
+
+    namespace {
+
+        const uint32_t RADIX = 256;
+        const uint32_t DIGITS = 8;
+
+        // Fewer items than this per block aren't worth a job
+        const size_t MIN_BLOCK_ITEMS = 4096;
+
+        struct SortPass {
+            const RadixSortItem *source;
+            RadixSortItem *target;
+            size_t count;
+            size_t blockSize;
+            uint32_t shift;
+
+            // RADIX counts, then offsets, per block
+            uint32_t *histograms;
+        };
+
+        void CountDigits(const RadixSortItem *items, size_t count, uint32_t shift, uint32_t *histogram) {
+            std::memset(histogram, 0, RADIX * sizeof(uint32_t));
+            for (size_t i = 0; i < count; i++)
+                histogram[(items[i].key >> shift) & (RADIX - 1)]++;
+        }
+
+        void Scatter(const RadixSortItem *items, size_t count, uint32_t shift, uint32_t *offsets,
+                     RadixSortItem *target) {
+            for (size_t i = 0; i < count; i++)
+                target[offsets[(items[i].key >> shift) & (RADIX - 1)]++] = items[i];
+        }
+
+        /**
+         * Calls fn(block) for every block, on the job system when there is more than one
+         */
+        template <typename Fn>
+        void ForEachBlock(JobSystem *jobs, uint32_t blocks, Fn &&fn) {
+            if (blocks == 1) {
+                fn(0u);
+                return;
+            }
+
+            JobCounter counter;
+            auto *body = &fn;
+            for (uint32_t block = 1; block < blocks; block++)
+                jobs->Submit([body, block]() { (*body)(block); }, &counter);
+            fn(0u);
+            jobs->Wait(counter);
+        }
+    }
+
+    RadixSortItem *RadixSort(RadixSortItem *items, RadixSortItem *scratch, size_t count, JobSystem *jobs) {
+        if (count < 2)
+            return items;
+
+        uint32_t blocks = 1;
+        if (jobs && jobs->IsRunning()) {
+            size_t byItems = count / MIN_BLOCK_ITEMS;
+            blocks = byItems < jobs->GetThreadCount() ? (uint32_t)byItems : jobs->GetThreadCount();
+            if (blocks == 0)
+                blocks = 1;
+        }
+        size_t blockSize = (count + blocks - 1) / blocks;
+
+        // Find the bytes that actually vary: OR of every key's difference from the first
+        uint64_t first = items[0].key;
+        std::vector<uint64_t> differences(blocks, 0);
+        ForEachBlock(jobs, blocks, [&](uint32_t block) {
+            size_t begin = block * blockSize;
+            size_t end = begin + blockSize < count ? begin + blockSize : count;
+            uint64_t difference = 0;
+            for (size_t i = begin; i < end; i++)
+                difference |= items[i].key ^ first;
+            differences[block] = difference;
+        });
+
+        uint64_t varying = 0;
+        for (uint64_t difference : differences)
+            varying |= difference;
+
+        std::vector<uint32_t> histograms(blocks * RADIX);
+        SortPass pass;
+        pass.source = items;
+        pass.target = scratch;
+        pass.count = count;
+        pass.blockSize = blockSize;
+        pass.histograms = histograms.data();
+
+        for (uint32_t digit = 0; digit < DIGITS; digit++) {
+            pass.shift = digit * 8;
+            if (((varying >> pass.shift) & (RADIX - 1)) == 0)
+                continue;
+
+            ForEachBlock(jobs, blocks, [&pass](uint32_t block) {
+                size_t begin = block * pass.blockSize;
+                size_t end = begin + pass.blockSize < pass.count ? begin + pass.blockSize : pass.count;
+                CountDigits(pass.source + begin, end - begin, pass.shift, pass.histograms + block * RADIX);
+            });
+
+            // Digit-major, block-minor, so equal digits keep their block order and the sort stays stable
+            uint32_t offset = 0;
+            for (uint32_t value = 0; value < RADIX; value++) {
+                for (uint32_t block = 0; block < blocks; block++) {
+                    uint32_t &slot = pass.histograms[block * RADIX + value];
+                    uint32_t digitCount = slot;
+                    slot = offset;
+                    offset += digitCount;
+                }
+            }
+
+            ForEachBlock(jobs, blocks, [&pass](uint32_t block) {
+                size_t begin = block * pass.blockSize;
+                size_t end = begin + pass.blockSize < pass.count ? begin + pass.blockSize : pass.count;
+                Scatter(pass.source + begin, end - begin, pass.shift, pass.histograms + block * RADIX, pass.target);
+            });
+
+            RadixSortItem *sorted = pass.target;
+            pass.target = const_cast<RadixSortItem *>(pass.source);
+            pass.source = sorted;
+        }
+
+        return const_cast<RadixSortItem *>(pass.source);
+    }
+
+}
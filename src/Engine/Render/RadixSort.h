@@ -0,0 +1,36 @@
+//
+// Parallel LSD radix sort of 64-bit keys with a payload.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine {
+
+    class JobSystem;
+
+    struct RadixSortItem {
+        uint64_t key;
+        uint32_t buffer;
+        uint32_t index;
+    };
+
+    /**
+     * Sorts items by key, stable, one byte per pass. Bytes that are the
+     * same in every key are skipped, so keys that only use a few fields
+     * cost only a few passes.
+     *
+     * With a running job system and enough items, each pass is split into
+     * one block per thread: every block counts its digits, the counts are
+     * turned into per-block output offsets, then every block scatters its
+     * items independently.
+     *
+     * @param scratch as many items as \c items; its contents are overwritten
+     * @param jobs may be null to sort on the calling thread
+     * @return whichever of \c items or \c scratch holds the sorted result
+     */
+    RadixSortItem *RadixSort(RadixSortItem *items, RadixSortItem *scratch, size_t count, JobSystem *jobs);
+
+}
@@ -0,0 +1,96 @@
+//
+// Draw packets and the interface every rendering backend implements.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "Matrix4.h"
+#include "Vector4.h"
+
+namespace Engine {
+
+    enum class BlendMode : uint8_t {
+        // Source replaces destination
+        Opaque,
+
+        // Source over destination by source alpha
+        Alpha,
+
+        // Source added to destination, scaled by source alpha
+        Additive
+    };
+
+    /**
+     * One corner of a triangle. Colors are 0xAABBGGRR, which is RGBA bytes
+     * in memory on little-endian machines.
+     */
+    struct RenderVertex {
+        float x, y, z;
+        float u, v;
+        uint32_t color;
+    };
+
+    /**
+     * Everything needed to issue one draw. Resources are the ids handed out
+     * by the backend the packet is submitted to; 0 means none.
+     */
+    struct DrawCommand {
+        // Object to clip space
+        Matrix4 transform;
+
+        uint32_t shader;
+        uint32_t material;
+        uint32_t mesh;
+
+        // Range of the mesh's vertices to draw as a triangle list
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+
+        BlendMode blend;
+        bool depthTest;
+        bool depthWrite;
+    };
+
+    /**
+     * Issues draws to a GPU API or anything standing in for one. Only
+     * called from the thread submitting the frame. The state setters are
+     * only called when the state actually changes.
+     */
+    class RenderBackend {
+    public:
+        virtual ~RenderBackend() {}
+
+        /**
+         * Copies triangles the backend keeps for later draws
+         * @return the mesh id, never 0
+         */
+        virtual uint32_t CreateMesh(const RenderVertex *vertices, uint32_t count) = 0;
+
+        /**
+         * Copies a texture of 0xAABBGGRR pixels, rows top to bottom
+         * @return the texture id, which draws use as their material; never 0
+         */
+        virtual uint32_t CreateTexture(uint32_t width, uint32_t height, const uint32_t *pixels) = 0;
+
+        /**
+         * Starts a frame by clearing color to \c clearColor and depth to the far plane
+         */
+        virtual void BeginFrame(const Vector4 &clearColor) = 0;
+
+        virtual void SetShader(uint32_t shader) = 0;
+        virtual void SetMaterial(uint32_t material) = 0;
+        virtual void SetBlend(BlendMode blend) = 0;
+        virtual void SetDepth(bool test, bool write) = 0;
+        virtual void SetMesh(uint32_t mesh) = 0;
+
+        virtual void Draw(const Matrix4 &transform, uint32_t firstVertex, uint32_t vertexCount) = 0;
+
+        /**
+         * Finishes the frame and presents it
+         */
+        virtual void EndFrame() = 0;
+    };
+
+}
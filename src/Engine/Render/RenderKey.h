@@ -0,0 +1,90 @@
+//
+// 64-bit sort keys that put draws in submission order.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace Engine {
+
+    /**
+     * Packs what decides a draw's place in the frame into one integer, so
+     * draws are ordered by sorting keys ascending. From the top bit down:
+     *
+     *   layer     4 bits   screen layer: world, effects, UI...
+     *   pass      4 bits   pass within the layer
+     *   blended   1 bit    set by MakeBlended()
+     *
+     * then, for opaque draws, grouped by state and front to back:
+     *
+     *   shader   12 bits
+     *   material 16 bits
+     *   depth    24 bits   0 nearest
+     *
+     * and for blended draws, back to front first so blending composes:
+     *
+     *   depth    24 bits   inverted, 0 farthest
+     *   shader   12 bits
+     *   material 16 bits
+     *
+     * The low 3 bits are left clear. Values wider than their field are
+     * truncated; depth is clamped to [0, 1].
+     */
+    class RenderKey {
+    public:
+        static const uint32_t LAYER_BITS = 4;
+        static const uint32_t PASS_BITS = 4;
+        static const uint32_t SHADER_BITS = 12;
+        static const uint32_t MATERIAL_BITS = 16;
+        static const uint32_t DEPTH_BITS = 24;
+
+        static uint64_t MakeOpaque(uint32_t layer, uint32_t pass, uint32_t shader, uint32_t material, float depth) {
+            return Header(layer, pass, false) | Field(shader, SHADER_BITS) << 43 |
+                   Field(material, MATERIAL_BITS) << 27 | (uint64_t)QuantizeDepth(depth) << 3;
+        }
+
+        static uint64_t MakeBlended(uint32_t layer, uint32_t pass, uint32_t shader, uint32_t material, float depth) {
+            uint32_t inverted = QuantizeDepth(depth) ^ ((1u << DEPTH_BITS) - 1);
+            return Header(layer, pass, true) | (uint64_t)inverted << 31 | Field(shader, SHADER_BITS) << 19 |
+                   Field(material, MATERIAL_BITS) << 3;
+        }
+
+        static uint32_t GetLayer(uint64_t key) { return (uint32_t)(key >> 60); }
+        static uint32_t GetPass(uint64_t key) { return (uint32_t)(key >> 56) & 0xF; }
+        static bool IsBlended(uint64_t key) { return (key >> 55) & 1; }
+
+        static uint32_t GetShader(uint64_t key) {
+            return (uint32_t)(key >> (IsBlended(key) ? 19 : 43)) & ((1u << SHADER_BITS) - 1);
+        }
+
+        static uint32_t GetMaterial(uint64_t key) {
+            return (uint32_t)(key >> (IsBlended(key) ? 3 : 27)) & ((1u << MATERIAL_BITS) - 1);
+        }
+
+        /**
+         * Gets the quantized depth, 0 nearest, whichever way the key sorts it
+         */
+        static uint32_t GetDepth(uint64_t key) {
+            const uint32_t mask = (1u << DEPTH_BITS) - 1;
+            return IsBlended(key) ? ((uint32_t)(key >> 31) & mask) ^ mask : (uint32_t)(key >> 3) & mask;
+        }
+
+    private:
+        static uint64_t Field(uint32_t value, uint32_t bits) { return value & ((1u << bits) - 1); }
+
+        static uint64_t Header(uint32_t layer, uint32_t pass, bool blended) {
+            return Field(layer, LAYER_BITS) << 60 | Field(pass, PASS_BITS) << 56 | (uint64_t)blended << 55;
+        }
+
+        static uint32_t QuantizeDepth(float depth) {
+            // Written so NaN lands on 0 rather than in undefined conversion territory
+            if (!(depth > 0.0f))
+                return 0;
+            if (depth >= 1.0f)
+                return (1u << DEPTH_BITS) - 1;
+            return (uint32_t)(depth * (float)((1u << DEPTH_BITS) - 1));
+        }
+    };
+
+}
@@ -0,0 +1,100 @@
+//
+// Per-thread draw recording, merged by sort key and submitted to a backend.
+//
+
+#include "RenderQueue.h"
+
+#include "Memory.h"
+#include "Profiler.h"
+
+namespace Engine {
+
+    RenderQueue::RenderQueue(uint32_t bufferCount) : m_sorted(nullptr), m_stats() {
+        for (uint32_t i = 0; i < bufferCount; i++)
+            m_buffers.emplace_back(new RenderCommandBuffer());
+    }
+
+    uint32_t RenderQueue::GetCount() const {
+        uint32_t count = 0;
+        for (const std::unique_ptr<RenderCommandBuffer> &buffer : m_buffers)
+            count += buffer->GetCount();
+        return count;
+    }
+
+    void RenderQueue::Sort(JobSystem *jobs) {
+        PROFILE_FUNCTION();
+        MemoryTagScope memoryTag(MemoryTag::Render);
+
+        m_items.clear();
+        for (uint32_t b = 0; b < m_buffers.size(); b++) {
+            const std::vector<uint64_t> &keys = m_buffers[b]->m_keys;
+            for (uint32_t i = 0; i < keys.size(); i++)
+                m_items.push_back(RadixSortItem{keys[i], b, i});
+        }
+
+        m_scratch.resize(m_items.size());
+        m_sorted = RadixSort(m_items.data(), m_scratch.data(), m_items.size(), jobs);
+    }
+
+    void RenderQueue::Submit(RenderBackend &backend) {
+        PROFILE_FUNCTION();
+
+        m_stats = RenderQueueStats();
+        if (!m_sorted)
+            return;
+
+        // Nothing is assumed about the backend's state before the first draw
+        const DrawCommand *previous = nullptr;
+        for (size_t i = 0; i < m_items.size(); i++) {
+            const RadixSortItem &item = m_sorted[i];
+            const DrawCommand &command = m_buffers[item.buffer]->m_commands[item.index];
+
+            if (!previous || command.shader != previous->shader) {
+                backend.SetShader(command.shader);
+                m_stats.stateChanges++;
+            } else {
+                m_stats.redundantStates++;
+            }
+
+            if (!previous || command.material != previous->material) {
+                backend.SetMaterial(command.material);
+                m_stats.stateChanges++;
+            } else {
+                m_stats.redundantStates++;
+            }
+
+            if (!previous || command.blend != previous->blend) {
+                backend.SetBlend(command.blend);
+                m_stats.stateChanges++;
+            } else {
+                m_stats.redundantStates++;
+            }
+
+            if (!previous || command.depthTest != previous->depthTest || command.depthWrite != previous->depthWrite) {
+                backend.SetDepth(command.depthTest, command.depthWrite);
+                m_stats.stateChanges++;
+            } else {
+                m_stats.redundantStates++;
+            }
+
+            if (!previous || command.mesh != previous->mesh) {
+                backend.SetMesh(command.mesh);
+                m_stats.stateChanges++;
+            } else {
+                m_stats.redundantStates++;
+            }
+
+            backend.Draw(command.transform, command.firstVertex, command.vertexCount);
+            m_stats.draws++;
+            previous = &command;
+        }
+    }
+
+    void RenderQueue::Clear() {
+        for (const std::unique_ptr<RenderCommandBuffer> &buffer : m_buffers)
+            buffer->Clear();
+        m_items.clear();
+        m_sorted = nullptr;
+    }
+
+}
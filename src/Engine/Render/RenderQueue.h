@@ -0,0 +1,108 @@
+//
+// Per-thread draw recording, merged by sort key and submitted to a backend.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "RadixSort.h"
+#include "RenderBackend.h"
+#include "Thread.h"
+
+namespace Engine {
+
+    class JobSystem;
+
+    /**
+     * Draws recorded by one thread. Only that thread may add to it.
+     * Buffers fill a whole cache line, so threads recording into
+     * neighbouring buffers never write the same line.
+     */
+    class alignas(CACHE_LINE_SIZE) RenderCommandBuffer {
+    public:
+        void Add(uint64_t key, const DrawCommand &command) {
+            m_keys.push_back(key);
+            m_commands.push_back(command);
+        }
+
+        uint32_t GetCount() const { return (uint32_t)m_commands.size(); }
+
+        void Clear() {
+            m_keys.clear();
+            m_commands.clear();
+        }
+
+    private:
+        friend class RenderQueue;
+
+        std::vector<uint64_t> m_keys;
+        std::vector<DrawCommand> m_commands;
+    };
+
+    struct RenderQueueStats {
+        uint32_t draws;
+
+        // State setters called on the backend, and ones skipped because the state was already set
+        uint32_t stateChanges;
+        uint32_t redundantStates;
+    };
+
+    /**
+     * Collects one frame of draws. Each recording thread adds to its own
+     * buffer, so recording takes no locks; Sort() merges every buffer by
+     * key and Submit() walks the result, only setting the state that
+     * differs from the previous draw.
+     *
+     * Typical use from jobs is GetBuffer(jobs.GetThreadIndex()) with a
+     * queue sized by JobSystem::GetThreadCount().
+     */
+    class RenderQueue {
+    public:
+        explicit RenderQueue(uint32_t bufferCount);
+
+        RenderQueue(const RenderQueue &) = delete;
+        RenderQueue &operator=(const RenderQueue &) = delete;
+
+        uint32_t GetBufferCount() const { return (uint32_t)m_buffers.size(); }
+        RenderCommandBuffer &GetBuffer(uint32_t index) { return *m_buffers[index]; }
+
+        /**
+         * Gets the number of draws recorded in every buffer
+         */
+        uint32_t GetCount() const;
+
+        /**
+         * Merges every buffer into one list ordered by key. Draws with equal
+         * keys keep the order of their buffers, then the order they were added.
+         * @param jobs splits the sort across threads; may be null
+         */
+        void Sort(JobSystem *jobs);
+
+        /**
+         * Issues the sorted draws. Call Sort() first.
+         */
+        void Submit(RenderBackend &backend);
+
+        /**
+         * Empties every buffer for the next frame, keeping their memory
+         */
+        void Clear();
+
+        /**
+         * Gets the counts of the last Submit()
+         */
+        const RenderQueueStats &GetStats() const { return m_stats; }
+
+    private:
+        std::vector<std::unique_ptr<RenderCommandBuffer>> m_buffers;
+
+        std::vector<RadixSortItem> m_items;
+        std::vector<RadixSortItem> m_scratch;
+        RadixSortItem *m_sorted;
+        RenderQueueStats m_stats;
+    };
+
+}
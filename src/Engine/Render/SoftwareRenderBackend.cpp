@@ -0,0 +1,695 @@
+//
+// Backend that rasterizes on the CPU, tile by tile across the job system.
+//
+
+#include "SoftwareRenderBackend.h"
+
+#include "JobSystem.h"
+#include "Memory.h"
+#include "Profiler.h"
+#include "Simd.h"
+
+#include "ThirdParty/SDL/include/SDL.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Engine {
+
+    namespace {
+
+        // Interpolated per pixel: depth, 1/w, then u, v, r, g, b, a divided by w
+        const int ATTRIBUTE_COUNT = 8;
+
+        // Clip space position, texture coordinates and color, interpolated together when clipping
+        const int CLIP_X = 0, CLIP_Y = 1, CLIP_Z = 2, CLIP_W = 3, CLIP_U = 4, CLIP_V = 5, CLIP_COLOR = 6;
+        const int CLIP_VALUES = 10;
+
+        // A triangle gains at most one vertex per clip plane
+        const int CLIP_PLANES = 6;
+        const int MAX_POLYGON = 3 + CLIP_PLANES;
+
+        // Triangles reaching further than this many pixels from the screen center are clipped.
+        // Closer in, edge functions stay precise to well below a pixel.
+        const float GUARD_BAND = 8192.0f;
+
+        // Vertices snap to 1/16 of a pixel, which makes every edge function value a multiple of 1/256
+        const float SUBPIXELS = 16.0f;
+
+        // Between 0 and the smallest edge function value above 0, so comparing against it is "greater than 0"
+        const float OUTSIDE_BIAS = 1.0f / 512.0f;
+
+        // Fewer triangles than this aren't worth a setup job of their own
+        const uint32_t MIN_TRIANGLES_PER_CHUNK = 256;
+
+        const float BYTE_TO_FLOAT = 1.0f / 255.0f;
+
+        struct ClipVertex {
+            float values[CLIP_VALUES];
+        };
+
+        struct ScreenVertex {
+            float x, y;
+            float attributes[ATTRIBUTE_COUNT];
+        };
+
+        struct Triangle {
+            // Edge functions a * x + b * y + c of the edges opposite each vertex, positive inside
+            float a[3], b[3], c[3];
+
+            // What an edge function must reach at a pixel center for the pixel to be inside:
+            // 0 on top and left edges, so pixels exactly on them are in, and just above 0 elsewhere
+            float bias[3];
+
+            float inverseArea;
+
+            // Attributes at vertex 0, and their differences to vertices 1 and 2
+            float base[ATTRIBUTE_COUNT];
+            float toSecond[ATTRIBUTE_COUNT];
+            float toThird[ATTRIBUTE_COUNT];
+
+            // Pixels whose centers may be covered, inclusive and on screen
+            int minX, minY, maxX, maxY;
+
+            const uint32_t *texels;
+            uint32_t textureWidth;
+            uint32_t textureHeight;
+            BlendMode blend;
+            bool depthTest;
+            bool depthWrite;
+        };
+
+        struct ClipPlane {
+            float x, y, z, w;
+
+            float Distance(const ClipVertex &vertex) const {
+                return x * vertex.values[CLIP_X] + y * vertex.values[CLIP_Y] + z * vertex.values[CLIP_Z] +
+                       w * vertex.values[CLIP_W];
+            }
+        };
+
+        /**
+         * Clips a convex polygon against one plane, keeping the side where the distance isn't negative
+         * @return the number of vertices written to \c output
+         */
+        int ClipPolygon(const ClipPlane &plane, const ClipVertex *input, int count, ClipVertex *output) {
+            int result = 0;
+            for (int i = 0; i < count; i++) {
+                const ClipVertex &current = input[i];
+                const ClipVertex &next = input[i + 1 < count ? i + 1 : 0];
+                float currentDistance = plane.Distance(current);
+                float nextDistance = plane.Distance(next);
+
+                if (currentDistance >= 0.0f)
+                    output[result++] = current;
+                if ((currentDistance >= 0.0f) == (nextDistance >= 0.0f))
+                    continue;
+
+                // Always measured from the inside end, so the triangles on both sides of an edge
+                // compute the same point and no crack opens between them
+                const ClipVertex &inside = currentDistance >= 0.0f ? current : next;
+                const ClipVertex &outside = currentDistance >= 0.0f ? next : current;
+                float insideDistance = currentDistance >= 0.0f ? currentDistance : nextDistance;
+                float outsideDistance = currentDistance >= 0.0f ? nextDistance : currentDistance;
+                float t = insideDistance / (insideDistance - outsideDistance);
+
+                ClipVertex &split = output[result++];
+                for (int value = 0; value < CLIP_VALUES; value++)
+                    split.values[value] = inside.values[value] + (outside.values[value] - inside.values[value]) * t;
+            }
+            return result;
+        }
+
+        /**
+         * Computes the edge functions and attribute setup of one triangle
+         * @return false if it covers no pixel center
+         */
+        bool SetupTriangle(const ScreenVertex &v0, const ScreenVertex &v1, const ScreenVertex &v2, int width,
+                           int height, Triangle &triangle) {
+            const ScreenVertex *vertices[3] = {&v0, &v1, &v2};
+
+            // Edge i runs between the two vertices other than i. Swapping an edge's ends negates every
+            // coefficient exactly, so neighbors evaluate exact opposites along their shared edge. The
+            // products are exact in double, which keeps that true whether or not they get fused.
+            for (int i = 0; i < 3; i++) {
+                const ScreenVertex &p = *vertices[(i + 1) % 3];
+                const ScreenVertex &q = *vertices[(i + 2) % 3];
+                triangle.a[i] = p.y - q.y;
+                triangle.b[i] = q.x - p.x;
+                triangle.c[i] = (float)((double)p.x * q.y - (double)q.x * p.y);
+            }
+
+            double area = ((double)v1.x - v0.x) * ((double)v2.y - v0.y) -
+                          ((double)v1.y - v0.y) * ((double)v2.x - v0.x);
+            if (area == 0.0)
+                return false;
+
+            // Either winding draws; flip clockwise triangles so inside is positive
+            if (area < 0.0) {
+                area = -area;
+                for (int i = 0; i < 3; i++) {
+                    triangle.a[i] = -triangle.a[i];
+                    triangle.b[i] = -triangle.b[i];
+                    triangle.c[i] = -triangle.c[i];
+                }
+            }
+
+            // With y down and inside positive, left edges have a > 0 and top edges a == 0, b > 0
+            for (int i = 0; i < 3; i++) {
+                bool topLeft = triangle.a[i] > 0.0f || (triangle.a[i] == 0.0f && triangle.b[i] > 0.0f);
+                triangle.bias[i] = topLeft ? 0.0f : OUTSIDE_BIAS;
+            }
+
+            float minX = std::min(v0.x, std::min(v1.x, v2.x));
+            float maxX = std::max(v0.x, std::max(v1.x, v2.x));
+            float minY = std::min(v0.y, std::min(v1.y, v2.y));
+            float maxY = std::max(v0.y, std::max(v1.y, v2.y));
+            triangle.minX = std::max(0, (int)std::ceil(minX - 0.5f));
+            triangle.maxX = std::min(width - 1, (int)std::floor(maxX - 0.5f));
+            triangle.minY = std::max(0, (int)std::ceil(minY - 0.5f));
+            triangle.maxY = std::min(height - 1, (int)std::floor(maxY - 0.5f));
+            if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+                return false;
+
+            triangle.inverseArea = (float)(1.0 / area);
+            for (int i = 0; i < ATTRIBUTE_COUNT; i++) {
+                triangle.base[i] = v0.attributes[i];
+                triangle.toSecond[i] = v1.attributes[i] - v0.attributes[i];
+                triangle.toThird[i] = v2.attributes[i] - v0.attributes[i];
+            }
+            return true;
+        }
+
+        uint32_t PackColor(float r, float g, float b, float a) {
+            r = std::min(std::max(r, 0.0f), 1.0f);
+            g = std::min(std::max(g, 0.0f), 1.0f);
+            b = std::min(std::max(b, 0.0f), 1.0f);
+            a = std::min(std::max(a, 0.0f), 1.0f);
+            return (uint32_t)(r * 255.0f + 0.5f) | ((uint32_t)(g * 255.0f + 0.5f) << 8) |
+                   ((uint32_t)(b * 255.0f + 0.5f) << 16) | ((uint32_t)(a * 255.0f + 0.5f) << 24);
+        }
+
+        uint32_t Sample(const Triangle &triangle, float u, float v) {
+            float wrappedU = u - std::floor(u);
+            float wrappedV = v - std::floor(v);
+            uint32_t x = std::min((uint32_t)(wrappedU * triangle.textureWidth), triangle.textureWidth - 1);
+            uint32_t y = std::min((uint32_t)(wrappedV * triangle.textureHeight), triangle.textureHeight - 1);
+            return triangle.texels[y * triangle.textureWidth + x];
+        }
+
+        /**
+         * Draws the part of a triangle inside the pixel rectangle [x0, x1) x [y0, y1)
+         */
+        void RasterTriangle(const Triangle &triangle, int x0, int y0, int x1, int y1, uint32_t *color, float *depth,
+                            uint32_t stride) {
+            using namespace Simd;
+
+            int minX = std::max(x0, triangle.minX);
+            int maxX = std::min(x1 - 1, triangle.maxX);
+            int minY = std::max(y0, triangle.minY);
+            int maxY = std::min(y1 - 1, triangle.maxY);
+            if (minX > maxX || minY > maxY)
+                return;
+
+            Float4 a[3], bias[3];
+            for (int i = 0; i < 3; i++) {
+                a[i] = Splat(triangle.a[i]);
+                bias[i] = Splat(triangle.bias[i]);
+            }
+            Float4 inverseArea = Splat(triangle.inverseArea);
+            Float4 first = Splat(minX + 0.5f);
+            Float4 last = Splat(maxX + 0.5f);
+            Float4 one = Splat(1.0f);
+            const Float4 laneOffsets = Set(0.5f, 1.5f, 2.5f, 3.5f);
+
+            auto interpolate = [&](int attribute, Float4 second, Float4 third) {
+                return MulAdd(Splat(triangle.toThird[attribute]), third,
+                              MulAdd(Splat(triangle.toSecond[attribute]), second, Splat(triangle.base[attribute])));
+            };
+
+            alignas(16) float us[4], vs[4], rs[4], gs[4], bs[4], as[4];
+
+            // Groups start on multiples of 4 pixels, so depth rows load aligned
+            int startX = minX & ~3;
+            for (int y = minY; y <= maxY; y++) {
+                float centerY = y + 0.5f;
+                Float4 row[3];
+                for (int i = 0; i < 3; i++)
+                    row[i] = Splat(triangle.b[i] * centerY + triangle.c[i]);
+
+                uint32_t *colorRow = color + (size_t)y * stride;
+                float *depthRow = depth + (size_t)y * stride;
+                for (int x = startX; x <= maxX; x += 4) {
+                    // Every pixel is evaluated the same way wherever its group started, which keeps
+                    // the values of neighbors exact opposites
+                    Float4 centerX = Add(Splat((float)x), laneOffsets);
+                    Float4 e0 = Add(Mul(a[0], centerX), row[0]);
+                    Float4 e1 = Add(Mul(a[1], centerX), row[1]);
+                    Float4 e2 = Add(Mul(a[2], centerX), row[2]);
+
+                    Float4 covered = And(And(GreaterEqual(e0, bias[0]), GreaterEqual(e1, bias[1])),
+                                         GreaterEqual(e2, bias[2]));
+                    covered = And(covered, And(GreaterEqual(centerX, first), LessEqual(centerX, last)));
+                    if (!MaskBits(covered))
+                        continue;
+
+                    Float4 second = Mul(e1, inverseArea);
+                    Float4 third = Mul(e2, inverseArea);
+                    if (triangle.depthTest || triangle.depthWrite) {
+                        Float4 z = interpolate(0, second, third);
+                        Float4 stored = Load(depthRow + x);
+                        if (triangle.depthTest)
+                            covered = And(covered, LessEqual(z, stored));
+                        if (triangle.depthWrite)
+                            Store(depthRow + x, Select(covered, z, stored));
+                    }
+
+                    int mask = MaskBits(covered);
+                    if (!mask)
+                        continue;
+
+                    // Attributes were divided by w at the vertices; multiplying by the interpolated w undoes it
+                    Float4 w = Div(one, interpolate(1, second, third));
+                    Store(us, Mul(interpolate(2, second, third), w));
+                    Store(vs, Mul(interpolate(3, second, third), w));
+                    Store(rs, Mul(interpolate(4, second, third), w));
+                    Store(gs, Mul(interpolate(5, second, third), w));
+                    Store(bs, Mul(interpolate(6, second, third), w));
+                    Store(as, Mul(interpolate(7, second, third), w));
+
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (!(mask & (1 << lane)))
+                            continue;
+
+                        float r = rs[lane], g = gs[lane], b = bs[lane], alpha = as[lane];
+                        if (triangle.texels) {
+                            uint32_t texel = Sample(triangle, us[lane], vs[lane]);
+                            r *= (texel & 0xFF) * BYTE_TO_FLOAT;
+                            g *= ((texel >> 8) & 0xFF) * BYTE_TO_FLOAT;
+                            b *= ((texel >> 16) & 0xFF) * BYTE_TO_FLOAT;
+                            alpha *= (texel >> 24) * BYTE_TO_FLOAT;
+                        }
+
+                        uint32_t &target = colorRow[x + lane];
+                        if (triangle.blend == BlendMode::Opaque) {
+                            target = PackColor(r, g, b, alpha);
+                            continue;
+                        }
+
+                        alpha = std::min(std::max(alpha, 0.0f), 1.0f);
+                        float targetR = (target & 0xFF) * BYTE_TO_FLOAT;
+                        float targetG = ((target >> 8) & 0xFF) * BYTE_TO_FLOAT;
+                        float targetB = ((target >> 16) & 0xFF) * BYTE_TO_FLOAT;
+                        float targetA = (target >> 24) * BYTE_TO_FLOAT;
+                        if (triangle.blend == BlendMode::Alpha) {
+                            float keep = 1.0f - alpha;
+                            target = PackColor(r * alpha + targetR * keep, g * alpha + targetG * keep,
+                                               b * alpha + targetB * keep, alpha + targetA * keep);
+                        } else {
+                            target = PackColor(targetR + r * alpha, targetG + g * alpha, targetB + b * alpha, targetA);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    struct SoftwareRenderBackend::Texture {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint32_t> pixels;
+    };
+
+    struct SoftwareRenderBackend::DrawRecord {
+        Matrix4 transform;
+        const RenderVertex *vertices;
+        uint32_t firstTriangle;
+        uint32_t triangleCount;
+        const Texture *texture;
+        BlendMode blend;
+        bool depthTest;
+        bool depthWrite;
+    };
+
+    /**
+     * Triangles set up by one job, binned by tile. Tiles walk the chunks in
+     * order, and each chunk holds a contiguous range of the frame's
+     * triangles, so draws keep their submission order.
+     */
+    struct SoftwareRenderBackend::SetupChunk {
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<uint32_t>> bins;
+        uint32_t submitted;
+        uint32_t binned;
+    };
+
+    /**
+     * Where tiles copy themselves to, in the surface's own pixel format
+     */
+    struct SoftwareRenderBackend::Presenter {
+        uint8_t *pixels;
+        int pitch;
+        int width;
+        int height;
+        uint32_t redShift;
+        uint32_t greenShift;
+        uint32_t blueShift;
+        uint32_t alphaShift;
+        bool alpha;
+    };
+
+    SoftwareRenderBackend::SoftwareRenderBackend(uint32_t width, uint32_t height, JobSystem *jobs)
+        : m_width(width), m_height(height), m_stride((width + 3) & ~3u),
+          m_tilesX((width + TILE_SIZE - 1) / TILE_SIZE), m_tilesY((height + TILE_SIZE - 1) / TILE_SIZE), m_jobs(jobs),
+          m_window(nullptr), m_clearColor(0xFF000000), m_material(0), m_blend(BlendMode::Opaque), m_depthTest(true),
+          m_depthWrite(true), m_mesh(0), m_triangleCount(0), m_stats() {
+        MemoryTagScope memoryTag(MemoryTag::Render);
+        m_color.resize((size_t)m_stride * height, m_clearColor);
+        m_depth.resize((size_t)m_stride * height, 1.0f);
+    }
+
+    SoftwareRenderBackend::~SoftwareRenderBackend() {}
+
+    uint32_t SoftwareRenderBackend::CreateMesh(const RenderVertex *vertices, uint32_t count) {
+        MemoryTagScope memoryTag(MemoryTag::Render);
+        m_meshes.emplace_back(vertices, vertices + count);
+        return (uint32_t)m_meshes.size();
+    }
+
+    uint32_t SoftwareRenderBackend::CreateTexture(uint32_t width, uint32_t height, const uint32_t *pixels) {
+        MemoryTagScope memoryTag(MemoryTag::Render);
+        std::unique_ptr<Texture> texture(new Texture());
+        texture->width = width;
+        texture->height = height;
+        texture->pixels.assign(pixels, pixels + (size_t)width * height);
+        m_textures.push_back(std::move(texture));
+        return (uint32_t)m_textures.size();
+    }
+
+    void SoftwareRenderBackend::BeginFrame(const Vector4 &clearColor) {
+        m_clearColor = PackColor(clearColor.GetX(), clearColor.GetY(), clearColor.GetZ(), clearColor.GetW());
+        m_draws.clear();
+        m_triangleCount = 0;
+    }
+
+    void SoftwareRenderBackend::SetShader(uint32_t) {}
+
+    void SoftwareRenderBackend::SetMaterial(uint32_t material) {
+        m_material = material;
+    }
+
+    void SoftwareRenderBackend::SetBlend(BlendMode blend) {
+        m_blend = blend;
+    }
+
+    void SoftwareRenderBackend::SetDepth(bool test, bool write) {
+        m_depthTest = test;
+        m_depthWrite = write;
+    }
+
+    void SoftwareRenderBackend::SetMesh(uint32_t mesh) {
+        m_mesh = mesh;
+    }
+
+    void SoftwareRenderBackend::Draw(const Matrix4 &transform, uint32_t firstVertex, uint32_t vertexCount) {
+        if (m_mesh == 0 || m_mesh > m_meshes.size())
+            return;
+        const std::vector<RenderVertex> &mesh = m_meshes[m_mesh - 1];
+        if (firstVertex >= mesh.size())
+            return;
+        vertexCount = std::min(vertexCount, (uint32_t)mesh.size() - firstVertex);
+        if (vertexCount < 3)
+            return;
+
+        MemoryTagScope memoryTag(MemoryTag::Render);
+        DrawRecord draw;
+        draw.transform = transform;
+        draw.vertices = mesh.data() + firstVertex;
+        draw.firstTriangle = m_triangleCount;
+        draw.triangleCount = vertexCount / 3;
+        draw.texture = m_material > 0 && m_material <= m_textures.size() ? m_textures[m_material - 1].get() : nullptr;
+        draw.blend = m_blend;
+        draw.depthTest = m_depthTest;
+        draw.depthWrite = m_depthWrite;
+        m_draws.push_back(draw);
+        m_triangleCount += draw.triangleCount;
+    }
+
+    void SoftwareRenderBackend::EndFrame() {
+        PROFILE_FUNCTION();
+        MemoryTagScope memoryTag(MemoryTag::Render);
+
+        bool parallel = m_jobs && m_jobs->IsRunning();
+        uint32_t chunkCount = 1;
+        if (parallel) {
+            chunkCount = std::min(m_jobs->GetThreadCount() * 4, m_triangleCount / MIN_TRIANGLES_PER_CHUNK);
+            chunkCount = std::max(chunkCount, 1u);
+        }
+
+        uint32_t tileCount = m_tilesX * m_tilesY;
+        while (m_chunks.size() < chunkCount) {
+            std::unique_ptr<SetupChunk> chunk(new SetupChunk());
+            chunk->bins.resize(tileCount);
+            m_chunks.push_back(std::move(chunk));
+        }
+
+        {
+            PROFILE_SCOPE("Setup");
+            uint32_t chunkSize = (m_triangleCount + chunkCount - 1) / chunkCount;
+            JobCounter counter;
+            for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+                uint32_t begin = std::min(chunk * chunkSize, m_triangleCount);
+                uint32_t end = std::min(begin + chunkSize, m_triangleCount);
+                SetupChunk *target = m_chunks[chunk].get();
+                if (chunk + 1 < chunkCount)
+                    m_jobs->Submit([this, target, begin, end]() { SetupTriangles(*target, begin, end); }, &counter);
+                else
+                    SetupTriangles(*target, begin, end);
+            }
+            if (parallel)
+                m_jobs->Wait(counter);
+        }
+
+        m_stats = SoftwareRenderStats();
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            m_stats.triangles += m_chunks[chunk]->submitted;
+            m_stats.visible += (uint32_t)m_chunks[chunk]->triangles.size();
+            m_stats.binned += m_chunks[chunk]->binned;
+        }
+
+        // Tiles convert themselves straight into the window surface, when there's a 32-bit one
+        SDL_Surface *surface = m_window ? SDL_GetWindowSurface(m_window) : nullptr;
+        if (surface && surface->format->BytesPerPixel != 4)
+            surface = nullptr;
+        if (surface && SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+            surface = nullptr;
+
+        Presenter presenter;
+        if (surface) {
+            presenter.pixels = (uint8_t *)surface->pixels;
+            presenter.pitch = surface->pitch;
+            presenter.width = std::min(surface->w, (int)m_width);
+            presenter.height = std::min(surface->h, (int)m_height);
+            presenter.redShift = surface->format->Rshift;
+            presenter.greenShift = surface->format->Gshift;
+            presenter.blueShift = surface->format->Bshift;
+            presenter.alphaShift = surface->format->Ashift;
+            presenter.alpha = surface->format->Amask != 0;
+        }
+
+        {
+            PROFILE_SCOPE("Tiles");
+            const Presenter *target = surface ? &presenter : nullptr;
+            if (parallel) {
+                JobCounter counter;
+                for (uint32_t tile = 0; tile < tileCount; tile++)
+                    m_jobs->Submit([this, tile, chunkCount, target]() { DrawTile(tile, chunkCount, target); },
+                                   &counter);
+                m_jobs->Wait(counter);
+            } else {
+                for (uint32_t tile = 0; tile < tileCount; tile++)
+                    DrawTile(tile, chunkCount, target);
+            }
+        }
+
+        if (surface) {
+            if (SDL_MUSTLOCK(surface))
+                SDL_UnlockSurface(surface);
+
+            PROFILE_SCOPE("UpdateWindowSurface");
+            SDL_UpdateWindowSurface(m_window);
+        }
+
+        m_draws.clear();
+        m_triangleCount = 0;
+    }
+
+    void SoftwareRenderBackend::SetupTriangles(SetupChunk &chunk, uint32_t begin, uint32_t end) {
+        chunk.triangles.clear();
+        for (std::vector<uint32_t> &bin : chunk.bins)
+            bin.clear();
+        chunk.submitted = end - begin;
+        chunk.binned = 0;
+        if (begin == end)
+            return;
+
+        // Clip planes as coefficients of x, y, z and w: near, far, then the guard band
+        float guardX = GUARD_BAND / (m_width * 0.5f);
+        float guardY = GUARD_BAND / (m_height * 0.5f);
+        const ClipPlane planes[CLIP_PLANES] = {
+            {0.0f, 0.0f, 1.0f, 1.0f},  {0.0f, 0.0f, -1.0f, 1.0f}, {1.0f, 0.0f, 0.0f, guardX},
+            {-1.0f, 0.0f, 0.0f, guardX}, {0.0f, 1.0f, 0.0f, guardY},  {0.0f, -1.0f, 0.0f, guardY},
+        };
+
+        // The draw holding the first triangle: the last one starting at or before it
+        auto draw = std::upper_bound(m_draws.begin(), m_draws.end(), begin,
+                                     [](uint32_t triangle, const DrawRecord &record) {
+                                         return triangle < record.firstTriangle;
+                                     }) - 1;
+
+        ClipVertex polygon[MAX_POLYGON];
+        ClipVertex clipped[MAX_POLYGON];
+        ScreenVertex screen[MAX_POLYGON];
+        for (uint32_t index = begin; index < end; index++) {
+            while (index >= draw->firstTriangle + draw->triangleCount)
+                ++draw;
+
+            const RenderVertex *source = draw->vertices + (index - draw->firstTriangle) * 3;
+            uint32_t outside = 0x3F;
+            bool needsClip = false;
+            for (int i = 0; i < 3; i++) {
+                const RenderVertex &vertex = source[i];
+                Vector4 position = draw->transform * Vector4(vertex.x, vertex.y, vertex.z, 1.0f);
+                float *values = polygon[i].values;
+                values[CLIP_X] = position.GetX();
+                values[CLIP_Y] = position.GetY();
+                values[CLIP_Z] = position.GetZ();
+                values[CLIP_W] = position.GetW();
+                values[CLIP_U] = vertex.u;
+                values[CLIP_V] = vertex.v;
+                for (int channel = 0; channel < 4; channel++)
+                    values[CLIP_COLOR + channel] = ((vertex.color >> (channel * 8)) & 0xFF) * BYTE_TO_FLOAT;
+
+                // Bits of the view volume's sides this vertex is beyond; kept only if all three are
+                float x = position.GetX(), y = position.GetY(), z = position.GetZ(), w = position.GetW();
+                outside &= (x < -w ? 0x01 : 0) | (x > w ? 0x02 : 0) | (y < -w ? 0x04 : 0) | (y > w ? 0x08 : 0) |
+                           (z < -w ? 0x10 : 0) | (z > w ? 0x20 : 0);
+                for (int plane = 0; plane < CLIP_PLANES; plane++)
+                    needsClip |= planes[plane].Distance(polygon[i]) < 0.0f;
+            }
+            if (outside)
+                continue;
+
+            int count = 3;
+            if (needsClip) {
+                for (int plane = 0; plane < CLIP_PLANES && count > 0; plane++) {
+                    count = ClipPolygon(planes[plane], polygon, count, clipped);
+                    std::memcpy(polygon, clipped, count * sizeof(ClipVertex));
+                }
+                if (count < 3)
+                    continue;
+            }
+
+            for (int i = 0; i < count; i++) {
+                const float *values = polygon[i].values;
+                float inverseW = 1.0f / values[CLIP_W];
+                ScreenVertex &vertex = screen[i];
+                vertex.x = std::floor((values[CLIP_X] * inverseW * 0.5f + 0.5f) * m_width * SUBPIXELS + 0.5f) /
+                           SUBPIXELS;
+                vertex.y = std::floor((0.5f - values[CLIP_Y] * inverseW * 0.5f) * m_height * SUBPIXELS + 0.5f) /
+                           SUBPIXELS;
+                vertex.attributes[0] = values[CLIP_Z] * inverseW * 0.5f + 0.5f;
+                vertex.attributes[1] = inverseW;
+                vertex.attributes[2] = values[CLIP_U] * inverseW;
+                vertex.attributes[3] = values[CLIP_V] * inverseW;
+                for (int channel = 0; channel < 4; channel++)
+                    vertex.attributes[4 + channel] = values[CLIP_COLOR + channel] * inverseW;
+            }
+
+            const Texture *texture = draw->texture;
+            for (int i = 1; i + 1 < count; i++) {
+                Triangle triangle;
+                if (!SetupTriangle(screen[0], screen[i], screen[i + 1], (int)m_width, (int)m_height, triangle))
+                    continue;
+                triangle.texels = texture ? texture->pixels.data() : nullptr;
+                triangle.textureWidth = texture ? texture->width : 0;
+                triangle.textureHeight = texture ? texture->height : 0;
+                triangle.blend = draw->blend;
+                triangle.depthTest = draw->depthTest;
+                triangle.depthWrite = draw->depthWrite;
+                chunk.triangles.push_back(triangle);
+                BinTriangle(chunk, (uint32_t)chunk.triangles.size() - 1);
+            }
+        }
+    }
+
+    void SoftwareRenderBackend::BinTriangle(SetupChunk &chunk, uint32_t index) {
+        const Triangle &triangle = chunk.triangles[index];
+        int firstTileX = triangle.minX / TILE_SIZE, lastTileX = triangle.maxX / TILE_SIZE;
+        int firstTileY = triangle.minY / TILE_SIZE, lastTileY = triangle.maxY / TILE_SIZE;
+        bool single = firstTileX == lastTileX && firstTileY == lastTileY;
+
+        for (int tileY = firstTileY; tileY <= lastTileY; tileY++) {
+            int top = std::max(tileY * (int)TILE_SIZE, triangle.minY);
+            int bottom = std::min((tileY + 1) * (int)TILE_SIZE - 1, triangle.maxY);
+            for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+                int left = std::max(tileX * (int)TILE_SIZE, triangle.minX);
+                int right = std::min((tileX + 1) * (int)TILE_SIZE - 1, triangle.maxX);
+
+                // Skip tiles of the bounding box that some edge misses entirely, tested at the
+                // pixel center furthest inside that edge. The margin covers rounding.
+                bool missed = false;
+                for (int i = 0; i < 3 && !single && !missed; i++) {
+                    float x = (triangle.a[i] > 0.0f ? right : left) + 0.5f;
+                    float y = (triangle.b[i] > 0.0f ? bottom : top) + 0.5f;
+                    float margin = 1.0f + std::fabs(triangle.c[i]) * 1e-6f;
+                    missed = triangle.a[i] * x + triangle.b[i] * y + triangle.c[i] < -margin;
+                }
+                if (missed)
+                    continue;
+
+                chunk.bins[tileY * m_tilesX + tileX].push_back(index);
+                chunk.binned++;
+            }
+        }
+    }
+
+    void SoftwareRenderBackend::DrawTile(uint32_t tile, uint32_t chunkCount, const Presenter *presenter) {
+        int x0 = (int)((tile % m_tilesX) * TILE_SIZE);
+        int y0 = (int)((tile / m_tilesX) * TILE_SIZE);
+        int x1 = std::min(x0 + (int)TILE_SIZE, (int)m_width);
+        int y1 = std::min(y0 + (int)TILE_SIZE, (int)m_height);
+
+        for (int y = y0; y < y1; y++) {
+            std::fill(m_color.begin() + (size_t)y * m_stride + x0, m_color.begin() + (size_t)y * m_stride + x1,
+                      m_clearColor);
+            std::fill(m_depth.begin() + (size_t)y * m_stride + x0, m_depth.begin() + (size_t)y * m_stride + x1, 1.0f);
+        }
+
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            const SetupChunk &source = *m_chunks[chunk];
+            for (uint32_t index : source.bins[tile])
+                RasterTriangle(source.triangles[index], x0, y0, x1, y1, m_color.data(), m_depth.data(), m_stride);
+        }
+
+        if (!presenter)
+            return;
+
+        int right = std::min(x1, presenter->width);
+        for (int y = y0; y < std::min(y1, presenter->height); y++) {
+            const uint32_t *source = m_color.data() + (size_t)y * m_stride;
+            uint32_t *target = (uint32_t *)(presenter->pixels + (size_t)y * presenter->pitch);
+            for (int x = x0; x < right; x++) {
+                uint32_t pixel = source[x];
+                uint32_t converted = ((pixel & 0xFF) << presenter->redShift) |
+                                     (((pixel >> 8) & 0xFF) << presenter->greenShift) |
+                                     (((pixel >> 16) & 0xFF) << presenter->blueShift);
+                if (presenter->alpha)
+                    converted |= (pixel >> 24) << presenter->alphaShift;
+                target[x] = converted;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,144 @@
+//
+// Backend that rasterizes on the CPU, tile by tile across the job system.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "RenderBackend.h"
+
+struct SDL_Window;
+
+namespace Engine {
+
+    class JobSystem;
+
+    struct SoftwareRenderStats {
+        // Triangles drawn, and the ones left after clipping and culling
+        uint32_t triangles;
+        uint32_t visible;
+
+        // Triangle and tile pairs handed to the tile jobs
+        uint32_t binned;
+    };
+
+    /**
+     * Draws without a GPU, for machines that have none.
+     *
+     * Draws are only recorded until EndFrame(). Then the triangles are
+     * transformed, clipped and set up in parallel chunks, and each chunk
+     * sorts its triangles into bins by the screen tiles they touch. One
+     * job per tile then clears the tile and rasterizes the triangles of
+     * every bin in submission order, so blending needs no locks. Coverage
+     * is tested four pixels at a time with SIMD edge functions, with the
+     * top-left fill rule, so triangles sharing an edge never draw a pixel
+     * twice.
+     *
+     * Pixels get the perspective-correct vertex color times the texture,
+     * sampled nearest with wrapping. Depth tests pass on less or equal.
+     * Shaders aren't supported and their ids are ignored.
+     *
+     * Frames go to a window surface with SDL_UpdateWindowSurface() when a
+     * window is set, and otherwise stay in the color buffer.
+     */
+    class SoftwareRenderBackend : public RenderBackend {
+    public:
+        static const uint32_t TILE_SIZE = 64;
+
+        /**
+         * @param jobs spreads setup and tiles across threads; may be null
+         */
+        SoftwareRenderBackend(uint32_t width, uint32_t height, JobSystem *jobs);
+        ~SoftwareRenderBackend();
+
+        SoftwareRenderBackend(const SoftwareRenderBackend &) = delete;
+        SoftwareRenderBackend &operator=(const SoftwareRenderBackend &) = delete;
+
+        /**
+         * Presents every frame to \c window's surface; null stops presenting
+         */
+        void SetWindow(SDL_Window *window) { m_window = window; }
+
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+
+        /**
+         * Gets the distance in pixels from one row of the buffers to the next
+         */
+        uint32_t GetStride() const { return m_stride; }
+
+        /**
+         * Gets the last frame as 0xAABBGGRR pixels, rows top to bottom
+         */
+        const uint32_t *GetColorBuffer() const { return m_color.data(); }
+
+        uint32_t CreateMesh(const RenderVertex *vertices, uint32_t count) override;
+        uint32_t CreateTexture(uint32_t width, uint32_t height, const uint32_t *pixels) override;
+
+        void BeginFrame(const Vector4 &clearColor) override;
+
+        void SetShader(uint32_t shader) override;
+        void SetMaterial(uint32_t material) override;
+        void SetBlend(BlendMode blend) override;
+        void SetDepth(bool test, bool write) override;
+        void SetMesh(uint32_t mesh) override;
+
+        void Draw(const Matrix4 &transform, uint32_t firstVertex, uint32_t vertexCount) override;
+
+        void EndFrame() override;
+
+        /**
+         * Gets the counters of the last EndFrame()
+         */
+        const SoftwareRenderStats &GetStats() const { return m_stats; }
+
+    private:
+        struct Texture;
+        struct DrawRecord;
+        struct SetupChunk;
+        struct Presenter;
+
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_stride;
+        uint32_t m_tilesX;
+        uint32_t m_tilesY;
+        JobSystem *m_jobs;
+        SDL_Window *m_window;
+
+        std::vector<uint32_t> m_color;
+        std::vector<float> m_depth;
+        uint32_t m_clearColor;
+
+        std::vector<std::vector<RenderVertex>> m_meshes;
+        std::vector<std::unique_ptr<Texture>> m_textures;
+
+        uint32_t m_material;
+        BlendMode m_blend;
+        bool m_depthTest;
+        bool m_depthWrite;
+        uint32_t m_mesh;
+
+        std::vector<DrawRecord> m_draws;
+        uint32_t m_triangleCount;
+        std::vector<std::unique_ptr<SetupChunk>> m_chunks;
+        SoftwareRenderStats m_stats;
+
+        /**
+         * Sets up and bins the frame's triangles [begin, end)
+         */
+        void SetupTriangles(SetupChunk &chunk, uint32_t begin, uint32_t end);
+
+        void BinTriangle(SetupChunk &chunk, uint32_t index);
+
+        /**
+         * Clears one tile, draws every triangle binned to it and copies it to the window surface
+         * @param presenter null when not presenting
+         */
+        void DrawTile(uint32_t tile, uint32_t chunkCount, const Presenter *presenter);
+    };
+
+}
@@ -0,0 +1,42 @@
+//
+// Interface a SpriteBatch streams its quads into.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "RenderBackend.h"
+
+namespace Engine {
+
+    /**
+     * Takes the vertices of batched quads and draws runs of them. Only
+     * called from the thread submitting the frame.
+     */
+    class SpriteBackend {
+    public:
+        virtual ~SpriteBackend() {}
+
+        /**
+         * Gets room for \c quadCount quads of 4 vertices, corners in the order
+         * top left, top right, bottom right, bottom left. The memory may be
+         * write-combined GPU memory: write it front to back and never read it.
+         * @return null if this frame has no room left for that many quads
+         */
+        virtual RenderVertex *MapQuads(uint32_t quadCount) = 0;
+
+        /**
+         * Finishes writing the quads of the last MapQuads()
+         */
+        virtual void UnmapQuads() = 0;
+
+        /**
+         * Draws quads of the last mapping as two triangles each
+         * @param firstQuad counted from the start of the last mapping
+         */
+        virtual void DrawQuads(uint32_t shader, uint32_t texture, BlendMode blend, uint32_t firstQuad,
+                               uint32_t quadCount) = 0;
+    };
+
+}
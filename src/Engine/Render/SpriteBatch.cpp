@@ -0,0 +1,130 @@
+//
+// Collects 2D sprites and packs them into as few draws as possible.
+//
+
+#include "SpriteBatch.h"
+
+#include "JobSystem.h"
+
+#include <cmath>
+
+namespace Engine {
+
+    namespace {
+
+        // Fewer quads than this aren't worth a job of their own
+        const size_t MIN_QUADS_PER_JOB = 2048;
+
+        /**
+         * Sort key: layer, shader, texture, blend mode. Ids wider than their
+         * field are truncated, which can only split a run, never merge two
+         * states, since runs are cut by comparing the full state.
+         */
+        uint64_t MakeKey(uint8_t layer, uint32_t shader, uint32_t texture, BlendMode blend) {
+            return ((uint64_t)layer << 56) | ((uint64_t)(shader & 0xFFFF) << 40) |
+                   ((uint64_t)(texture & 0xFFFFFF) << 16) | ((uint64_t)blend << 14);
+        }
+    }
+
+    SpriteBatch::SpriteBatch() : m_stats() {}
+
+    void SpriteBatch::Begin() {
+        m_sprites.clear();
+        m_states.clear();
+        m_items.clear();
+    }
+
+    void SpriteBatch::Draw(uint8_t layer, uint32_t shader, uint32_t texture, BlendMode blend, const Sprite &sprite) {
+        RadixSortItem item;
+        item.key = MakeKey(layer, shader, texture, blend);
+        item.buffer = 0;
+        item.index = (uint32_t)m_sprites.size();
+        m_items.push_back(item);
+
+        SpriteState state;
+        state.shader = shader;
+        state.texture = texture;
+        state.blend = blend;
+        m_states.push_back(state);
+
+        m_sprites.push_back(sprite);
+    }
+
+    void SpriteBatch::End(SpriteBackend &backend, JobSystem *jobs) {
+        m_stats = SpriteBatchStats();
+        uint32_t count = (uint32_t)m_sprites.size();
+        m_stats.sprites = count;
+        if (count == 0)
+            return;
+
+        // The sort is stable, so sprites of one group keep their queue order
+        m_scratch.resize(count);
+        const RadixSortItem *order = RadixSort(m_items.data(), m_scratch.data(), count, jobs);
+
+        RenderVertex *vertices = backend.MapQuads(count);
+        if (!vertices) {
+            m_stats.dropped = count;
+            return;
+        }
+
+        // Every job writes its own contiguous range of the mapping
+        const Sprite *sprites = m_sprites.data();
+        if (jobs && jobs->IsRunning()) {
+            jobs->ParallelFor(
+                count, [=](size_t begin, size_t end) { WriteQuads(sprites, order, begin, end, vertices); },
+                MIN_QUADS_PER_JOB);
+        } else {
+            WriteQuads(sprites, order, 0, count, vertices);
+        }
+        backend.UnmapQuads();
+
+        uint32_t first = 0;
+        const SpriteState *current = &m_states[order[0].index];
+        for (uint32_t i = 1; i <= count; i++) {
+            const SpriteState *state = i < count ? &m_states[order[i].index] : nullptr;
+            if (state && state->shader == current->shader && state->texture == current->texture &&
+                state->blend == current->blend)
+                continue;
+
+            backend.DrawQuads(current->shader, current->texture, current->blend, first, i - first);
+            m_stats.draws++;
+            first = i;
+            current = state;
+        }
+    }
+
+    void SpriteBatch::WriteQuads(const Sprite *sprites, const RadixSortItem *order, size_t begin, size_t end,
+                                 RenderVertex *vertices) {
+        RenderVertex *quad = vertices + begin * 4;
+        for (size_t i = begin; i < end; i++, quad += 4) {
+            const Sprite &sprite = sprites[order[i].index];
+            float halfWidth = sprite.width * 0.5f;
+            float halfHeight = sprite.height * 0.5f;
+
+            // Half extents along the sprite's own axes, rotated into place
+            float rightX = halfWidth, rightY = 0.0f;
+            float upX = 0.0f, upY = halfHeight;
+            if (sprite.rotation != 0.0f) {
+                float c = std::cos(sprite.rotation);
+                float s = std::sin(sprite.rotation);
+                rightX = halfWidth * c;
+                rightY = halfWidth * s;
+                upX = -halfHeight * s;
+                upY = halfHeight * c;
+            }
+
+            // Built on the stack and copied whole, so mapped memory only sees sequential writes
+            RenderVertex corners[4] = {
+                {sprite.x - rightX + upX, sprite.y - rightY + upY, 0.0f, sprite.u0, sprite.v0, sprite.color},
+                {sprite.x + rightX + upX, sprite.y + rightY + upY, 0.0f, sprite.u1, sprite.v0, sprite.color},
+                {sprite.x + rightX - upX, sprite.y + rightY - upY, 0.0f, sprite.u1, sprite.v1, sprite.color},
+                {sprite.x - rightX - upX, sprite.y - rightY - upY, 0.0f, sprite.u0, sprite.v1, sprite.color},
+            };
+            quad[0] = corners[0];
+            quad[1] = corners[1];
+            quad[2] = corners[2];
+            quad[3] = corners[3];
+        }
+    }
+
+}
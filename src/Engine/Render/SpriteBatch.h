@@ -0,0 +1,98 @@
+//
+// Collects 2D sprites and packs them into as few draws as possible.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "RadixSort.h"
+#include "SpriteBackend.h"
+
+namespace Engine {
+
+    class JobSystem;
+
+    struct Sprite {
+        // Center, in the units of the shader's transform
+        float x, y;
+        float width, height;
+
+        // Counter-clockwise around the center, in radians
+        float rotation;
+
+        // Texture coordinates of the top left and bottom right corners
+        float u0, v0;
+        float u1, v1;
+
+        // 0xAABBGGRR, multiplied with the texture
+        uint32_t color;
+    };
+
+    struct SpriteBatchStats {
+        uint32_t sprites;
+        uint32_t draws;
+
+        // Sprites dropped because the backend had no room for them
+        uint32_t dropped;
+    };
+
+    /**
+     * Queues sprites between Begin() and End(), then draws them with one
+     * draw per run of sprites sharing shader, texture and blend mode.
+     *
+     * Layers draw in increasing order. Inside a layer, sprites are grouped
+     * by shader, then texture, then blend mode, and keep the order they were
+     * queued in only within their group. Sprites whose overlap has to follow
+     * queue order across textures belong on different layers.
+     *
+     * Sorting and vertex generation are split across the job system when
+     * one is given. Only the thread that owns the batch may queue sprites.
+     */
+    class SpriteBatch {
+    public:
+        SpriteBatch();
+
+        SpriteBatch(const SpriteBatch &) = delete;
+        SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+        /**
+         * Forgets every queued sprite
+         */
+        void Begin();
+
+        void Draw(uint8_t layer, uint32_t shader, uint32_t texture, BlendMode blend, const Sprite &sprite);
+
+        /**
+         * Sorts the queued sprites, writes their vertices into \c backend and
+         * issues the draws
+         * @param jobs may be null to do everything on the calling thread
+         */
+        void End(SpriteBackend &backend, JobSystem *jobs);
+
+        uint32_t GetCount() const { return (uint32_t)m_sprites.size(); }
+
+        /**
+         * Gets the counters of the last End()
+         */
+        const SpriteBatchStats &GetStats() const { return m_stats; }
+
+    private:
+        struct SpriteState {
+            uint32_t shader;
+            uint32_t texture;
+            BlendMode blend;
+        };
+
+        std::vector<Sprite> m_sprites;
+        std::vector<SpriteState> m_states;
+        std::vector<RadixSortItem> m_items;
+        std::vector<RadixSortItem> m_scratch;
+        SpriteBatchStats m_stats;
+
+        static void WriteQuads(const Sprite *sprites, const RadixSortItem *order, size_t begin, size_t end,
+                               RenderVertex *vertices);
+    };
+
+}
@@ -930,6 +930,18 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_CATEGORY   "SDL_AUDIO_CATEGORY"
 
+/**
+ *  \brief  A variable controlling whether SDL_PushEvent() and SDL_PeepEvents(SDL_ADDEVENT)
+ *          go through a lock-free ring instead of locking the event queue
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Every producer locks the event queue mutex
+ *    "1"       - Producers publish into a lock-free ring which readers drain under the lock (default)
+ *
+ *  The hint is read by SDL_Init(), so it must be set before the events subsystem starts.
+ */
+#define SDL_HINT_EVENT_QUEUE_LOCKFREE   "SDL_EVENT_QUEUE_LOCKFREE"
+
 /**
  *  \brief  An enumeration of hint priorities
  */
@@ -86,6 +86,39 @@ static struct
     SDL_SysWMEntry *wmmsg_free;
 } SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
 
+/* Lock-free multi-producer single-consumer ring in front of the event queue.
+
+   Producers claim a slot by advancing enqueue_pos with a CAS, copy their
+   event in and publish it by bumping the slot's sequence number (Vyukov's
+   bounded queue). Readers move published events, in ring order, into the
+   locked list above before every peek, get, flush or filter, so the list
+   stays the single ordered view of the queue and SDL_PeepEvents() keeps
+   its type-range semantics. Producers only take the queue lock when the
+   ring is full, or for SDL_SYSWMEVENT which carries an out-of-line message.
+
+   SDL_EventQ.count covers events in both the ring and the list.
+
+   Positions and sequence numbers are kept as Uint32 and only stored in
+   the atomics as int, so they wrap around instead of overflowing.
+*/
+#define SDL_EVENT_RING_SIZE     1024
+#define SDL_EVENT_RING_MASK     (SDL_EVENT_RING_SIZE - 1)
+
+typedef struct
+{
+    SDL_atomic_t sequence;
+    SDL_Event event;
+} SDL_EventRingSlot;
+
+static struct
+{
+    SDL_atomic_t enqueue_pos;
+    char pad[SDL_CACHELINE_SIZE - sizeof(SDL_atomic_t)];
+    Uint32 dequeue_pos;  /* only touched with SDL_EventQ.lock held */
+    SDL_bool enabled;
+    SDL_EventRingSlot slots[SDL_EVENT_RING_SIZE];
+} SDL_EventRing;
+
 
 #ifdef SDL_DEBUG_EVENTS
 
@@ -311,6 +344,18 @@ SDL_DebugPrintEvent(const SDL_Event *event)
 
 
 
+static void
+SDL_ResetEventRing(void)
+{
+    int i;
+
+    SDL_AtomicSet(&SDL_EventRing.enqueue_pos, 0);
+    SDL_EventRing.dequeue_pos = 0;
+    for (i = 0; i < SDL_EVENT_RING_SIZE; ++i) {
+        SDL_AtomicSet(&SDL_EventRing.slots[i].sequence, i);
+    }
+}
+
 /* Public functions */
 
 void
@@ -327,6 +372,11 @@ SDL_StopEventLoop(void)
 
     SDL_AtomicSet(&SDL_EventQ.active, 0);
 
+    /* Producers racing the shutdown may still be publishing; whatever is
+       in the ring is dropped along with the list below */
+    SDL_EventRing.enabled = SDL_FALSE;
+    SDL_ResetEventRing();
+
     if (report && SDL_atoi(report)) {
         SDL_Log("SDL EVENT QUEUE: Maximum events in-flight: %d\n",
                 SDL_EventQ.max_events_seen);
@@ -413,6 +463,14 @@ SDL_StartEventLoop(void)
     }
 #endif /* !SDL_THREADS_DISABLED */
 
+    /* The ring is only switched on while nothing can be in it */
+    if (!SDL_EventRing.enabled && SDL_EventQ.lock) {
+        SDL_LockMutex(SDL_EventQ.lock);
+        SDL_ResetEventRing();
+        SDL_EventRing.enabled = SDL_GetHintBoolean(SDL_HINT_EVENT_QUEUE_LOCKFREE, SDL_TRUE);
+        SDL_UnlockMutex(SDL_EventQ.lock);
+    }
+
     /* Process most event types */
     SDL_EventState(SDL_TEXTINPUT, SDL_DISABLE);
     SDL_EventState(SDL_TEXTEDITING, SDL_DISABLE);
@@ -424,18 +482,11 @@ SDL_StartEventLoop(void)
 }
 
 
-/* Add an event to the event queue -- called with the queue locked */
+/* Append an event to the list, without touching the count -- called with the queue locked */
 static int
-SDL_AddEvent(SDL_Event * event)
+SDL_AppendEvent(const SDL_Event * event)
 {
     SDL_EventEntry *entry;
-    const int initial_count = SDL_AtomicGet(&SDL_EventQ.count);
-    int final_count;
-
-    if (initial_count >= SDL_MAX_QUEUED_EVENTS) {
-        SDL_SetError("Event queue is full (%d events)", initial_count);
-        return 0;
-    }
 
     if (SDL_EventQ.free == NULL) {
         entry = (SDL_EventEntry *)SDL_malloc(sizeof(*entry));
@@ -470,6 +521,71 @@ SDL_AddEvent(SDL_Event * event)
         entry->next = NULL;
     }
 
+    return 1;
+}
+
+/* Move published events from the ring to the list -- called with the queue locked.
+   Without wait, stops at the first slot still being written. With wait, moves
+   everything claimed before the call, spinning on slots still being written,
+   so an event added to the list afterwards is ordered after all of them. */
+static void
+SDL_DrainEventRing(SDL_bool wait)
+{
+    const Uint32 target = (Uint32)SDL_AtomicGet(&SDL_EventRing.enqueue_pos);
+    int moved = 0;
+    int count;
+
+    while (SDL_EventRing.dequeue_pos != target) {
+        const Uint32 pos = SDL_EventRing.dequeue_pos;
+        SDL_EventRingSlot *slot = &SDL_EventRing.slots[pos & SDL_EVENT_RING_MASK];
+
+        if ((Uint32)SDL_AtomicGet(&slot->sequence) != pos + 1) {
+            if (!wait) {
+                break;
+            }
+            continue;
+        }
+        SDL_MemoryBarrierAcquire();
+
+        if (!SDL_AppendEvent(&slot->event)) {
+            /* Out of memory, the event is lost */
+            SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        }
+
+        SDL_AtomicSet(&slot->sequence, (int)(pos + SDL_EVENT_RING_SIZE));
+        SDL_EventRing.dequeue_pos = pos + 1;
+        ++moved;
+    }
+
+    if (moved) {
+        count = SDL_AtomicGet(&SDL_EventQ.count);
+        if (count > SDL_EventQ.max_events_seen) {
+            SDL_EventQ.max_events_seen = count;
+        }
+    }
+}
+
+/* Add an event to the event queue -- called with the queue locked */
+static int
+SDL_AddEvent(SDL_Event * event)
+{
+    const int initial_count = SDL_AtomicGet(&SDL_EventQ.count);
+    int final_count;
+
+    if (initial_count >= SDL_MAX_QUEUED_EVENTS) {
+        SDL_SetError("Event queue is full (%d events)", initial_count);
+        return 0;
+    }
+
+    /* Keep the order with anything pushed through the ring before us */
+    if (SDL_EventRing.enabled) {
+        SDL_DrainEventRing(SDL_TRUE);
+    }
+
+    if (!SDL_AppendEvent(event)) {
+        return 0;
+    }
+
     final_count = SDL_AtomicAdd(&SDL_EventQ.count, 1) + 1;
     if (final_count > SDL_EventQ.max_events_seen) {
         SDL_EventQ.max_events_seen = final_count;
@@ -478,6 +594,49 @@ SDL_AddEvent(SDL_Event * event)
     return 1;
 }
 
+/* Add an event without taking the queue lock
+   Returns 1 if added, 0 if the queue is full, -1 if the ring is full and
+   the caller must fall back to SDL_AddEvent() */
+static int
+SDL_PushEventRing(const SDL_Event * event)
+{
+    const int initial_count = SDL_AtomicGet(&SDL_EventQ.count);
+    SDL_EventRingSlot *slot;
+    Uint32 pos;
+    int diff;
+
+    if (initial_count >= SDL_MAX_QUEUED_EVENTS) {
+        SDL_SetError("Event queue is full (%d events)", initial_count);
+        return 0;
+    }
+
+    pos = (Uint32)SDL_AtomicGet(&SDL_EventRing.enqueue_pos);
+    for (;;) {
+        slot = &SDL_EventRing.slots[pos & SDL_EVENT_RING_MASK];
+        diff = (int)((Uint32)SDL_AtomicGet(&slot->sequence) - pos);
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&SDL_EventRing.enqueue_pos, (int)pos, (int)(pos + 1))) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* The reader has not freed this slot yet */
+            return -1;
+        }
+        pos = (Uint32)SDL_AtomicGet(&SDL_EventRing.enqueue_pos);
+    }
+
+    #ifdef SDL_DEBUG_EVENTS
+    SDL_DebugPrintEvent(event);
+    #endif
+
+    SDL_AtomicAdd(&SDL_EventQ.count, 1);
+    slot->event = *event;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&slot->sequence, (int)(pos + 1));
+
+    return 1;
+}
+
 /* Remove an event from the queue -- called with the queue locked */
 static void
 SDL_CutEvent(SDL_EventEntry *entry)
@@ -519,8 +678,26 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
         }
         return (-1);
     }
-    /* Lock the event queue */
     used = 0;
+
+    /* Most events are added without locking; only fall back on the lock for
+       the ones the ring cannot take */
+    if (action == SDL_ADDEVENT && SDL_EventRing.enabled) {
+        for (i = 0; i < numevents; ++i) {
+            int added = (events[i].type == SDL_SYSWMEVENT) ? -1 : SDL_PushEventRing(&events[i]);
+            if (added < 0) {
+                if (SDL_LockMutex(SDL_EventQ.lock) < 0) {
+                    return SDL_SetError("Couldn't lock event queue");
+                }
+                added = SDL_AddEvent(&events[i]);
+                SDL_UnlockMutex(SDL_EventQ.lock);
+            }
+            used += added;
+        }
+        return (used);
+    }
+
+    /* Lock the event queue */
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         if (action == SDL_ADDEVENT) {
             for (i = 0; i < numevents; ++i) {
@@ -531,6 +708,10 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
             SDL_SysWMEntry *wmmsg, *wmmsg_next;
             Uint32 type;
 
+            if (SDL_EventRing.enabled) {
+                SDL_DrainEventRing(SDL_FALSE);
+            }
+
             if (action == SDL_GETEVENT) {
                 /* Clean out any used wmmsg data
                    FIXME: Do we want to retain the data for some period of time?
@@ -621,6 +802,11 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
         Uint32 type;
+
+        if (SDL_EventRing.enabled) {
+            SDL_DrainEventRing(SDL_FALSE);
+        }
+
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             type = entry->event.type;
@@ -848,6 +1034,11 @@ SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
+
+        if (SDL_EventRing.enabled) {
+            SDL_DrainEventRing(SDL_FALSE);
+        }
+
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             if (!filter(userdata, &entry->event)) {
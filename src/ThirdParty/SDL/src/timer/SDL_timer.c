@@ -46,12 +46,48 @@ typedef struct _SDL_TimerMap
     struct _SDL_TimerMap *next;
 } SDL_TimerMap;
 
-/* The timers are kept in a sorted list */
+/* Timers are kept in a hierarchical timing wheel with millisecond ticks.
+ * The root wheel has one slot per tick for the next 256ms; each of the
+ * outer wheels has 64 slots covering 64 slots of the wheel below, so the
+ * four outer wheels reach the full 32-bit tick range. Timers on an outer
+ * wheel are re-sorted one level down ("cascaded") when the wheel below
+ * wraps around, which makes adding a timer O(1) and processing a tick
+ * O(1) amortized. Slot lists keep insertion order, so timers due on the
+ * same tick fire in the order they were scheduled.
+ */
+#define SDL_TIMER_WHEEL_ROOT_BITS   8
+#define SDL_TIMER_WHEEL_ROOT_SIZE   (1 << SDL_TIMER_WHEEL_ROOT_BITS)
+#define SDL_TIMER_WHEEL_ROOT_MASK   (SDL_TIMER_WHEEL_ROOT_SIZE - 1)
+#define SDL_TIMER_WHEEL_LEVEL_BITS  6
+#define SDL_TIMER_WHEEL_LEVEL_SIZE  (1 << SDL_TIMER_WHEEL_LEVEL_BITS)
+#define SDL_TIMER_WHEEL_LEVEL_MASK  (SDL_TIMER_WHEEL_LEVEL_SIZE - 1)
+#define SDL_TIMER_WHEEL_LEVELS      4
+
+typedef struct
+{
+    SDL_Timer *head;
+    SDL_Timer *tail;
+} SDL_TimerList;
+
+typedef struct
+{
+    Uint32 next;        /* The next tick to process */
+    int count;          /* Timers on any wheel */
+    int root_count;     /* Timers on the root wheel */
+    SDL_TimerList root[SDL_TIMER_WHEEL_ROOT_SIZE];
+    SDL_TimerList levels[SDL_TIMER_WHEEL_LEVELS][SDL_TIMER_WHEEL_LEVEL_SIZE];
+    SDL_TimerList expired;  /* Timers due now, in firing order */
+} SDL_TimerWheel;
+
+#define SDL_TIMER_MAP_INITIAL_SIZE  64
+
 typedef struct {
     /* Data used by the main thread */
     SDL_Thread *thread;
     SDL_atomic_t nextID;
-    SDL_TimerMap *timermap;
+    SDL_TimerMap **timermap;    /* Hash buckets indexed by timer ID */
+    int timermap_size;          /* Number of buckets, a power of two */
+    int timermap_count;
     SDL_mutex *timermap_lock;
 
     /* Padding to separate cache lines between threads */
@@ -64,8 +100,8 @@ typedef struct {
     SDL_Timer *freelist;
     SDL_atomic_t active;
 
-    /* List of timers - this is only touched by the timer thread */
-    SDL_Timer *timers;
+    /* Wheel of timers - this is only touched by the timer thread */
+    SDL_TimerWheel wheel;
 } SDL_TimerData;
 
 static SDL_TimerData SDL_timer_data;
@@ -76,25 +112,227 @@ static SDL_TimerData SDL_timer_data;
  * Timers are removed by simply setting a canceled flag
  */
 
+static void
+SDL_AppendTimer(SDL_TimerList *list, SDL_Timer *timer)
+{
+    timer->next = NULL;
+    if (list->tail) {
+        list->tail->next = timer;
+    } else {
+        list->head = timer;
+    }
+    list->tail = timer;
+}
+
 static void
 SDL_AddTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
 {
-    SDL_Timer *prev, *curr;
+    SDL_TimerWheel *wheel = &data->wheel;
+    const Uint32 expires = timer->scheduled;
+    const Uint32 delta = expires - wheel->next;
+    int level, shift;
+
+    if ((Sint32)delta < 0) {
+        /* Already due */
+        SDL_AppendTimer(&wheel->expired, timer);
+        return;
+    }
 
-    prev = NULL;
-    for (curr = data->timers; curr; prev = curr, curr = curr->next) {
-        if ((Sint32)(timer->scheduled-curr->scheduled) < 0) {
+    if (delta < SDL_TIMER_WHEEL_ROOT_SIZE) {
+        SDL_AppendTimer(&wheel->root[expires & SDL_TIMER_WHEEL_ROOT_MASK], timer);
+        ++wheel->root_count;
+    } else {
+        /* Pick the innermost wheel whose range covers the delay */
+        level = 0;
+        shift = SDL_TIMER_WHEEL_ROOT_BITS;
+        while (level < SDL_TIMER_WHEEL_LEVELS - 1 &&
+               (delta >> (shift + SDL_TIMER_WHEEL_LEVEL_BITS)) != 0) {
+            shift += SDL_TIMER_WHEEL_LEVEL_BITS;
+            ++level;
+        }
+        SDL_AppendTimer(&wheel->levels[level][(expires >> shift) & SDL_TIMER_WHEEL_LEVEL_MASK], timer);
+    }
+    ++wheel->count;
+}
+
+/* Re-sort the timers of an outer wheel slot into the wheels below */
+static void
+SDL_CascadeTimers(SDL_TimerData *data, int level, int index)
+{
+    SDL_TimerList *slot = &data->wheel.levels[level][index];
+    SDL_Timer *timer = slot->head;
+    SDL_Timer *next;
+
+    slot->head = NULL;
+    slot->tail = NULL;
+
+    while (timer) {
+        next = timer->next;
+        --data->wheel.count;
+        SDL_AddTimerInternal(data, timer);
+        timer = next;
+    }
+}
+
+/* Move every timer due up to and including tick 'now' to the expired list */
+static void
+SDL_AdvanceTimerWheel(SDL_TimerData *data, Uint32 now)
+{
+    SDL_TimerWheel *wheel = &data->wheel;
+    SDL_TimerList *slot;
+    SDL_Timer *timer;
+    Uint32 tick, boundary;
+    int level, shift, index, moved;
+
+    while ((Sint32)(now - wheel->next) >= 0) {
+        if (wheel->count == 0) {
+            wheel->next = now + 1;
             break;
         }
+
+        tick = wheel->next;
+        if ((tick & SDL_TIMER_WHEEL_ROOT_MASK) == 0) {
+            /* The root wheel wrapped, refill it from the outer wheels */
+            shift = SDL_TIMER_WHEEL_ROOT_BITS;
+            for (level = 0; level < SDL_TIMER_WHEEL_LEVELS; ++level) {
+                index = (tick >> shift) & SDL_TIMER_WHEEL_LEVEL_MASK;
+                SDL_CascadeTimers(data, level, index);
+                if (index != 0) {
+                    break;
+                }
+                shift += SDL_TIMER_WHEEL_LEVEL_BITS;
+            }
+        }
+
+        if (wheel->root_count == 0) {
+            /* Nothing to fire before the next cascade, skip straight to it */
+            boundary = (tick | SDL_TIMER_WHEEL_ROOT_MASK) + 1;
+            wheel->next = ((Sint32)(boundary - now) > 0) ? now + 1 : boundary;
+            continue;
+        }
+
+        slot = &wheel->root[tick & SDL_TIMER_WHEEL_ROOT_MASK];
+        if (slot->head) {
+            moved = 0;
+            for (timer = slot->head; timer; timer = timer->next) {
+                ++moved;
+            }
+
+            if (wheel->expired.tail) {
+                wheel->expired.tail->next = slot->head;
+            } else {
+                wheel->expired.head = slot->head;
+            }
+            wheel->expired.tail = slot->tail;
+            slot->head = NULL;
+            slot->tail = NULL;
+
+            wheel->root_count -= moved;
+            wheel->count -= moved;
+        }
+        wheel->next = tick + 1;
     }
+}
 
-    /* Insert the timer here! */
-    if (prev) {
-        prev->next = timer;
-    } else {
-        data->timers = timer;
+/* Milliseconds from 'now' until the wheel next needs processing */
+static Uint32
+SDL_NextTimerDelay(SDL_TimerData *data, Uint32 now)
+{
+    SDL_TimerWheel *wheel = &data->wheel;
+    Uint32 tick, boundary;
+
+    if (wheel->expired.head) {
+        return 0;
     }
-    timer->next = curr;
+    if (wheel->count == 0) {
+        return SDL_MUTEX_MAXWAIT;
+    }
+
+    /* Wake up for the next root slot in use, or for the next cascade */
+    boundary = (wheel->next + SDL_TIMER_WHEEL_ROOT_MASK) & ~(Uint32)SDL_TIMER_WHEEL_ROOT_MASK;
+    if (wheel->root_count > 0) {
+        for (tick = wheel->next; tick != boundary; ++tick) {
+            if (wheel->root[tick & SDL_TIMER_WHEEL_ROOT_MASK].head) {
+                return tick - now;
+            }
+        }
+    }
+    return boundary - now;
+}
+
+static void
+SDL_FreeTimerList(SDL_TimerList *list)
+{
+    SDL_Timer *timer;
+
+    while (list->head) {
+        timer = list->head;
+        list->head = timer->next;
+        SDL_free(timer);
+    }
+    list->tail = NULL;
+}
+
+/* Timer ID lookup -- called with the timermap lock held */
+static SDL_bool
+SDL_InsertTimerMap(SDL_TimerData *data, SDL_TimerMap *entry)
+{
+    SDL_TimerMap **buckets, *next;
+    int i, size, bucket;
+
+    if (data->timermap_count >= data->timermap_size) {
+        /* Keep the load factor at most 1 */
+        size = data->timermap_size ? data->timermap_size * 2 : SDL_TIMER_MAP_INITIAL_SIZE;
+        buckets = (SDL_TimerMap **)SDL_calloc(size, sizeof(*buckets));
+        if (!buckets) {
+            return SDL_FALSE;
+        }
+
+        for (i = 0; i < data->timermap_size; ++i) {
+            while (data->timermap[i]) {
+                next = data->timermap[i]->next;
+                bucket = data->timermap[i]->timerID & (size - 1);
+                data->timermap[i]->next = buckets[bucket];
+                buckets[bucket] = data->timermap[i];
+                data->timermap[i] = next;
+            }
+        }
+
+        SDL_free(data->timermap);
+        data->timermap = buckets;
+        data->timermap_size = size;
+    }
+
+    bucket = entry->timerID & (data->timermap_size - 1);
+    entry->next = data->timermap[bucket];
+    data->timermap[bucket] = entry;
+    ++data->timermap_count;
+    return SDL_TRUE;
+}
+
+/* Unlink and return the entry of a timer ID -- called with the timermap lock held */
+static SDL_TimerMap *
+SDL_RemoveTimerMap(SDL_TimerData *data, int timerID)
+{
+    SDL_TimerMap *prev, *entry;
+
+    if (!data->timermap) {
+        return NULL;
+    }
+
+    prev = NULL;
+    for (entry = data->timermap[timerID & (data->timermap_size - 1)]; entry; prev = entry, entry = entry->next) {
+        if (entry->timerID == timerID) {
+            if (prev) {
+                prev->next = entry->next;
+            } else {
+                data->timermap[timerID & (data->timermap_size - 1)] = entry->next;
+            }
+            --data->timermap_count;
+            return entry;
+        }
+    }
+    return NULL;
 }
 
 static int SDLCALL
@@ -128,7 +366,12 @@ SDL_TimerThread(void *_data)
         }
         SDL_AtomicUnlock(&data->lock);
 
-        /* Sort the pending timers into our list */
+        /* An idle wheel doesn't need to walk the time it slept through */
+        if (pending && data->wheel.count == 0 && !data->wheel.expired.head) {
+            data->wheel.next = SDL_GetTicks();
+        }
+
+        /* Sort the pending timers into the wheel */
         while (pending) {
             current = pending;
             pending = pending->next;
@@ -142,24 +385,18 @@ SDL_TimerThread(void *_data)
             break;
         }
 
-        /* Initial delay if there are no timers */
-        delay = SDL_MUTEX_MAXWAIT;
-
         tick = SDL_GetTicks();
 
-        /* Process all the pending timers for this tick */
-        while (data->timers) {
-            current = data->timers;
+        /* Collect everything due by now and fire it as one batch */
+        SDL_AdvanceTimerWheel(data, tick);
 
-            if ((Sint32)(tick-current->scheduled) < 0) {
-                /* Scheduled for the future, wait a bit */
-                delay = (current->scheduled - tick);
-                break;
+        while (data->wheel.expired.head) {
+            current = data->wheel.expired.head;
+            data->wheel.expired.head = current->next;
+            if (!data->wheel.expired.head) {
+                data->wheel.expired.tail = NULL;
             }
 
-            /* We're going to do something with this timer */
-            data->timers = current->next;
-
             if (SDL_AtomicGet(&current->canceled)) {
                 interval = 0;
             } else {
@@ -184,6 +421,9 @@ SDL_TimerThread(void *_data)
             }
         }
 
+        /* Sleep until the next timer, or the next cascade */
+        delay = SDL_NextTimerDelay(data, tick);
+
         /* Adjust the delay based on processing time */
         now = SDL_GetTicks();
         interval = (now - tick);
@@ -221,6 +461,9 @@ SDL_TimerInit(void)
             return -1;
         }
 
+        SDL_zero(data->wheel);
+        data->wheel.next = SDL_GetTicks();
+
         SDL_AtomicSet(&data->active, 1);
 
         /* Timer threads use a callback into the app, so we can't set a limited stack size here. */
@@ -241,6 +484,7 @@ SDL_TimerQuit(void)
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
     SDL_TimerMap *entry;
+    int i, j;
 
     if (SDL_AtomicCAS(&data->active, 1, 0)) {  /* active? Move to inactive. */
         /* Shutdown the timer thread */
@@ -254,21 +498,34 @@ SDL_TimerQuit(void)
         data->sem = NULL;
 
         /* Clean up the timer entries */
-        while (data->timers) {
-            timer = data->timers;
-            data->timers = timer->next;
-            SDL_free(timer);
+        for (i = 0; i < SDL_TIMER_WHEEL_ROOT_SIZE; ++i) {
+            SDL_FreeTimerList(&data->wheel.root[i]);
+        }
+        for (i = 0; i < SDL_TIMER_WHEEL_LEVELS; ++i) {
+            for (j = 0; j < SDL_TIMER_WHEEL_LEVEL_SIZE; ++j) {
+                SDL_FreeTimerList(&data->wheel.levels[i][j]);
+            }
         }
+        SDL_FreeTimerList(&data->wheel.expired);
+        data->wheel.count = 0;
+        data->wheel.root_count = 0;
+
         while (data->freelist) {
             timer = data->freelist;
             data->freelist = timer->next;
             SDL_free(timer);
         }
-        while (data->timermap) {
-            entry = data->timermap;
-            data->timermap = entry->next;
-            SDL_free(entry);
+        for (i = 0; i < data->timermap_size; ++i) {
+            while (data->timermap[i]) {
+                entry = data->timermap[i];
+                data->timermap[i] = entry->next;
+                SDL_free(entry);
+            }
         }
+        SDL_free(data->timermap);
+        data->timermap = NULL;
+        data->timermap_size = 0;
+        data->timermap_count = 0;
 
         SDL_DestroyMutex(data->timermap_lock);
         data->timermap_lock = NULL;
@@ -322,8 +579,13 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     entry->timerID = timer->timerID;
 
     SDL_LockMutex(data->timermap_lock);
-    entry->next = data->timermap;
-    data->timermap = entry;
+    if (!SDL_InsertTimerMap(data, entry)) {
+        SDL_UnlockMutex(data->timermap_lock);
+        SDL_free(entry);
+        SDL_free(timer);
+        SDL_OutOfMemory();
+        return 0;
+    }
     SDL_UnlockMutex(data->timermap_lock);
 
     /* Add the timer to the pending list for the timer thread */
@@ -342,22 +604,12 @@ SDL_bool
 SDL_RemoveTimer(SDL_TimerID id)
 {
     SDL_TimerData *data = &SDL_timer_data;
-    SDL_TimerMap *prev, *entry;
+    SDL_TimerMap *entry;
     SDL_bool canceled = SDL_FALSE;
 
     /* Find the timer */
     SDL_LockMutex(data->timermap_lock);
-    prev = NULL;
-    for (entry = data->timermap; entry; prev = entry, entry = entry->next) {
-        if (entry->timerID == id) {
-            if (prev) {
-                prev->next = entry->next;
-            } else {
-                data->timermap = entry->next;
-            }
-            break;
-        }
-    }
+    entry = SDL_RemoveTimerMap(data, id);
     SDL_UnlockMutex(data->timermap_lock);
 
     if (entry) {